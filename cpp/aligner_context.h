@@ -0,0 +1,67 @@
+/**
+ * Reusable Aligner State
+ *
+ * An alignment needs scratch memory proportional to its input (DP rows,
+ * traceback codes, reversed copies, recursion buffers) and storage for its
+ * result. Instead of allocating both on every call, the aligners take an
+ * AlignerContext:
+ * - arena: a ScratchArena (dp_matrix.h) the call takes all its scratch from
+ *   and rewinds before returning
+ * - result / scores: the output of the last call, overwritten by the next;
+ *   the CIGAR and score row keep their capacity from call to call
+ * - pool: the worker threads of the parallel aligners, started on first use
+ *
+ * Once a context has seen the largest input of a workload, further calls
+ * run without touching the heap. A context belongs to one thread at a time;
+ * AlignerContext::local() is a context per thread, which the overloads
+ * without a context use for their scratch.
+ */
+
+#ifndef ALIGNER_CONTEXT_H
+#define ALIGNER_CONTEXT_H
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "cigar.h"
+#include "dp_matrix.h"
+#include "thread_pool.h"
+
+struct AlignerContext {
+    ScratchArena arena;
+    AlignmentResult result;   // Last alignment; views the sequences it was given
+    std::vector<int> scores;  // Last score row (nw_score)
+
+private:
+    std::unique_ptr<WorkStealingPool> workers;
+
+public:
+    AlignerContext() = default;
+    AlignerContext(const AlignerContext&) = delete;
+    AlignerContext& operator=(const AlignerContext&) = delete;
+
+    /**
+     * A pool of threads workers (0 = all cores), kept until a call asks for
+     * a different number.
+     */
+    WorkStealingPool& pool(size_t threads) {
+        threads = std::max<size_t>(threads ? threads : std::thread::hardware_concurrency(), 1);
+        if (!workers || workers->size() != threads) {
+            workers.reset();
+            workers = std::make_unique<WorkStealingPool>(threads);
+        }
+        return *workers;
+    }
+
+    /**
+     * The calling thread's context.
+     */
+    static AlignerContext& local() {
+        thread_local AlignerContext context;
+        return context;
+    }
+};
+
+#endif // ALIGNER_CONTEXT_H
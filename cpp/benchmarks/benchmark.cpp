@@ -0,0 +1,439 @@
+/**
+ * Benchmark Suite (Google Benchmark)
+ *
+ * Runs every C++ algorithm on synthetic genome workloads, each benchmark
+ * parameterized by sequence length, error rate (percent of bases
+ * substituted, inserted or deleted) and repeat content (percent of the
+ * reference covered by diverged copies of a few repeat families):
+ * - FMIndex / BidirectionalFMIndex construction, in bases per second
+ * - FM-index count and locate latency per pattern, single and batched
+ * - Needleman-Wunsch, Smith-Waterman (linear and affine gaps, striped and
+ *   batched score-only kernels), Hirschberg and Myers-Miller, in GCUPS
+ *   (10^9 DP cells per second)
+ * - Seed-and-extend over k-mer minimizers and over SMEMs, in reads per second
+ *
+ * Workloads are generated from fixed seeds, so runs are comparable. Write
+ * the results as JSON and compare them against a previous run to catch
+ * regressions:
+ *   cmake -S . -B build -DALIGN_MARCH=native && cmake --build build --target bench
+ *   build/bench --benchmark_out=bench.json --benchmark_out_format=json
+ *   build/bench --benchmark_filter='SmithWaterman|NeedlemanWunsch'
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "aligner_context.h"
+#include "cigar.h"
+#include "dp_matrix.h"
+#include "fm_index.h"
+#include "hirschberg.h"
+#include "needleman_wunsch.h"
+#include "scoring.h"
+#include "seed_and_extend.h"
+#include "smith_waterman.h"
+#include "smith_waterman_affine.h"
+#include "thread_pool.h"
+#include "wavefront.h"
+
+using namespace std;
+
+/**
+ * Copy of seq with about error_percent of its bases edited: 80% of the edits
+ * substitute a base, 10% insert one and 10% delete one.
+ */
+string mutate(const string& seq, int error_percent, mt19937_64& rng) {
+    static const char BASES[] = "ACGT";
+    string out;
+    out.reserve(seq.size() + seq.size() / 16);
+    uniform_int_distribution<int> percent(0, 9999);
+    for (char c : seq) {
+        int roll = percent(rng);
+        if (roll >= error_percent * 100) {
+            out += c;
+        } else if (roll % 10 < 8) {
+            out += BASES[(string_view(BASES).find(c) + 1 + rng() % 3) % 4];
+        } else if (roll % 10 == 8) {
+            out += c;
+            out += BASES[rng() % 4];
+        }
+    }
+    return out;
+}
+
+/**
+ * Random genome of length bases, repeat_percent of it covered by copies of
+ * eight 300-base repeat families, each copy about 5% diverged (Alu-like).
+ */
+string random_genome(size_t length, int repeat_percent, uint64_t seed) {
+    static const char BASES[] = "ACGT";
+    mt19937_64 rng(seed);
+    string genome(length, 'A');
+    for (char& c : genome) {
+        c = BASES[rng() % 4];
+    }
+
+    const size_t UNIT = 300;
+    vector<string> families(8);
+    for (string& family : families) {
+        family = genome.substr(rng() % (length - UNIT), UNIT);
+    }
+    size_t copies = length * repeat_percent / 100 / UNIT;
+    for (size_t i = 0; i < copies; i++) {
+        string copy = mutate(families[rng() % families.size()], 5, rng);
+        size_t pos = rng() % (length - copy.size());
+        genome.replace(pos, copy.size(), copy);
+    }
+    return genome;
+}
+
+/**
+ * Reads: count substrings of genome of the given length, each with
+ * error_percent edits.
+ */
+vector<string> sample_reads(const string& genome, size_t count, size_t length, int error_percent,
+                            uint64_t seed) {
+    mt19937_64 rng(seed);
+    vector<string> reads;
+    for (size_t i = 0; i < count; i++) {
+        reads.push_back(mutate(genome.substr(rng() % (genome.size() - length), length), error_percent, rng));
+    }
+    return reads;
+}
+
+/**
+ * Genome of the given size and repeat content, built once per process.
+ */
+const string& genome(size_t length, int repeat_percent) {
+    static map<pair<size_t, int>, string> cache;
+    auto key = make_pair(length, repeat_percent);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, random_genome(length, repeat_percent, 1 + length + repeat_percent)).first;
+    }
+    return it->second;
+}
+
+/**
+ * A sequence of the given length and a copy of it with error_percent edits.
+ */
+pair<string, string> sequence_pair(size_t length, int error_percent) {
+    mt19937_64 rng(length * 101 + error_percent);
+    string seq1 = genome(1 << 20, 0).substr(rng() % ((1 << 20) - length), length);
+    return {seq1, mutate(seq1, error_percent, rng)};
+}
+
+/**
+ * Report DP cells per second as GCUPS.
+ */
+void set_gcups(benchmark::State& state, double cells) {
+    state.counters["GCUPS"] = benchmark::Counter(cells * 1e-9, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["cells"] = cells;
+}
+
+// ---------------------------------------------------------------------------
+// BWT / FM-index
+// ---------------------------------------------------------------------------
+
+// Args: reference length, repeat percent
+void BM_FMIndexBuild(benchmark::State& state) {
+    const string& text = genome(state.range(0), state.range(1));
+    for (auto _ : state) {
+        FMIndex index(text);
+        benchmark::DoNotOptimize(index.count("ACGT"));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+}
+BENCHMARK(BM_FMIndexBuild)
+    ->ArgNames({"length", "repeat%"})
+    ->Args({1 << 16, 0})->Args({1 << 20, 0})->Args({1 << 20, 30})->Args({1 << 22, 30})
+    ->Unit(benchmark::kMillisecond);
+
+// Args: reference length, repeat percent
+void BM_BidirectionalFMIndexBuild(benchmark::State& state) {
+    const string& text = genome(state.range(0), state.range(1));
+    for (auto _ : state) {
+        BidirectionalFMIndex index(text);
+        benchmark::DoNotOptimize(index.count("ACGT"));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * text.size());
+}
+BENCHMARK(BM_BidirectionalFMIndexBuild)
+    ->ArgNames({"length", "repeat%"})
+    ->Args({1 << 20, 30})
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * FM-index of the 4 Mbp, 30% repeat genome, built once.
+ */
+const FMIndex& fm_index() {
+    static const FMIndex index(genome(1 << 22, 30));
+    return index;
+}
+
+/**
+ * Patterns for count/locate: reads of the genome, error_percent edited so
+ * that some of them miss.
+ */
+vector<string> fm_patterns(size_t length, int error_percent) {
+    vector<string> patterns = sample_reads(genome(1 << 22, 30), 1024, length, error_percent, length);
+    for (string& pattern : patterns) {
+        pattern.resize(min(pattern.size(), length));
+    }
+    return patterns;
+}
+
+// Args: pattern length, error percent
+void BM_FMCount(benchmark::State& state) {
+    const FMIndex& index = fm_index();
+    vector<string> patterns = fm_patterns(state.range(0), state.range(1));
+    size_t hits = 0;
+    for (auto _ : state) {
+        for (const string& pattern : patterns) {
+            hits += index.count(pattern);
+        }
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(int64_t(state.iterations()) * patterns.size());
+}
+BENCHMARK(BM_FMCount)
+    ->ArgNames({"length", "error%"})
+    ->Args({20, 0})->Args({100, 0})->Args({100, 2})
+    ->Unit(benchmark::kMicrosecond);
+
+// Args: pattern length, error percent
+void BM_FMCountBatch(benchmark::State& state) {
+    const FMIndex& index = fm_index();
+    vector<string> patterns = fm_patterns(state.range(0), state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.count_batch(patterns));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * patterns.size());
+}
+BENCHMARK(BM_FMCountBatch)
+    ->ArgNames({"length", "error%"})
+    ->Args({20, 0})->Args({100, 0})->Args({100, 2})
+    ->Unit(benchmark::kMicrosecond);
+
+// Args: pattern length, error percent
+void BM_FMLocate(benchmark::State& state) {
+    const FMIndex& index = fm_index();
+    vector<string> patterns = fm_patterns(state.range(0), state.range(1));
+    size_t hits = 0;
+    for (auto _ : state) {
+        for (const string& pattern : patterns) {
+            hits += index.locate(pattern).size();
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * patterns.size());
+    state.counters["hits/pattern"] = double(hits) / (state.iterations() * patterns.size());
+}
+BENCHMARK(BM_FMLocate)
+    ->ArgNames({"length", "error%"})
+    ->Args({14, 0})->Args({20, 0})->Args({100, 0})
+    ->Unit(benchmark::kMicrosecond);
+
+// Args: pattern length, error percent
+void BM_FMLocateBatch(benchmark::State& state) {
+    const FMIndex& index = fm_index();
+    vector<string> patterns = fm_patterns(state.range(0), state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.locate_batch(patterns));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * patterns.size());
+}
+BENCHMARK(BM_FMLocateBatch)
+    ->ArgNames({"length", "error%"})
+    ->Args({14, 0})->Args({20, 0})->Args({100, 0})
+    ->Unit(benchmark::kMicrosecond);
+
+// ---------------------------------------------------------------------------
+// DP aligners
+// ---------------------------------------------------------------------------
+
+// Pair lengths and error percents of the DP benchmarks
+void dp_args(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"length", "error%"});
+    for (int length : {100, 1000, 5000}) {
+        for (int error_percent : {1, 10}) {
+            b->Args({length, error_percent});
+        }
+    }
+}
+
+// Args: sequence length, error percent
+void BM_NeedlemanWunsch(benchmark::State& state) {
+    auto [seq1, seq2] = sequence_pair(state.range(0), state.range(1));
+    AlignerContext context;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(needleman_wunsch_cigar(seq1, seq2, context).score);
+    }
+    set_gcups(state, double(seq1.size()) * seq2.size());
+}
+BENCHMARK(BM_NeedlemanWunsch)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// Args: sequence length, error percent; one thread, so GCUPS compare with the other kernels
+void BM_NeedlemanWunschWavefront(benchmark::State& state) {
+    auto [seq1, seq2] = sequence_pair(state.range(0), state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(needleman_wunsch_wavefront(seq1, seq2, 1, -1, -1, 1).score);
+    }
+    set_gcups(state, double(seq1.size()) * seq2.size());
+}
+BENCHMARK(BM_NeedlemanWunschWavefront)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// Args: sequence length, error percent
+void BM_SmithWaterman(benchmark::State& state) {
+    auto [seq1, seq2] = sequence_pair(state.range(0), state.range(1));
+    AlignerContext context;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(smith_waterman_cigar(seq1, seq2, context).score);
+    }
+    set_gcups(state, double(seq1.size()) * seq2.size());
+}
+BENCHMARK(BM_SmithWaterman)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// Args: query length, error percent; 64 targets of the same length, one a copy of the query
+void BM_SmithWatermanBatch(benchmark::State& state) {
+    auto [query, target] = sequence_pair(state.range(0), state.range(1));
+    vector<string> targets = sample_reads(genome(1 << 20, 0), 63, query.size(), 0, 7);
+    targets.push_back(target);
+    double cells = 0;
+    for (const string& t : targets) {
+        cells += double(query.size()) * t.size();
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(smith_waterman_batch(query, targets));
+    }
+    set_gcups(state, cells);
+}
+BENCHMARK(BM_SmithWatermanBatch)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// Args: sequence length, error percent
+void BM_SmithWatermanAffine(benchmark::State& state) {
+    auto [seq1, seq2] = sequence_pair(state.range(0), state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(smith_waterman_affine_cigar(seq1, seq2).score);
+    }
+    set_gcups(state, double(seq1.size()) * seq2.size());
+}
+BENCHMARK(BM_SmithWatermanAffine)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// Args: sequence length, error percent
+void BM_SmithWatermanAffineStriped(benchmark::State& state) {
+    auto [seq1, seq2] = sequence_pair(state.range(0), state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(smith_waterman_affine_score(seq1, seq2));
+    }
+    set_gcups(state, double(seq1.size()) * seq2.size());
+}
+BENCHMARK(BM_SmithWatermanAffineStriped)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// Args: sequence length, error percent
+void BM_Hirschberg(benchmark::State& state) {
+    auto [seq1, seq2] = sequence_pair(state.range(0), state.range(1));
+    AlignerContext context;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hirschberg_cigar(seq1, seq2, context).score);
+    }
+    set_gcups(state, double(seq1.size()) * seq2.size());
+}
+BENCHMARK(BM_Hirschberg)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// Args: sequence length, error percent
+void BM_MyersMiller(benchmark::State& state) {
+    auto [seq1, seq2] = sequence_pair(state.range(0), state.range(1));
+    auto scoring = make_scoring(MatchMismatch{2, -1}, AffineGap{-3, -1});
+    AlignerContext context;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(myers_miller_cigar(seq1, seq2, scoring, context).score);
+    }
+    set_gcups(state, double(seq1.size()) * seq2.size());
+}
+BENCHMARK(BM_MyersMiller)->Apply(dp_args)->Unit(benchmark::kMicrosecond);
+
+// ---------------------------------------------------------------------------
+// Seed-and-extend
+// ---------------------------------------------------------------------------
+
+const size_t MAPPING_GENOME = 1 << 22;
+const size_t MAPPING_READS = 2000;
+
+/**
+ * Mapper settings (mapper.cpp): gapped extension of the best 5 chains.
+ */
+SeedExtendOptions mapping_options() {
+    SeedExtendOptions options;
+    options.max_hits = 500;
+    options.max_chains = 5;
+    options.extension.gapped = true;
+    return options;
+}
+
+// Args: read length, error percent, repeat percent
+void BM_SeedAndExtend(benchmark::State& state) {
+    const string& reference = genome(MAPPING_GENOME, state.range(2));
+    static map<int, KmerIndex> indexes;
+    auto it = indexes.find(state.range(2));
+    if (it == indexes.end()) {
+        it = indexes.emplace(state.range(2), build_kmer_index(reference, SeedShape::minimizer(10, 15), 500)).first;
+    }
+    vector<string> reads = sample_reads(reference, MAPPING_READS, state.range(0), state.range(1), 11);
+    SeedExtendOptions options = mapping_options();
+    SeedExtendContext context;
+    size_t mapped = 0;
+    for (auto _ : state) {
+        for (const string& read : reads) {
+            mapped += !seed_and_extend(it->second, reference, read, options, context).empty();
+        }
+    }
+    state.counters["reads/s"] = benchmark::Counter(reads.size(), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["mapped%"] = 100.0 * mapped / (state.iterations() * reads.size());
+}
+BENCHMARK(BM_SeedAndExtend)
+    ->ArgNames({"read", "error%", "repeat%"})
+    ->Args({150, 1, 0})->Args({150, 1, 30})->Args({150, 5, 30})->Args({1000, 5, 30})
+    ->Unit(benchmark::kMillisecond);
+
+// Args: read length, error percent, repeat percent
+void BM_SeedAndExtendSMEM(benchmark::State& state) {
+    const string& reference = genome(MAPPING_GENOME, state.range(2));
+    static map<int, unique_ptr<BidirectionalFMIndex>> indexes;
+    auto it = indexes.find(state.range(2));
+    if (it == indexes.end()) {
+        it = indexes.emplace(state.range(2), make_unique<BidirectionalFMIndex>(reference)).first;
+    }
+    vector<string> reads = sample_reads(reference, MAPPING_READS, state.range(0), state.range(1), 11);
+    SeedExtendOptions options = mapping_options();
+    options.min_smem_length = 19;
+    SeedExtendContext context;
+    size_t mapped = 0;
+    for (auto _ : state) {
+        for (const string& read : reads) {
+            mapped += !seed_and_extend(*it->second, reference, read, options, context).empty();
+        }
+    }
+    state.counters["reads/s"] = benchmark::Counter(reads.size(), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["mapped%"] = 100.0 * mapped / (state.iterations() * reads.size());
+}
+BENCHMARK(BM_SeedAndExtendSMEM)
+    ->ArgNames({"read", "error%", "repeat%"})
+    ->Args({150, 1, 0})->Args({150, 1, 30})->Args({150, 5, 30})->Args({1000, 5, 30})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,241 @@
+/**
+ * Compact Alignment Results
+ *
+ * An alignment is stored as coordinates plus a run-length CIGAR instead of two
+ * gapped strings:
+ * - Cigar: runs packed BAM-style into one uint32_t each, (length << 4) | op
+ * - CigarSpan: the same runs in storage the caller provides, e.g. a scratch
+ *   arena, for partial scripts built without touching the heap
+ * - AlignmentResult: score, the aligned interval of each sequence, the CIGAR
+ *   and non-owning views of the two input sequences
+ * - Alignment: the gapped rows of a result, for display
+ *
+ * Tracebacks push one operation at a time from the end of the alignment and
+ * reverse once, so building a result is linear in the number of runs rather
+ * than quadratic in the alignment length. Gapped strings are only rendered
+ * when asked for.
+ *
+ * Operations follow SAM with seq2 as the reference: 'M' aligns a base of each
+ * sequence (match or mismatch), 'I' is a base of seq1 against a gap and 'D'
+ * a base of seq2 against a gap.
+ */
+
+#ifndef CIGAR_H
+#define CIGAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+/**
+ * Run-length edit script of an alignment.
+ */
+class Cigar {
+private:
+    friend class CigarSpan;
+
+    static constexpr const char* OPS = "MID";
+    std::vector<uint32_t> runs;
+
+    static uint32_t op_code(char op) {
+        return op == 'M' ? 0 : op == 'I' ? 1 : 2;
+    }
+
+public:
+    /**
+     * Append length copies of op, merging with the last run when it is the same op.
+     */
+    void push(char op, uint32_t length = 1) {
+        if (length == 0) {
+            return;
+        }
+        uint32_t code = op_code(op);
+        if (!runs.empty() && (runs.back() & 0xf) == code) {
+            runs.back() += length << 4;
+        } else {
+            runs.push_back((length << 4) | code);
+        }
+    }
+
+    /**
+     * Append all runs of other (a Cigar or CigarSpan).
+     */
+    template <typename Script>
+    void append(const Script& other) {
+        for (size_t r = 0; r < other.size(); r++) {
+            push(other.op(r), other.length(r));
+        }
+    }
+
+    /**
+     * Reverse the run order (for scripts pushed from the end of the alignment).
+     */
+    void reverse() { std::reverse(runs.begin(), runs.end()); }
+
+    /**
+     * Swap I and D runs, turning the script of seq1 against seq2 into that of
+     * seq2 against seq1.
+     */
+    void transpose() {
+        for (uint32_t& run : runs) {
+            if ((run & 0xf) != 0) {
+                run ^= 3;  // 1 (I) <-> 2 (D)
+            }
+        }
+    }
+
+    void clear() { runs.clear(); }
+    bool empty() const { return runs.empty(); }
+    size_t size() const { return runs.size(); }
+    char op(size_t r) const { return OPS[runs[r] & 0xf]; }
+    uint32_t length(size_t r) const { return runs[r] >> 4; }
+
+    /**
+     * Bases of seq1 (M and I) covered by the script.
+     */
+    size_t seq1_length() const {
+        size_t total = 0;
+        for (uint32_t run : runs) {
+            total += (run & 0xf) != 2 ? run >> 4 : 0;
+        }
+        return total;
+    }
+
+    /**
+     * Bases of seq2 (M and D) covered by the script.
+     */
+    size_t seq2_length() const {
+        size_t total = 0;
+        for (uint32_t run : runs) {
+            total += (run & 0xf) != 1 ? run >> 4 : 0;
+        }
+        return total;
+    }
+
+    /**
+     * SAM text form, e.g. "5M1I3M".
+     */
+    std::string str() const {
+        std::string text;
+        for (uint32_t run : runs) {
+            text += std::to_string(run >> 4);
+            text += OPS[run & 0xf];
+        }
+        return text;
+    }
+};
+
+/**
+ * Run-length edit script in caller-provided storage of packed runs. A script
+ * of k operations has at most k runs, so storage for k runs always suffices.
+ */
+class CigarSpan {
+private:
+    uint32_t* runs;
+    size_t count = 0;
+
+public:
+    explicit CigarSpan(uint32_t* storage) : runs(storage) {}
+
+    /**
+     * Append length copies of op, merging with the last run when it is the same op.
+     */
+    void push(char op, uint32_t length = 1) {
+        if (length == 0) {
+            return;
+        }
+        uint32_t code = Cigar::op_code(op);
+        if (count > 0 && (runs[count - 1] & 0xf) == code) {
+            runs[count - 1] += length << 4;
+        } else {
+            runs[count++] = (length << 4) | code;
+        }
+    }
+
+    /**
+     * Append all runs of other (a Cigar or CigarSpan).
+     */
+    template <typename Script>
+    void append(const Script& other) {
+        for (size_t r = 0; r < other.size(); r++) {
+            push(other.op(r), other.length(r));
+        }
+    }
+
+    size_t size() const { return count; }
+    char op(size_t r) const { return Cigar::OPS[runs[r] & 0xf]; }
+    uint32_t length(size_t r) const { return runs[r] >> 4; }
+};
+
+/**
+ * Alignment of seq1[start1, end1) against seq2[start2, end2).
+ *
+ * seq1 and seq2 view the complete input sequences, which must outlive the
+ * result; the aligned regions and the gapped rows are derived from them.
+ */
+struct AlignmentResult {
+    int score = 0;
+    int start1 = 0;
+    int end1 = 0;
+    int start2 = 0;
+    int end2 = 0;
+    Cigar cigar;
+    std::string_view seq1;
+    std::string_view seq2;
+
+    std::string_view region1() const { return seq1.substr(start1, end1 - start1); }
+    std::string_view region2() const { return seq2.substr(start2, end2 - start2); }
+
+    /**
+     * Gapped rows of the alignment, '-' marking gaps.
+     */
+    std::pair<std::string, std::string> render() const {
+        std::pair<std::string, std::string> rows;
+        size_t columns = 0;
+        for (size_t r = 0; r < cigar.size(); r++) {
+            columns += cigar.length(r);
+        }
+        rows.first.reserve(columns);
+        rows.second.reserve(columns);
+
+        size_t i = start1, j = start2;
+        for (size_t r = 0; r < cigar.size(); r++) {
+            uint32_t len = cigar.length(r);
+            switch (cigar.op(r)) {
+                case 'M':
+                    rows.first.append(seq1.substr(i, len));
+                    rows.second.append(seq2.substr(j, len));
+                    i += len;
+                    j += len;
+                    break;
+                case 'I':
+                    rows.first.append(seq1.substr(i, len));
+                    rows.second.append(len, '-');
+                    i += len;
+                    break;
+                default:
+                    rows.first.append(len, '-');
+                    rows.second.append(seq2.substr(j, len));
+                    j += len;
+                    break;
+            }
+        }
+        return rows;
+    }
+};
+
+/**
+ * An alignment rendered as two gapped rows, as returned by needleman_wunsch(),
+ * smith_waterman() and the other string-returning aligners.
+ */
+struct Alignment {
+    std::string aligned_seq1;
+    std::string aligned_seq2;
+    int score;
+};
+
+#endif // CIGAR_H
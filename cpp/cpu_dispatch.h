@@ -0,0 +1,46 @@
+/**
+ * Instruction Set Dispatch
+ *
+ * The SIMD kernels (X-drop extension, wavefront fill, batched and striped
+ * Smith-Waterman) are compiled once per instruction set with target
+ * attributes, and each picks the widest variant the CPU supports on first
+ * use. ALIGN_CPU_SUPPORTS(feature) is that test:
+ * - by default it asks the running CPU (__builtin_cpu_supports), so one
+ *   binary runs at full width on every x86-64 machine
+ * - with ALIGN_NO_ISA_DISPATCH (cmake -DALIGN_ISA_DISPATCH=OFF) it is a
+ *   constant from the instruction sets the compiler targets (-march), so
+ *   only that variant is kept and the binary runs only on such machines
+ *
+ * Features are named as for __builtin_cpu_supports: "avx512bw", "avx2",
+ * "sse4.1".
+ */
+
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include <string_view>
+
+/**
+ * Whether the compiler targets an instruction set (see above).
+ */
+constexpr bool cpu_target_has(std::string_view feature) {
+    bool avx512bw = false, avx2 = false, sse41 = false;
+#ifdef __AVX512BW__
+    avx512bw = true;
+#endif
+#ifdef __AVX2__
+    avx2 = true;
+#endif
+#ifdef __SSE4_1__
+    sse41 = true;
+#endif
+    return (feature == "avx512bw" && avx512bw) || (feature == "avx2" && avx2) || (feature == "sse4.1" && sse41);
+}
+
+#ifdef ALIGN_NO_ISA_DISPATCH
+#define ALIGN_CPU_SUPPORTS(feature) cpu_target_has(feature)
+#else
+#define ALIGN_CPU_SUPPORTS(feature) __builtin_cpu_supports(feature)
+#endif
+
+#endif // CPU_DISPATCH_H
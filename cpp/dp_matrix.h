@@ -0,0 +1,296 @@
+/**
+ * Dynamic Programming Matrix Storage
+ *
+ * Shared storage types for the DP aligners:
+ * - DPMatrix<T>: a score matrix in one flat, cache-line aligned allocation
+ *   (rows padded to a multiple of 64 bytes) instead of one heap block per row
+ * - TracebackMatrix<BITS>: 2, 4 or 8 bits per cell recording, during the
+ *   forward pass, which move produced each cell, so that traceback is a pure
+ *   walk over the codes without recomputing any score
+ *
+ * - ScratchArena: a bump allocator the aligners take their per-call buffers
+ *   from, released all at once when a scope ends, so that repeated alignments
+ *   reuse the same memory instead of calling malloc
+ *
+ * A 2-bit traceback is 16x smaller than an int score matrix; aligners that
+ * keep only two rows of scores plus a traceback matrix need O(n) score memory.
+ */
+
+#ifndef DP_MATRIX_H
+#define DP_MATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+
+/**
+ * Deleter for blocks from dp_aligned_alloc(); a no-op for memory borrowed
+ * from a ScratchArena.
+ */
+struct AlignedFree {
+    bool owned = true;
+
+    void operator()(void* p) const {
+        if (owned) {
+            std::free(p);
+        }
+    }
+};
+
+/**
+ * Allocate a 64-byte aligned block (aligned_alloc needs a multiple of the alignment).
+ */
+inline void* dp_aligned_alloc(size_t bytes) {
+    const size_t ALIGN = 64;
+    size_t size = std::max<size_t>((bytes + ALIGN - 1) / ALIGN * ALIGN, ALIGN);
+    void* p = std::aligned_alloc(ALIGN, size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+/**
+ * Bump allocator over 64-byte aligned blocks.
+ *
+ * Allocation moves a cursor; nothing is freed individually. A Scope records
+ * the cursor and moves it back when it ends, releasing everything allocated
+ * since, so scopes nest like the calls that open them. When a block is full
+ * the next one is used, or a new one of at least the arena's current
+ * capacity is added; once the arena is rewound to empty, several blocks are
+ * replaced by one of their combined size. After the largest call has run
+ * once, the same calls allocate nothing.
+ *
+ * Only trivially destructible types may be allocated. An arena is used by
+ * one thread at a time.
+ */
+class ScratchArena {
+private:
+    static constexpr size_t ALIGN = 64;
+    static constexpr size_t MIN_BLOCK = 1 << 16;
+
+    struct Block {
+        std::unique_ptr<uint8_t, AlignedFree> data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t current = 0;  // Block being allocated from
+    size_t used = 0;     // Bytes taken from blocks[current]
+
+public:
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+
+    /**
+     * Rewinds the arena to where it was when the scope was opened.
+     */
+    class Scope {
+    private:
+        ScratchArena& arena;
+        Mark mark;
+
+    public:
+        explicit Scope(ScratchArena& arena) : arena(arena), mark(arena.position()) {}
+        ~Scope() { arena.rewind(mark); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    ScratchArena() = default;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * Uninitialized, 64-byte aligned storage for bytes bytes.
+     */
+    void* allocate_bytes(size_t bytes) {
+        bytes = std::max<size_t>((bytes + ALIGN - 1) / ALIGN * ALIGN, ALIGN);
+        if (current < blocks.size() && used + bytes <= blocks[current].size) {
+            void* p = blocks[current].data.get() + used;
+            used += bytes;
+            return p;
+        }
+
+        // Move on to the next block, inserting a larger one if it is too small
+        size_t next = blocks.empty() ? 0 : current + 1;
+        if (next == blocks.size() || blocks[next].size < bytes) {
+            size_t size = std::max(bytes, std::max(MIN_BLOCK, capacity()));
+            Block block = {std::unique_ptr<uint8_t, AlignedFree>(static_cast<uint8_t*>(dp_aligned_alloc(size))),
+                           size};
+            blocks.insert(blocks.begin() + next, std::move(block));
+        }
+        current = next;
+        used = bytes;
+        return blocks[current].data.get();
+    }
+
+    /**
+     * Uninitialized storage for count objects of type T.
+     */
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destroyed");
+        return static_cast<T*>(allocate_bytes(count * sizeof(T)));
+    }
+
+    Mark position() const { return {current, used}; }
+
+    /**
+     * Release everything allocated after mark was taken.
+     */
+    void rewind(const Mark& mark) {
+        current = mark.block;
+        used = mark.used;
+        if (current == 0 && used == 0 && blocks.size() > 1) {
+            size_t size = capacity();
+            blocks.clear();
+            blocks.push_back({std::unique_ptr<uint8_t, AlignedFree>(static_cast<uint8_t*>(dp_aligned_alloc(size))),
+                              size});
+        }
+    }
+
+    /**
+     * Total bytes of all blocks.
+     */
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+};
+
+/**
+ * Standard allocator drawing from a ScratchArena; deallocation is a no-op,
+ * the memory returns to the arena when the enclosing scope ends.
+ */
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    ScratchArena* arena;
+
+    explicit ArenaAllocator(ScratchArena& arena) : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) { return arena->allocate<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+/**
+ * Growable buffer in arena memory, for results whose size is not known up
+ * front. It must not outlive the scope it was filled in.
+ */
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/**
+ * Dense row-major matrix in a single 64-byte aligned allocation.
+ */
+template <typename T>
+class DPMatrix {
+private:
+    size_t n_rows = 0;
+    size_t n_cols = 0;
+    size_t stride = 0;  // Elements per row, padded to whole cache lines
+    std::unique_ptr<T, AlignedFree> data;
+
+public:
+    DPMatrix() = default;
+
+    DPMatrix(size_t rows, size_t cols, T fill = T())
+        : n_rows(rows), n_cols(cols) {
+        const size_t per_line = std::max<size_t>(64 / sizeof(T), 1);
+        stride = (cols + per_line - 1) / per_line * per_line;
+        data.reset(static_cast<T*>(dp_aligned_alloc(rows * stride * sizeof(T))));
+        std::fill(data.get(), data.get() + rows * stride, fill);
+    }
+
+    /**
+     * Matrix in arena memory, valid until the arena is rewound past it.
+     */
+    DPMatrix(size_t rows, size_t cols, T fill, ScratchArena& arena)
+        : n_rows(rows), n_cols(cols), data(nullptr, AlignedFree{false}) {
+        const size_t per_line = std::max<size_t>(64 / sizeof(T), 1);
+        stride = (cols + per_line - 1) / per_line * per_line;
+        data.reset(arena.allocate<T>(rows * stride));
+        std::fill(data.get(), data.get() + rows * stride, fill);
+    }
+
+    T& operator()(size_t i, size_t j) { return data.get()[i * stride + j]; }
+    const T& operator()(size_t i, size_t j) const { return data.get()[i * stride + j]; }
+
+    T* row(size_t i) { return data.get() + i * stride; }
+    const T* row(size_t i) const { return data.get() + i * stride; }
+
+    size_t rows() const { return n_rows; }
+    size_t cols() const { return n_cols; }
+};
+
+/**
+ * Packed per-cell traceback codes of BITS bits (2, 4 or 8).
+ *
+ * Cells are zero-initialized; set() must be called at most once per cell.
+ */
+template <unsigned BITS>
+class TracebackMatrix {
+    static_assert(BITS == 2 || BITS == 4 || BITS == 8, "BITS must be 2, 4 or 8");
+
+private:
+    static const unsigned PER_BYTE = 8 / BITS;
+    static const uint8_t MASK = (1u << BITS) - 1;
+
+    size_t n_rows = 0;
+    size_t n_cols = 0;
+    size_t stride = 0;  // Bytes per row, padded to whole cache lines
+    std::unique_ptr<uint8_t, AlignedFree> data;
+
+public:
+    TracebackMatrix() = default;
+
+    TracebackMatrix(size_t rows, size_t cols) : n_rows(rows), n_cols(cols) {
+        stride = ((cols + PER_BYTE - 1) / PER_BYTE + 63) / 64 * 64;
+        data.reset(static_cast<uint8_t*>(dp_aligned_alloc(rows * stride)));
+        std::memset(data.get(), 0, rows * stride);
+    }
+
+    /**
+     * Matrix in arena memory, valid until the arena is rewound past it.
+     */
+    TracebackMatrix(size_t rows, size_t cols, ScratchArena& arena)
+        : n_rows(rows), n_cols(cols), data(nullptr, AlignedFree{false}) {
+        stride = ((cols + PER_BYTE - 1) / PER_BYTE + 63) / 64 * 64;
+        data.reset(arena.allocate<uint8_t>(rows * stride));
+        std::memset(data.get(), 0, rows * stride);
+    }
+
+    void set(size_t i, size_t j, uint8_t code) {
+        data.get()[i * stride + j / PER_BYTE] |= (code & MASK) << (BITS * (j % PER_BYTE));
+    }
+
+    uint8_t get(size_t i, size_t j) const {
+        return (data.get()[i * stride + j / PER_BYTE] >> (BITS * (j % PER_BYTE))) & MASK;
+    }
+
+    size_t rows() const { return n_rows; }
+    size_t cols() const { return n_cols; }
+};
+
+#endif // DP_MATRIX_H
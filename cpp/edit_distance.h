@@ -0,0 +1,270 @@
+/**
+ * Bit-Parallel Edit Distance (Myers 1999, Hyyrö 2003)
+ *
+ * The unit-cost edit distance DP changes by -1, 0 or +1 between neighbouring
+ * cells, so a column of it is two bit vectors: Pv (the cell is one more than
+ * the cell above) and Mv (one less). Myers' algorithm derives the next column
+ * from the current one with about 15 word operations, processing 64 pattern
+ * positions per machine word:
+ * - Patterns longer than 64 are split into 64-row blocks; the horizontal
+ *   delta out of one block's last row is carried into the next
+ * - distance() is the global (Levenshtein) distance of pattern and text
+ *   (Hyyrö's variant: the top row grows by one per column)
+ * - search() is semi-global: the pattern may match any substring of the
+ *   text, reporting the best end position and, by an anchored pass of the
+ *   reversed pattern, where that match starts
+ *
+ * With a threshold k, distance() stops as soon as the last row can no longer
+ * come back down to k, and returns -1; used as a pre-filter this rejects a
+ * hopeless candidate after a fraction of its columns. A pattern object can
+ * be reassigned, keeping its storage, and distance() and search_distance()
+ * allocate nothing for patterns of up to 512 characters.
+ *
+ * Characters are compared byte for byte, as in the DP aligners.
+ */
+
+#ifndef EDIT_DISTANCE_H
+#define EDIT_DISTANCE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Best semi-global match: pattern against text[start, end).
+ */
+struct EditMatch {
+    int distance = -1;  // -1 if no match is within the threshold
+    size_t start = 0;
+    size_t end = 0;
+};
+
+/**
+ * Pattern preprocessed for bit-parallel edit distance: one bit mask per
+ * distinct character and 64-row block, set where the pattern has it.
+ */
+class MyersPattern {
+private:
+    std::string pattern;
+    size_t words = 0;
+    uint64_t last_bit = 0;            // Bit of the last pattern row in the last block
+    std::array<uint16_t, 256> slot{}; // Row of each character's masks; 0 = not in the pattern
+    std::vector<uint64_t> peq;        // peq[slot * words + block]
+
+    /**
+     * Advance one 64-row block by one text column; returns the horizontal
+     * delta out of the row marked by high, given the delta hin into its top.
+     */
+    static inline int advance_block(uint64_t& Pv, uint64_t& Mv, uint64_t eq, int hin, uint64_t high) {
+        uint64_t Xv = eq | Mv;
+        if (hin < 0) {
+            eq |= 1;
+        }
+        uint64_t Xh = (((eq & Pv) + Pv) ^ Pv) | eq;
+        uint64_t Ph = Mv | ~(Xh | Pv);
+        uint64_t Mh = Pv & Xh;
+
+        int hout = (Ph & high) ? 1 : (Mh & high) ? -1 : 0;
+        Ph <<= 1;
+        Mh <<= 1;
+        if (hin < 0) {
+            Mh |= 1;
+        } else if (hin > 0) {
+            Ph |= 1;
+        }
+        Pv = Mh | ~(Xv | Ph);
+        Mv = Ph & Xv;
+        return hout;
+    }
+
+    /**
+     * Run the pattern over text, calling column(j, score) with the last-row
+     * score after text[j]; stops early when column returns false.
+     *
+     * GLOBAL charges one per skipped leading text character (top row j);
+     * otherwise the top row is 0 and a match may start anywhere.
+     */
+    template <bool GLOBAL, typename Column>
+    void scan(std::string_view text, Column column) const {
+        int score = pattern.size();
+        if (words == 1) {
+            uint64_t Pv = ~uint64_t(0), Mv = 0;
+            for (size_t j = 0; j < text.size(); j++) {
+                uint64_t eq = peq[slot[static_cast<unsigned char>(text[j])]];
+                score += advance_block(Pv, Mv, eq, GLOBAL ? 1 : 0, last_bit);
+                if (!column(j, score)) {
+                    return;
+                }
+            }
+            return;
+        }
+
+        // Column state on the stack unless the pattern is very long
+        const size_t STACK_WORDS = 8;
+        uint64_t stack[2 * STACK_WORDS];
+        std::vector<uint64_t> heap;
+        uint64_t* Pv = stack;
+        if (words > STACK_WORDS) {
+            heap.resize(2 * words);
+            Pv = heap.data();
+        }
+        uint64_t* Mv = Pv + words;
+        std::fill(Pv, Pv + words, ~uint64_t(0));
+        std::fill(Mv, Mv + words, uint64_t(0));
+        const uint64_t HIGH = uint64_t(1) << 63;
+        for (size_t j = 0; j < text.size(); j++) {
+            const uint64_t* eq = &peq[slot[static_cast<unsigned char>(text[j])] * words];
+            int carry = GLOBAL ? 1 : 0;
+            for (size_t b = 0; b + 1 < words; b++) {
+                carry = advance_block(Pv[b], Mv[b], eq[b], carry, HIGH);
+            }
+            score += advance_block(Pv[words - 1], Mv[words - 1], eq[words - 1], carry, last_bit);
+            if (!column(j, score)) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Best last-row score over all text columns (or of deleting the whole
+     * pattern), and the first end reaching it.
+     */
+    void best_end(std::string_view text, int& best, size_t& end) const {
+        best = pattern.size();
+        end = 0;
+        if (best > 0) {
+            scan<false>(text, [&](size_t j, int score) {
+                if (score < best) {
+                    best = score;
+                    end = j + 1;
+                }
+                return best > 0;
+            });
+        }
+    }
+
+public:
+    MyersPattern() = default;
+
+    explicit MyersPattern(std::string_view pattern) { assign(pattern); }
+
+    /**
+     * Preprocess a new pattern, reusing this one's storage.
+     */
+    void assign(std::string_view pattern) {
+        this->pattern.assign(pattern.data(), pattern.size());
+        slot.fill(0);
+        words = pattern.empty() ? 0 : (pattern.size() + 63) / 64;
+        last_bit = pattern.empty() ? 0 : uint64_t(1) << ((pattern.size() - 1) % 64);
+        uint16_t rows = 1;
+        for (char c : pattern) {
+            uint16_t& s = slot[static_cast<unsigned char>(c)];
+            if (s == 0) {
+                s = rows++;
+            }
+        }
+        peq.assign(size_t(rows) * words, 0);
+        for (size_t i = 0; i < pattern.size(); i++) {
+            peq[slot[static_cast<unsigned char>(pattern[i])] * words + i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+
+    size_t length() const { return pattern.size(); }
+
+    /**
+     * Global edit distance of the pattern and text.
+     *
+     * @param max_distance Threshold k; -1 means none
+     * @return The distance, or -1 if it exceeds max_distance
+     */
+    int distance(std::string_view text, int max_distance = -1) const {
+        const int m = pattern.size();
+        const int n = text.size();
+        if (max_distance >= 0 && std::abs(m - n) > max_distance) {
+            return -1;
+        }
+        if (m == 0) {
+            return n;
+        }
+
+        // Each remaining column lowers the last row by at most one
+        int result = m;
+        scan<true>(text, [&](size_t j, int score) {
+            result = score;
+            return max_distance < 0 || score - (n - int(j) - 1) <= max_distance;
+        });
+        if (max_distance >= 0 && result > max_distance) {
+            return -1;
+        }
+        return result;
+    }
+
+    /**
+     * Best match of the pattern against any substring of text.
+     *
+     * Among equally good matches the one ending first is reported, with the
+     * latest start (shortest substring) that achieves its distance.
+     *
+     * @param max_distance Threshold k; -1 means none
+     */
+    EditMatch search(std::string_view text, int max_distance = -1) const {
+        EditMatch match;
+        int best;
+        size_t end;
+        best_end(text, best, end);
+        if (max_distance >= 0 && best > max_distance) {
+            return match;
+        }
+        match.distance = best;
+        match.end = end;
+        match.start = end;
+
+        // Anchor the reversed pattern at end and walk left to the first column reaching best
+        if (best < int(pattern.size())) {
+            std::string reversed(pattern.rbegin(), pattern.rend());
+            std::string before(text.substr(0, end));
+            std::string text_reversed(before.rbegin(), before.rend());
+            MyersPattern(reversed).scan<true>(text_reversed, [&](size_t j, int score) {
+                if (score == best) {
+                    match.start = end - (j + 1);
+                    return false;
+                }
+                return true;
+            });
+        }
+        return match;
+    }
+
+    /**
+     * Distance of search()'s best match alone, without locating its start.
+     *
+     * @return The distance, or -1 if it exceeds max_distance
+     */
+    int search_distance(std::string_view text, int max_distance = -1) const {
+        int best;
+        size_t end;
+        best_end(text, best, end);
+        return max_distance >= 0 && best > max_distance ? -1 : best;
+    }
+};
+
+/**
+ * Global edit distance of a and b, or -1 if it exceeds max_distance (-1 = no limit).
+ */
+inline int edit_distance(std::string_view a, std::string_view b, int max_distance = -1) {
+    return MyersPattern(a).distance(b, max_distance);
+}
+
+/**
+ * Best semi-global match of pattern in text (see MyersPattern::search()).
+ */
+inline EditMatch edit_search(std::string_view pattern, std::string_view text, int max_distance = -1) {
+    return MyersPattern(pattern).search(text, max_distance);
+}
+
+#endif // EDIT_DISTANCE_H
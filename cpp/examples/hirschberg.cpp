@@ -0,0 +1,104 @@
+/**
+ * Hirschberg Space-Efficient Global Alignment - Example
+ * 
+ * Demonstrates hirschberg.h: linear-space global alignment with linear gaps
+ * (Hirschberg), banded, and with affine gaps (Myers-Miller).
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include "hirschberg.h"
+
+using namespace std;
+
+int main() {
+    // Example usage demonstrating the Hirschberg algorithm
+    cout << "Hirschberg Space-Efficient Global Alignment" << endl;
+    cout << string(60, '=') << endl;
+    
+    // Example 1: DNA sequence alignment
+    cout << "\nExample 1: DNA Sequence Alignment" << endl;
+    cout << string(60, '-') << endl;
+    string seq1 = "GATTACA";
+    string seq2 = "GCATGCU";
+    
+    Alignment result = hirschberg(seq1, seq2);
+    
+    cout << "Sequence 1: " << seq1 << endl;
+    cout << "Sequence 2: " << seq2 << endl;
+    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
+    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
+    cout << "Alignment Score: " << result.score << endl;
+    cout << "CIGAR: " << hirschberg_cigar(seq1, seq2).cigar.str() << endl;
+    
+    // Example 2: Custom scoring parameters
+    cout << "\n\nExample 2: Custom Scoring Parameters" << endl;
+    cout << string(60, '-') << endl;
+    seq1 = "HEAGAWGHEE";
+    seq2 = "PAWHEAE";
+    
+    result = hirschberg(seq1, seq2, 2, -1, -2);
+    
+    cout << "Sequence 1: " << seq1 << endl;
+    cout << "Sequence 2: " << seq2 << endl;
+    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
+    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
+    cout << "Alignment Score: " << result.score << endl;
+    cout << "Parameters: match=2, mismatch=-1, gap=-2" << endl;
+    
+    // Example 3: Identical sequences
+    cout << "\n\nExample 3: Identical Sequences" << endl;
+    cout << string(60, '-') << endl;
+    seq1 = "ACGTACGT";
+    seq2 = "ACGTACGT";
+    
+    result = hirschberg(seq1, seq2);
+    
+    cout << "Sequence 1: " << seq1 << endl;
+    cout << "Sequence 2: " << seq2 << endl;
+    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
+    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
+    cout << "Alignment Score: " << result.score << endl;
+    
+    // Example 4: Banded alignment of similar sequences
+    cout << "\n\nExample 4: Banded Alignment (band width 2)" << endl;
+    cout << string(60, '-') << endl;
+    seq1 = "ACGTACGTTAGCATGCA";
+    seq2 = "ACGTCGTTAGGCATGCA";
+    
+    result = hirschberg(seq1, seq2, 1, -1, -1, 2);
+    
+    cout << "Sequence 1: " << seq1 << endl;
+    cout << "Sequence 2: " << seq2 << endl;
+    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
+    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
+    cout << "Alignment Score: " << result.score << endl;
+    
+    // Example 5: Affine gaps in linear space (Myers-Miller)
+    cout << "\n\nExample 5: Affine Gaps (Myers-Miller)" << endl;
+    cout << string(60, '-') << endl;
+    seq1 = "ACGTACGTACGTTTGCAAGT";
+    seq2 = "ACGTACGTGCAAGT";
+    
+    result = myers_miller(seq1, seq2, 2, -1, -4, -1);
+    
+    cout << "Sequence 1: " << seq1 << endl;
+    cout << "Sequence 2: " << seq2 << endl;
+    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
+    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
+    cout << "Alignment Score: " << result.score << endl;
+    cout << "Parameters: match=2, mismatch=-1, gap_open=-4, gap_extend=-1" << endl;
+    
+    // Example 6: Space complexity comparison
+    cout << "\n\nSpace Complexity Comparison" << endl;
+    cout << string(60, '-') << endl;
+    int m = 1000, n = 1000;
+    cout << "For sequences of length " << m << " and " << n << ":" << endl;
+    cout << "  Needleman-Wunsch space: O(" << m << " x " << n << ") = ~" << (m * n) << " integers" << endl;
+    cout << "  Hirschberg space: O(min(" << m << ", " << n << ")) = ~" << min(m, n) << " integers" << endl;
+    cout << "  Space reduction: ~" << (static_cast<double>(m * n) / min(m, n)) << "x improvement" << endl;
+    
+    return 0;
+}
@@ -0,0 +1,347 @@
+/**
+ * Multithreaded Read Mapper
+ *
+ * Maps FASTQ reads against a FASTA reference and writes SAM:
+ * 1. The reference (all contigs, separated by an 'N' so no seed spans two)
+ *    is indexed once; the k-mer index (or FM-index) is shared read-only by
+ *    all workers
+ * 2. The main thread streams the FASTQ (memory-mapped, or block-read from a
+ *    pipe; "-" is stdin) in zero-copy chunks of reads and submits each chunk
+ *    to a work-stealing thread pool
+ * 3. A worker runs seed -> chain -> (verify) -> gapped extend for both strands of every
+ *    read of its chunk and formats the SAM records into one buffer
+ * 4. An ordered writer emits chunk buffers strictly in input order, so the
+ *    output is identical whatever the thread count
+ *
+ * Chunks in flight are bounded, so memory stays flat however large the read
+ * set is. Workers share nothing mutable but the pool deques and the writer,
+ * which each see one operation per chunk, so throughput scales with cores
+ * until the single reader or writer thread saturates.
+ *
+ * Usage: mapper [options] reference.fa reads.fq > out.sam
+ *   -t N   worker threads for indexing and mapping (default: all cores)
+ *   -k N   k-mer length (default: 15)
+ *   -w N   minimizer window, 1 = every k-mer (default: 10)
+ *   -c N   reads per chunk (default: 4096)
+ *   -m N   mask k-mers occurring more than N times (default: 500, 0 = off)
+ *   -e N   skip candidates the read can't match within N edits (default: off)
+ *   -s N   seed with SMEMs of at least N bases from an FM-index instead of
+ *          minimizers (default: 0 = off)
+ *   -j F   write pipeline counters and stage timings (metrics.h) to F as JSON
+ *   -p F   ... or in the Prometheus text format; both need -DALIGN_METRICS,
+ *          otherwise every value is zero
+ */
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "metrics.h"
+#include "seed_and_extend.h"
+#include "seq_io.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+string reverse_complement(const string& seq) {
+    string rc(seq.rbegin(), seq.rend());
+    for (char& c : rc) {
+        switch (c) {
+            case 'A': c = 'T'; break;
+            case 'C': c = 'G'; break;
+            case 'G': c = 'C'; break;
+            case 'T': c = 'A'; break;
+            case 'a': c = 't'; break;
+            case 'c': c = 'g'; break;
+            case 'g': c = 'c'; break;
+            case 't': c = 'a'; break;
+            default: c = 'N'; break;
+        }
+    }
+    return rc;
+}
+
+/**
+ * Shared, read-only state of a mapping run.
+ */
+struct Mapper {
+    Reference reference;
+    KmerIndex index;
+    unique_ptr<BidirectionalFMIndex> smem_index;  // Seeds with SMEMs instead of index when set
+    SeedExtendOptions options;
+
+    /**
+     * Map both strands of read and append its SAM record to out.
+     */
+    void map_read(const FastqRecord& read, string& out) const {
+        StageTimer timer(Stage::Read);
+        string seq(read.sequence);
+        string rc = reverse_complement(seq);
+        // One context per strand, so both strands' hits stay valid together
+        thread_local SeedExtendContext contexts[2];
+        auto align = [this](const string& query, SeedExtendContext& context) -> const vector<AlignmentHit>& {
+            return smem_index ? seed_and_extend(*smem_index, reference.sequence, query, options, context)
+                              : seed_and_extend(index, reference.sequence, query, options, context);
+        };
+        const vector<AlignmentHit>& forward = align(seq, contexts[0]);
+        const vector<AlignmentHit>& reverse = align(rc, contexts[1]);
+
+        const AlignmentHit* best = nullptr;
+        bool is_reverse = false;
+        int second = 0;
+        for (int strand = 0; strand < 2; strand++) {
+            for (const AlignmentHit& hit : strand ? reverse : forward) {
+                if (!best || hit.score > best->score) {
+                    second = best ? max(second, best->score) : second;
+                    best = &hit;
+                    is_reverse = strand;
+                } else if (!(hit.ref_start == best->ref_start && hit.query_start == best->query_start)) {
+                    second = max(second, hit.score);
+                }
+            }
+        }
+
+        ostringstream sam;
+        if (!best || best->score <= 0) {
+            sam << read.name << "\t4\t*\t0\t0\t*\t*\t0\t0\t" << seq << '\t'
+                << read.quality << '\n';
+            out += sam.str();
+            return;
+        }
+
+        const Contig& contig = reference.contig_at(best->ref_start);
+        int mapq = (int)(60.0 * (1.0 - (double)second / best->score));
+        mapq = max(0, min(60, mapq));
+
+        int read_length = seq.length();
+        string cigar;
+        if (best->query_start > 0) {
+            cigar += to_string(best->query_start) + "S";
+        }
+        cigar += best->cigar.str();
+        if (best->query_end < read_length) {
+            cigar += to_string(read_length - best->query_end) + "S";
+        }
+
+        // Edit distance: mismatches in M runs plus all gap bases
+        int edits = 0;
+        size_t q = best->query_start, r = best->ref_start;
+        for (size_t run = 0; run < best->cigar.size(); run++) {
+            uint32_t len = best->cigar.length(run);
+            char op = best->cigar.op(run);
+            if (op == 'M') {
+                for (uint32_t k = 0; k < len; k++) {
+                    edits += best->query[q + k] != best->reference[r + k];
+                }
+                q += len;
+                r += len;
+            } else {
+                edits += len;
+                (op == 'I' ? q : r) += len;
+            }
+        }
+
+        string qual = is_reverse ? string(read.quality.rbegin(), read.quality.rend()) : string(read.quality);
+        sam << read.name << '\t' << (is_reverse ? 16 : 0) << '\t' << contig.name << '\t'
+            << (best->ref_start - contig.offset + 1) << '\t' << mapq << '\t' << cigar
+            << "\t*\t0\t0\t" << (is_reverse ? rc : seq) << '\t' << qual
+            << "\tAS:i:" << best->score << "\tNM:i:" << edits << '\n';
+        out += sam.str();
+    }
+};
+
+/**
+ * Writes chunk outputs strictly in chunk order.
+ *
+ * Workers hand in finished chunks in any order; whoever completes the next
+ * expected chunk writes it and any buffered successors. wait_for_room()
+ * keeps at most max_pending chunks between the reader and the output.
+ */
+class OrderedWriter {
+private:
+    ostream& out;
+    size_t max_pending;
+    size_t next = 0;
+    map<size_t, string> pending;
+    bool failed = false;
+    mutex lock;
+    condition_variable written;
+
+public:
+    OrderedWriter(ostream& out, size_t max_pending) : out(out), max_pending(max_pending) {}
+
+    void put(size_t chunk, string text) {
+        lock_guard<mutex> guard(lock);
+        if (failed) {
+            return;
+        }
+        pending.emplace(chunk, move(text));
+        while (!pending.empty() && pending.begin()->first == next) {
+            out << pending.begin()->second;
+            pending.erase(pending.begin());
+            next++;
+        }
+        written.notify_all();
+    }
+
+    /**
+     * Give up after a chunk failed: later chunks are dropped, as that one will
+     * never be put, and waiters are released.
+     */
+    void fail() {
+        lock_guard<mutex> guard(lock);
+        failed = true;
+        written.notify_all();
+    }
+
+    /**
+     * Block until chunk may be submitted without exceeding max_pending.
+     *
+     * @return false if a chunk failed, so nothing more should be submitted
+     */
+    bool wait_for_room(size_t chunk) {
+        unique_lock<mutex> guard(lock);
+        written.wait(guard, [&] { return failed || chunk < next + max_pending; });
+        return !failed;
+    }
+};
+
+int main(int argc, char** argv) {
+    size_t threads = thread::hardware_concurrency();
+    int k = 15;
+    int w = 10;
+    size_t chunk_size = 4096;
+    uint32_t max_occurrences = 500;
+    int max_edits = -1;
+    int min_smem_length = 0;
+    string json_path, prometheus_path;
+    vector<string> files;
+
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "-j" || arg == "-p") {
+            if (a + 1 < argc) {
+                (arg == "-j" ? json_path : prometheus_path) = argv[++a];
+                continue;
+            }
+            files.clear();
+            break;
+        }
+        if (arg.size() == 2 && arg[0] == '-' && a + 1 < argc) {
+            long value;
+            try {
+                value = stol(argv[++a]);
+            } catch (const logic_error&) {
+                files.clear();
+                break;
+            }
+            switch (arg[1]) {
+                case 't': threads = value; break;
+                case 'k': k = value; break;
+                case 'w': w = value; break;
+                case 'c': chunk_size = max(1L, value); break;
+                case 'm': max_occurrences = value; break;
+                case 'e': max_edits = value; break;
+                case 's': min_smem_length = value; break;
+                default: files.clear(); a = argc; break;
+            }
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 2) {
+        cerr << "Usage: mapper [-t threads] [-k kmer] [-w window] [-c chunk] [-m max_occ] "
+             << "[-e max_edits] [-s min_smem] [-j metrics.json] [-p metrics.prom] "
+             << "reference.fa reads.fq > out.sam" << endl;
+        return 1;
+    }
+
+    try {
+        Mapper mapper;
+        mapper.reference = read_reference(files[0]);
+        if (min_smem_length > 0) {
+            // The FM-index holds only A, C, G, T: like BWA, replace separators
+            // and ambiguous bases with pseudo-random ones to keep coordinates
+            string text = mapper.reference.sequence;
+            uint32_t state = 1;
+            for (char& c : text) {
+                if (dna_code(c) > 3) {
+                    state = state * 1103515245u + 12345u;
+                    c = "ACGT"[(state >> 16) & 3];
+                }
+            }
+            mapper.smem_index = make_unique<BidirectionalFMIndex>(text, 32, IndexBuildOptions{threads, 0});
+            mapper.options.min_smem_length = min_smem_length;
+        } else {
+            mapper.index = build_kmer_index(mapper.reference.sequence, SeedShape::minimizer(w, k),
+                                            max_occurrences, {threads, 0});
+        }
+        mapper.options.max_hits = max_occurrences;
+        mapper.options.max_chains = 5;
+        mapper.options.max_edits = max_edits;
+        mapper.options.extension.gapped = true;
+
+        cout << "@HD\tVN:1.6\tSO:unsorted\n";
+        for (const Contig& contig : mapper.reference.contigs) {
+            cout << "@SQ\tSN:" << contig.name << "\tLN:" << contig.length << '\n';
+        }
+        cout << "@PG\tID:mapper\tPN:mapper\n";
+
+        SequenceReader reads(files[1]);
+        WorkStealingPool pool(threads);
+        OrderedWriter writer(cout, 4 * pool.size());
+        size_t chunk_id = 0;
+        while (true) {
+            auto chunk = make_shared<FastqBatch>();
+            if (!reads.next_batch(chunk_size, *chunk)) {
+                break;
+            }
+            if (!writer.wait_for_room(chunk_id)) {
+                break;  // pool.wait() rethrows the failure
+            }
+            pool.submit([&mapper, &writer, chunk, chunk_id] {
+                string text;
+                try {
+                    for (const FastqRecord& read : chunk->records) {
+                        mapper.map_read(read, text);
+                    }
+                } catch (...) {
+                    writer.fail();
+                    throw;
+                }
+                writer.put(chunk_id, move(text));
+            });
+            chunk_id++;
+        }
+        pool.wait();
+
+        if (!METRICS_ENABLED && (!json_path.empty() || !prometheus_path.empty())) {
+            cerr << "mapper: built without -DALIGN_METRICS, all metrics are zero" << endl;
+        }
+        MetricsSnapshot metrics = metrics_snapshot();
+        for (const auto& [path, text] : {make_pair(json_path, metrics_json(metrics)),
+                                         make_pair(prometheus_path, metrics_prometheus(metrics))}) {
+            if (path.empty()) {
+                continue;
+            }
+            ofstream file(path);
+            if (!(file << text)) {
+                throw runtime_error("cannot write " + path);
+            }
+        }
+    } catch (const exception& e) {
+        cerr << "mapper: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+/**
+ * Needleman-Wunsch Global Alignment - Example
+ * 
+ * Demonstrates needleman_wunsch.h: full-matrix, wavefront, BLOSUM62-scored
+ * and banded global alignment of short pairs.
+ */
+
+#include <iostream>
+#include <string>
+
+#include "needleman_wunsch.h"
+
+using namespace std;
+
+int main() {
+    // Example usage
+    string seq1 = "GATTACA";
+    string seq2 = "GCATGCU";
+    
+    Alignment result = needleman_wunsch(seq1, seq2);
+    
+    cout << "Needleman-Wunsch Global Alignment" << endl;
+    cout << "Sequence 1: " << seq1 << endl;
+    cout << "Sequence 2: " << seq2 << endl;
+    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
+    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
+    cout << "Alignment Score: " << result.score << endl;
+    cout << "CIGAR: " << needleman_wunsch_cigar(seq1, seq2).cigar.str() << endl;
+    cout << "Wavefront CIGAR: " << needleman_wunsch_wavefront(seq1, seq2).cigar.str() << endl;
+    
+    // Protein pair under BLOSUM62 with a linear gap of -8
+    string protein1 = "HEAGAWGHEE";
+    string protein2 = "PAWHEAE";
+    AlignmentResult protein = needleman_wunsch_cigar(protein1, protein2,
+                                                     make_scoring(SubstitutionMatrix::blosum62(), LinearGap{-8}));
+    cout << "\nBLOSUM62: " << protein1 << " vs " << protein2 << endl;
+    cout << "Score: " << protein.score << ", CIGAR: " << protein.cigar.str() << endl;
+    
+    // Banded alignment: widen the band until the optimum stays inside it
+    for (int band_width = 0;; band_width++) {
+        BandedAlignment banded = needleman_wunsch_banded(seq1, seq2, band_width);
+        cout << "\nBand width " << band_width << ": score " << banded.score
+             << (banded.band_edge_hit ? " (touched band edge)" : "") << endl;
+        if (!banded.band_edge_hit) {
+            cout << "Aligned Sequence 1: " << banded.aligned_seq1 << endl;
+            cout << "Aligned Sequence 2: " << banded.aligned_seq2 << endl;
+            break;
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * Seed-and-Extend Algorithm using K-mer Hashing - Example
+ * 
+ * Demonstrates the k-mer index, seed sampling, chaining and extension from
+ * seed_and_extend.h on a short reference.
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <utility>
+
+#include "seed_and_extend.h"
+
+using namespace std;
+
+int main() {
+    // Example usage
+    string reference = "ACGTACGTACGTAAACCCGGGTTTACGTACGT";
+    string query = "ACGTAAACCCGGG";
+    
+    cout << "Seed-and-Extend Alignment" << endl;
+    cout << "Reference: " << reference << endl;
+    cout << "Query: " << query << endl;
+    cout << "\nK-mer length: 5" << endl;
+    
+    vector<AlignmentHit> alignments = seed_and_extend(reference, query, 5);
+    
+    cout << "\nFound " << alignments.size() << " alignment(s):" << endl;
+    
+    // Show top 5
+    for (size_t i = 0; i < min(size_t(5), alignments.size()); i++) {
+        const auto& aln = alignments[i];
+        cout << "\nAlignment " << (i + 1) << ":" << endl;
+        cout << "  Query position: " << aln.query_start << "-" << aln.query_end << endl;
+        cout << "  Reference position: " << aln.ref_start << "-" << aln.ref_end << endl;
+        cout << "  Score: " << aln.score << endl;
+        cout << "  Query sequence: " << aln.query_seq() << endl;
+        cout << "  Ref sequence:   " << aln.ref_seq() << endl;
+    }
+    
+    // Sampled indexes
+    cout << "\nSeed sampling:" << endl;
+    vector<pair<string, SeedShape>> shapes = {
+        {"every 5-mer", SeedShape::contiguous(5)},
+        {"(4,5)-minimizers", SeedShape::minimizer(4, 5)},
+        {"spaced 1101011", SeedShape::spaced("1101011")}
+    };
+    for (const auto& named : shapes) {
+        KmerIndex index = build_kmer_index(reference, named.second);
+        vector<Seed> seeds = find_seeds(query, index);
+        cout << "  " << named.first << ": " << index.positions.size()
+             << " indexed positions, " << seeds.size() << " seed(s)" << endl;
+    }
+    
+    // Gapped extension across an indel
+    string gapped_query = "ACGTAAACCGGGTTTACG";  // One C deleted
+    SeedExtendOptions gapped;
+    gapped.extension.gapped = true;
+    vector<AlignmentHit> ungapped_hits = seed_and_extend(reference, gapped_query, SeedShape::contiguous(5));
+    vector<AlignmentHit> gapped_hits = seed_and_extend(reference, gapped_query, SeedShape::contiguous(5), gapped);
+    cout << "\nQuery with a deletion: " << gapped_query << endl;
+    cout << "  Ungapped best: query " << ungapped_hits[0].query_start << "-" << ungapped_hits[0].query_end
+         << ", reference " << ungapped_hits[0].ref_start << "-" << ungapped_hits[0].ref_end << endl;
+    cout << "  Gapped best:   query " << gapped_hits[0].query_start << "-" << gapped_hits[0].query_end
+         << ", reference " << gapped_hits[0].ref_start << "-" << gapped_hits[0].ref_end
+         << ", score " << gapped_hits[0].score << ", CIGAR " << gapped_hits[0].cigar.str() << endl;
+    
+    // Repeat masking
+    KmerIndex capped = build_kmer_index(reference, SeedShape::contiguous(5), 2);
+    cout << "\nOccurrence cap 2: masked " << capped.masked_kmers << " repetitive 5-mer(s) ("
+         << capped.masked_positions << " positions), "
+         << find_seeds(query, capped).size() << " seed(s) left" << endl;
+    
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * Smith-Waterman Local Alignment - Example
+ * 
+ * Demonstrates smith_waterman.h: one local alignment with its CIGAR, and
+ * one query scored and aligned against a batch of targets.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "smith_waterman.h"
+
+using namespace std;
+
+int main() {
+    // Example usage
+    string seq1 = "GGTTGACTA";
+    string seq2 = "TGTTACGG";
+    
+    Alignment result = smith_waterman(seq1, seq2);
+    
+    cout << "Smith-Waterman Local Alignment" << endl;
+    cout << "Sequence 1: " << seq1 << endl;
+    cout << "Sequence 2: " << seq2 << endl;
+    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
+    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
+    cout << "Alignment Score: " << result.score << endl;
+    AlignmentResult compact = smith_waterman_cigar(seq1, seq2);
+    cout << "CIGAR: " << compact.cigar.str() << " (seq1 " << compact.start1 << "-" << compact.end1
+         << ", seq2 " << compact.start2 << "-" << compact.end2 << ")" << endl;
+    
+    // One query against many targets
+    vector<string> targets = {"TGTTACGG", "GGTTGACTA", "AAAAAAAA", "CTTGACT"};
+    cout << "\nBatch scores against " << targets.size() << " targets:" << endl;
+    vector<BatchScore> scores = smith_waterman_batch(seq1, targets);
+    for (size_t t = 0; t < targets.size(); t++) {
+        cout << "  " << targets[t] << ": " << scores[t].score << endl;
+    }
+    
+    cout << "\nTracebacks for targets scoring >= 8:" << endl;
+    for (const auto& [t, aln] : smith_waterman_batch_align(seq1, targets, 8)) {
+        cout << "  " << targets[t] << ": " << aln.aligned_seq1 << " / " << aln.aligned_seq2
+             << " (score " << aln.score << ")" << endl;
+    }
+    
+    return 0;
+}
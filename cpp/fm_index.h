@@ -0,0 +1,1732 @@
+/**
+ * Suffix Arrays, BWT and FM-Index
+ *
+ * Shared by the BWT/FM-index demo and the SMEM seeding of the
+ * seed-and-extend pipeline:
+ * - Suffix array construction: serial SA-IS, or prefix-partitioned
+ *   parallel sorting in memory-bounded passes
+ * - BWT and inverse BWT
+ * - FMIndex: 2-bit packed BWT interleaved with rank checkpoints, sampled
+ *   suffix array, batched search and locate, mmap-able index files
+ * - BidirectionalFMIndex: indexes of the text and its reverse, for
+ *   search-scheme approximate matching and maximal exact matches
+ */
+
+#ifndef FM_INDEX_H
+#define FM_INDEX_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "thread_pool.h"
+
+/**
+ * Text accessor for the top level of SA-IS.
+ *
+ * Maps each byte of the input to byte + 1 and the final '$' to 0, so the
+ * sentinel is always the unique smallest symbol regardless of what other
+ * characters appear in the text.
+ */
+struct SentinelText {
+    const std::string& text;
+    
+    uint32_t operator[](uint32_t i) const {
+        if (i == text.length() - 1) {
+            return 0;
+        }
+        return static_cast<unsigned char>(text[i]) + 1;
+    }
+};
+
+/**
+ * Bucket boundaries for every symbol: bucket starts, or bucket ends if end is true.
+ */
+template <typename Text>
+void sais_buckets(const Text& s, uint32_t n, uint32_t K, std::vector<uint32_t>& bkt, bool end) {
+    std::fill(bkt.begin(), bkt.end(), 0);
+    for (uint32_t i = 0; i < n; i++) {
+        bkt[s[i]]++;
+    }
+    uint32_t sum = 0;
+    for (uint32_t c = 0; c <= K; c++) {
+        sum += bkt[c];
+        bkt[c] = end ? sum : sum - bkt[c];
+    }
+}
+
+/**
+ * Induce the order of L-type and then S-type suffixes from the LMS suffixes in SA.
+ */
+template <typename Text>
+void sais_induce(const Text& s, uint32_t* SA, uint32_t n, uint32_t K,
+                 const std::vector<bool>& stype, std::vector<uint32_t>& bkt) {
+    const uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+    
+    sais_buckets(s, n, K, bkt, false);
+    for (uint32_t i = 0; i < n; i++) {
+        if (SA[i] != EMPTY && SA[i] > 0 && !stype[SA[i] - 1]) {
+            uint32_t j = SA[i] - 1;
+            SA[bkt[s[j]]++] = j;
+        }
+    }
+    
+    sais_buckets(s, n, K, bkt, true);
+    for (uint32_t i = n; i-- > 0;) {
+        if (SA[i] != EMPTY && SA[i] > 0 && stype[SA[i] - 1]) {
+            uint32_t j = SA[i] - 1;
+            SA[--bkt[s[j]]] = j;
+        }
+    }
+}
+
+/**
+ * SA-IS suffix sorting (Nong, Zhang & Chan, 2009).
+ *
+ * Sorts all suffixes of s[0..n) in O(n) time. The text must end with a unique
+ * symbol 0 that is smaller than every other symbol; symbols lie in [0, K].
+ * The reduced problem is stored in the tail of SA itself, so the only extra
+ * memory per level is the S/L type bit vector and the bucket array.
+ */
+template <typename Text>
+void sais(const Text& s, uint32_t* SA, uint32_t n, uint32_t K) {
+    const uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+    
+    if (n == 1) {
+        SA[0] = 0;
+        return;
+    }
+    
+    // Classify suffixes as S-type (true) or L-type (false)
+    std::vector<bool> stype(n, false);
+    stype[n - 1] = true;
+    for (uint32_t i = n - 1; i-- > 0;) {
+        stype[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && stype[i + 1]);
+    }
+    auto is_lms = [&stype](uint32_t i) {
+        return i > 0 && i != std::numeric_limits<uint32_t>::max() && stype[i] && !stype[i - 1];
+    };
+    
+    // Stage 1: bucket the LMS suffixes and induce a sort of the LMS substrings
+    std::vector<uint32_t> bkt(K + 1);
+    sais_buckets(s, n, K, bkt, true);
+    std::fill(SA, SA + n, EMPTY);
+    for (uint32_t i = 1; i < n; i++) {
+        if (is_lms(i)) {
+            SA[--bkt[s[i]]] = i;
+        }
+    }
+    sais_induce(s, SA, n, K, stype, bkt);
+    
+    // Compact the sorted LMS substrings into the head of SA
+    uint32_t n1 = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (is_lms(SA[i])) {
+            SA[n1++] = SA[i];
+        }
+    }
+    std::fill(SA + n1, SA + n, EMPTY);
+    
+    // Name the LMS substrings; equal substrings share a name
+    uint32_t name = 0;
+    uint32_t prev = EMPTY;
+    for (uint32_t i = 0; i < n1; i++) {
+        uint32_t pos = SA[i];
+        bool diff = false;
+        for (uint32_t d = 0; d < n; d++) {
+            if (prev == EMPTY || s[pos + d] != s[prev + d] || stype[pos + d] != stype[prev + d]) {
+                diff = true;
+                break;
+            }
+            if (d > 0 && (is_lms(pos + d) || is_lms(prev + d))) {
+                break;
+            }
+        }
+        if (diff) {
+            name++;
+            prev = pos;
+        }
+        SA[n1 + pos / 2] = name - 1;
+    }
+    for (uint32_t i = n, j = n; i-- > n1;) {
+        if (SA[i] != EMPTY) {
+            SA[--j] = SA[i];
+        }
+    }
+    
+    // Stage 2: sort the reduced string, recursing only if names are not unique
+    uint32_t* SA1 = SA;
+    uint32_t* s1 = SA + n - n1;
+    if (name < n1) {
+        sais(static_cast<const uint32_t*>(s1), SA1, n1, name - 1);
+    } else {
+        for (uint32_t i = 0; i < n1; i++) {
+            SA1[s1[i]] = i;
+        }
+    }
+    
+    // Stage 3: place the sorted LMS suffixes and induce the full suffix array
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        if (is_lms(i)) {
+            s1[j++] = i;
+        }
+    }
+    for (uint32_t i = 0; i < n1; i++) {
+        SA1[i] = s1[SA1[i]];
+    }
+    std::fill(SA + n1, SA + n, EMPTY);
+    sais_buckets(s, n, K, bkt, true);
+    for (uint32_t i = n1; i-- > 0;) {
+        uint32_t j = SA[i];
+        SA[i] = EMPTY;
+        SA[--bkt[s[j]]] = j;
+    }
+    sais_induce(s, SA, n, K, stype, bkt);
+}
+
+/**
+ * Build the suffix array of a text using SA-IS.
+ *
+ * The text must end with the '$' sentinel. Runs in O(n) time; working memory is
+ * the 4n-byte suffix array plus n bits of suffix types (and n/2 bits per
+ * recursion level), which keeps a 3 Gbp reference at roughly 5n bytes.
+ *
+ * @param text Text terminated by '$' (length must fit in 32 bits)
+ * @return Suffix array: SA[i] is the start of the i-th smallest suffix
+ */
+inline std::vector<uint32_t> build_suffix_array(const std::string& text) {
+    if (text.length() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("build_suffix_array: text longer than 2^32 - 1 characters");
+    }
+    
+    uint32_t n = text.length();
+    std::vector<uint32_t> sa(n);
+    if (n > 0) {
+        sais(SentinelText{text}, sa.data(), n, 256);
+    }
+    return sa;
+}
+
+/**
+ * Threads and memory used to build a suffix array, BWT or FMIndex.
+ *
+ * The defaults select the serial SA-IS build; any other setting selects the
+ * partitioned parallel build of sort_suffixes_parallel().
+ *
+ * Limit of the parallel build: partitions are sorted by comparing suffixes
+ * directly, each comparison costing their common prefix, so sorting takes
+ * about O(n log n * L) for exact repeats of length L where SA-IS is O(n).
+ * That is quadratic on a long run of one symbol or many copies of a long
+ * sequence. Genomes, whose repeats are short next to their length, sort
+ * fast; texts made of long runs or copies (e.g. the BWT of a sequence with
+ * N-masked regions) should use the serial build.
+ */
+struct IndexBuildOptions {
+    size_t threads = 1;     // Worker threads; 0 = all cores
+    size_t max_memory = 0;  // Target bytes of suffix-array buffer per pass; 0 = one pass
+    
+    bool parallel() const { return threads != 1 || max_memory != 0; }
+};
+
+/**
+ * Parallel suffix sorting by prefix partitioning.
+ *
+ * Suffixes are partitioned by their first q symbols, with q chosen so that
+ * there are at most 4096 partitions, which already orders them to depth q:
+ * - Threads count the partition of every suffix over slices of the text
+ * - Partitions are taken in passes whose suffix-array rows fit in max_memory;
+ *   each pass gathers its suffixes into per-(slice, partition) ranges
+ * - Each partition is then sorted on its own by comparing suffixes directly,
+ *   and sink(first_row, sa, count) receives the pass's rows in order
+ * so the full suffix array never has to exist at once.
+ *
+ * The text must end with a unique sentinel; other symbols sort by byte
+ * value. Comparisons cost the length of the common prefix, which is short in
+ * genomic text but makes long exact repeats slow (see IndexBuildOptions);
+ * serial SA-IS stays linear on any input, and also sorts texts of at most
+ * one symbol.
+ */
+template <typename Sink>
+void sort_suffixes_parallel(const std::string& text, const IndexBuildOptions& options,
+                            WorkStealingPool& pool, Sink sink) {
+    const uint32_t n = text.length();
+    const unsigned char* t = reinterpret_cast<const unsigned char*>(text.data());
+    
+    // A text of just the sentinel has no symbol to partition by (base would
+    // be 1 below); any other has the sentinel and at least one more rank
+    if (n <= 1) {
+        std::vector<uint32_t> sa = build_suffix_array(text);
+        sink(0, sa.data(), sa.size());
+        return;
+    }
+    
+    const size_t slices = std::min<size_t>(4 * pool.size(), n / 65536 + 1);
+    const size_t slice_len = (n + slices - 1) / slices;
+    
+    // Rank the symbols present from 1 by byte value; the sentinel ranks 0
+    std::vector<uint32_t> hist(slices * 256, 0);
+    pool.parallel_for(slices, [&](size_t s) {
+        size_t hi = std::min<size_t>(n - 1, (s + 1) * slice_len);
+        for (size_t i = s * slice_len; i < hi; i++) {
+            hist[s * 256 + t[i]]++;
+        }
+    });
+    uint32_t rank[256] = {};
+    uint32_t base = 1;
+    for (int c = 0; c < 256; c++) {
+        for (size_t s = 0; s < slices; s++) {
+            if (hist[s * 256 + c] > 0) {
+                rank[c] = base++;
+                break;
+            }
+        }
+    }
+    
+    // Partition key: the first q ranks in base `base`, padded with 0 past the end
+    uint32_t q = 1, parts = base;
+    while (parts * base <= 4096) {
+        parts *= base;
+        q++;
+    }
+    auto digit = [&](size_t i) { return i < n - 1 ? rank[t[i]] : 0; };
+    auto for_each_key = [&](size_t s, auto visit) {
+        size_t lo = s * slice_len;
+        size_t hi = std::min<size_t>(n, lo + slice_len);
+        if (lo >= hi) {
+            return;
+        }
+        uint32_t key = 0;
+        for (uint32_t d = 0; d < q; d++) {
+            key = key * base + digit(lo + d);
+        }
+        for (size_t i = lo; i < hi; i++) {
+            visit(i, key);
+            key = key % (parts / base) * base + digit(i + q);
+        }
+    };
+    
+    std::vector<uint32_t> counts(slices * parts, 0);
+    pool.parallel_for(slices, [&](size_t s) {
+        uint32_t* count = &counts[s * parts];
+        for_each_key(s, [&](size_t, uint32_t key) { count[key]++; });
+    });
+    std::vector<size_t> part_size(parts, 0);
+    for (size_t s = 0; s < slices; s++) {
+        for (size_t p = 0; p < parts; p++) {
+            part_size[p] += counts[s * parts + p];
+        }
+    }
+    
+    // Suffixes sharing a partition share their first q symbols, and none of
+    // them reaches the sentinel within those q symbols unless it is alone
+    auto less = [t, n, q](uint32_t a, uint32_t b) {
+        uint32_t la = n - 1 - a, lb = n - 1 - b;
+        int c = std::memcmp(t + a + q, t + b + q, std::min(la, lb) - q);
+        return c != 0 ? c < 0 : la < lb;
+    };
+    
+    std::vector<uint32_t> sa;
+    uint32_t row = 0;
+    for (size_t first = 0; first < parts;) {
+        size_t last = first + 1;
+        size_t rows = part_size[first];
+        while (last < parts &&
+               (options.max_memory == 0 || (rows + part_size[last]) * sizeof(uint32_t) <= options.max_memory)) {
+            rows += part_size[last++];
+        }
+        const size_t np = last - first;
+        
+        std::vector<size_t> part_start(np + 1, 0);
+        std::vector<size_t> cursor(slices * np);
+        for (size_t p = 0; p < np; p++) {
+            size_t at = part_start[p];
+            for (size_t s = 0; s < slices; s++) {
+                cursor[s * np + p] = at;
+                at += counts[s * parts + first + p];
+            }
+            part_start[p + 1] = at;
+        }
+        
+        sa.resize(rows);
+        pool.parallel_for(slices, [&](size_t s) {
+            size_t* slot = &cursor[s * np];
+            for_each_key(s, [&](size_t i, uint32_t key) {
+                if (key >= first && key < last) {
+                    sa[slot[key - first]++] = i;
+                }
+            });
+        });
+        pool.parallel_for(np, [&](size_t p) {
+            if (part_start[p + 1] - part_start[p] > 1) {
+                std::sort(sa.begin() + part_start[p], sa.begin() + part_start[p + 1], less);
+            }
+        });
+        
+        sink(row, sa.data(), rows);
+        row += rows;
+        first = last;
+    }
+}
+
+/**
+ * Build the suffix array of a '$'-terminated text with the given threads and
+ * memory target (see sort_suffixes_parallel()).
+ */
+inline std::vector<uint32_t> build_suffix_array(const std::string& text, const IndexBuildOptions& options) {
+    if (!options.parallel()) {
+        return build_suffix_array(text);
+    }
+    if (text.length() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("build_suffix_array: text longer than 2^32 - 1 characters");
+    }
+    
+    std::vector<uint32_t> sa(text.length());
+    if (!text.empty()) {
+        WorkStealingPool pool(options.threads ? options.threads : std::thread::hardware_concurrency());
+        sort_suffixes_parallel(text, options, pool, [&](uint32_t first, const uint32_t* rows, size_t count) {
+            std::copy(rows, rows + count, sa.begin() + first);
+        });
+    }
+    return sa;
+}
+
+/**
+ * Derive the BWT from a text and its suffix array: BWT[i] = text[SA[i] - 1].
+ */
+inline std::string bwt_from_suffix_array(const std::string& text, const std::vector<uint32_t>& sa) {
+    std::string bwt(sa.size(), '\0');
+    for (size_t i = 0; i < sa.size(); i++) {
+        bwt[i] = sa[i] == 0 ? text.back() : text[sa[i] - 1];
+    }
+    return bwt;
+}
+
+/**
+ * Compute the Burrows-Wheeler Transform of a text.
+ *
+ * With parallel options the BWT is filled in pass by pass as the suffixes
+ * are sorted, so no full suffix array is held.
+ */
+inline std::string burrows_wheeler_transform(std::string text, const IndexBuildOptions& options = {}) {
+    // Add sentinel character if not present
+    if (text.empty() || text.back() != '$') {
+        text += '$';
+    }
+    
+    // Sorted rotations of a '$'-terminated text are its sorted suffixes
+    if (!options.parallel()) {
+        return bwt_from_suffix_array(text, build_suffix_array(text));
+    }
+    if (text.length() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("burrows_wheeler_transform: text longer than 2^32 - 1 characters");
+    }
+    
+    std::string bwt(text.length(), '\0');
+    WorkStealingPool pool(options.threads ? options.threads : std::thread::hardware_concurrency());
+    sort_suffixes_parallel(text, options, pool, [&](uint32_t first, const uint32_t* sa, size_t count) {
+        const size_t CHUNK = 1 << 16;
+        pool.parallel_for((count + CHUNK - 1) / CHUNK, [&](size_t c) {
+            for (size_t i = c * CHUNK; i < std::min(count, (c + 1) * CHUNK); i++) {
+                bwt[first + i] = sa[i] == 0 ? text.back() : text[sa[i] - 1];
+            }
+        });
+    });
+    return bwt;
+}
+
+/**
+ * Reverse the Burrows-Wheeler Transform.
+ */
+inline std::string inverse_bwt(const std::string& bwt) {
+    int n = bwt.length();
+    
+    // Create table with indices
+    std::vector<std::pair<char, int>> table;
+    for (int i = 0; i < n; i++) {
+        table.push_back({bwt[i], i});
+    }
+    
+    // Sort to get first column
+    std::sort(table.begin(), table.end());
+    
+    // Follow the links to reconstruct
+    std::string result;
+    int idx = 0;  // Start with the row containing '$'
+    
+    for (int i = 0; i < n; i++) {
+        result += table[idx].first;
+        idx = table[idx].second;
+    }
+    
+    // Rotate to put '$' at the end
+    return result.substr(1) + result[0];
+}
+
+/**
+ * Dense 2-bit code of a nucleotide (A=0, C=1, G=2, T=3), or 4 for any other character.
+ */
+inline uint8_t dna_code(char c) {
+    switch (c) {
+        case 'A': case 'a': return 0;
+        case 'C': case 'c': return 1;
+        case 'G': case 'g': return 2;
+        case 'T': case 't': return 3;
+        default: return 4;
+    }
+}
+
+/**
+ * One cache line of the occurrence table.
+ *
+ * Holds the occurrence count of each nucleotide before the block, followed by
+ * the next 192 BWT symbols packed 2 bits each. A rank query therefore touches a
+ * single 64-byte block: one checkpoint load plus up to six popcounts.
+ */
+struct alignas(64) OccBlock {
+    static const uint32_t SYMBOLS = 192;
+    
+    uint32_t counts[4];
+    uint64_t bits[6];
+};
+
+/**
+ * Header of a serialized FMIndex file (format version 1).
+ *
+ * The header is followed by four sections, each starting on a 64-byte boundary
+ * so that a page-aligned mmap of the file can be used in place: the OccBlock
+ * array, the SA samples, the sampled-row bit vector and its per-word ranks.
+ * All fields are little-endian as written by the host.
+ */
+struct FMIndexFileHeader {
+    static constexpr char MAGIC[8] = {'F', 'M', 'I', 'D', 'X', 'D', 'N', 'A'};
+    static const uint32_t VERSION = 1;
+    
+    char magic[8];
+    uint32_t version;
+    uint32_t n;
+    uint32_t dollar_row;
+    uint32_t sa_sample_rate;
+    uint32_t C[5];
+    uint32_t reserved;
+    uint64_t occ_offset, occ_blocks;
+    uint64_t samples_offset, samples_count;
+    uint64_t bits_offset, bits_words;
+    uint64_t rank_offset, rank_words;
+};
+
+/**
+ * FM-Index for efficient pattern matching using BWT.
+ *
+ * The BWT is stored 2-bit packed over the DNA alphabet, interleaved with rank
+ * checkpoints (about n/3 bytes in total). The sentinel has no 2-bit code: its
+ * row is stored as an 'A' and excluded from rank queries via dollar_row.
+ */
+class FMIndex {
+private:
+    uint32_t n = 0;           // BWT length, including '$'
+    uint32_t dollar_row = 0;  // BWT row holding '$'
+    uint32_t C[5] = {};       // C[c]: number of symbols smaller than code c ('$' included)
+    
+    // Sampled suffix array: SA values at text positions divisible by sa_sample_rate,
+    // stored in BWT-row order. sampled_bits marks the sampled rows and
+    // sampled_rank holds the number of marked rows before each 64-row word.
+    uint32_t sa_sample_rate = 32;
+    
+    // Index tables. They point either into the owned *_storage vectors (built
+    // in-process) or straight into a read-only file mapping (load()).
+    const OccBlock* occ = nullptr;  // Packed BWT with interleaved occurrence checkpoints
+    const uint32_t* sa_samples = nullptr;
+    const uint64_t* sampled_bits = nullptr;
+    const uint32_t* sampled_rank = nullptr;
+    size_t occ_blocks = 0, samples_count = 0, bits_words = 0;
+    
+    std::vector<OccBlock> occ_storage;
+    std::vector<uint32_t> sa_samples_storage;
+    std::vector<uint64_t> sampled_bits_storage;
+    std::vector<uint32_t> sampled_rank_storage;
+    std::shared_ptr<void> mapping;  // Keeps the file mapping alive; unmaps on release
+    
+    FMIndex() = default;
+    
+    friend class BidirectionalFMIndex;
+    
+    void build_sa_samples(const std::vector<uint32_t>& sa) {
+        size_t words = (n + 63) / 64;
+        sampled_bits_storage.assign(words, 0);
+        sampled_rank_storage.assign(words, 0);
+        sa_samples_storage.clear();
+        sa_samples_storage.reserve(n / sa_sample_rate + 1);
+        
+        for (size_t i = 0; i < n; i++) {
+            if (sa[i] % sa_sample_rate == 0) {
+                sampled_bits_storage[i / 64] |= uint64_t(1) << (i % 64);
+                sa_samples_storage.push_back(sa[i]);
+            }
+        }
+        
+        uint32_t total = 0;
+        for (size_t w = 0; w < words; w++) {
+            sampled_rank_storage[w] = total;
+            total += __builtin_popcountll(sampled_bits_storage[w]);
+        }
+    }
+    
+    void bind_storage() {
+        occ = occ_storage.data();
+        occ_blocks = occ_storage.size();
+        sa_samples = sa_samples_storage.data();
+        samples_count = sa_samples_storage.size();
+        sampled_bits = sampled_bits_storage.data();
+        sampled_rank = sampled_rank_storage.data();
+        bits_words = sampled_bits_storage.size();
+    }
+    
+    /**
+     * 2-bit code of the BWT symbol at a row ('$' reads as 0).
+     */
+    uint8_t symbol(uint32_t row) const {
+        const OccBlock& block = occ[row / OccBlock::SYMBOLS];
+        uint32_t r = row % OccBlock::SYMBOLS;
+        return (block.bits[r / 32] >> (2 * (r % 32))) & 3;
+    }
+    
+    /**
+     * Number of occurrences of code c in BWT[0, row).
+     */
+    uint32_t rank(uint8_t c, uint32_t row) const {
+        const OccBlock& block = occ[row / OccBlock::SYMBOLS];
+        uint32_t r = row % OccBlock::SYMBOLS;
+        uint32_t count = block.counts[c];
+        
+        // A 2-bit lane matches c when (lane ^ c) == 0
+        const uint64_t pattern = uint64_t(c) * 0x5555555555555555ULL;
+        for (uint32_t w = 0; w * 32 < r; w++) {
+            uint64_t x = block.bits[w] ^ pattern;
+            uint64_t match = ~(x | (x >> 1)) & 0x5555555555555555ULL;
+            uint32_t lanes = std::min(r - w * 32, 32u);
+            if (lanes < 32) {
+                match &= (uint64_t(1) << (2 * lanes)) - 1;
+            }
+            count += __builtin_popcountll(match);
+        }
+        
+        // The sentinel is stored as an 'A' but left out of the checkpoints
+        if (c == 0 && dollar_row < row && dollar_row >= row - r) {
+            count--;
+        }
+        return count;
+    }
+    
+    /**
+     * Occurrences of every code in BWT[0, row), from one block.
+     */
+    void rank_all(uint32_t row, uint32_t counts[4]) const {
+        const OccBlock& block = occ[row / OccBlock::SYMBOLS];
+        uint32_t r = row % OccBlock::SYMBOLS;
+        
+        // Split each 2-bit lane into its low and high bit: codes 1, 2 and 3
+        // are one popcount each, and code 0 is whatever is left
+        const uint64_t LOW = 0x5555555555555555ULL;
+        uint32_t c1 = 0, c2 = 0, c3 = 0;
+        for (uint32_t w = 0; w * 32 < r; w++) {
+            uint64_t x = block.bits[w];
+            uint32_t lanes = std::min(r - w * 32, 32u);
+            if (lanes < 32) {
+                x &= (uint64_t(1) << (2 * lanes)) - 1;
+            }
+            uint64_t lo = x & LOW, hi = (x >> 1) & LOW;
+            c1 += __builtin_popcountll(lo & ~hi);
+            c2 += __builtin_popcountll(hi & ~lo);
+            c3 += __builtin_popcountll(lo & hi);
+        }
+        
+        // The sentinel is stored as an 'A' but left out of the checkpoints
+        bool dollar = dollar_row < row && dollar_row >= row - r;
+        counts[0] = block.counts[0] + (r - c1 - c2 - c3) - dollar;
+        counts[1] = block.counts[1] + c1;
+        counts[2] = block.counts[2] + c2;
+        counts[3] = block.counts[3] + c3;
+    }
+    
+    /**
+     * LF mapping: the BWT row of the suffix that starts one position earlier.
+     */
+    uint32_t lf(uint32_t row) const {
+        uint8_t c = symbol(row);
+        return C[c] + rank(c, row);
+    }
+    
+    /**
+     * Resolve the text position of a BWT row by LF-walking to the nearest sample.
+     *
+     * Text position 0 is always sampled, so at most sa_sample_rate - 1 steps are needed.
+     */
+    uint32_t resolve_position(uint32_t row) const {
+        uint32_t steps = 0;
+        while (!(sampled_bits[row / 64] >> (row % 64) & 1)) {
+            row = lf(row);
+            steps++;
+        }
+        metrics_count(Metric::LFSteps, steps);
+        uint64_t below = sampled_bits[row / 64] & ((uint64_t(1) << (row % 64)) - 1);
+        uint32_t sample = sampled_rank[row / 64] + __builtin_popcountll(below);
+        return sa_samples[sample] + steps;
+    }
+    
+    void build_index(const std::string& text, const std::vector<uint32_t>& sa) {
+        occ_storage.assign(n / OccBlock::SYMBOLS + 1, OccBlock{});
+        
+        uint32_t counts[4] = {0, 0, 0, 0};
+        for (uint32_t i = 0; i < n; i++) {
+            OccBlock& block = occ_storage[i / OccBlock::SYMBOLS];
+            uint32_t r = i % OccBlock::SYMBOLS;
+            if (r == 0) {
+                std::copy(counts, counts + 4, block.counts);
+            }
+            
+            uint8_t c;
+            if (sa[i] == 0) {
+                dollar_row = i;
+                c = 0;
+            } else {
+                c = dna_code(text[sa[i] - 1]);
+                counts[c]++;
+            }
+            block.bits[r / 32] |= uint64_t(c) << (2 * (r % 32));
+        }
+        
+        // The rank of row n lives in the block after the last symbol
+        if (n % OccBlock::SYMBOLS == 0) {
+            std::copy(counts, counts + 4, occ_storage.back().counts);
+        }
+        
+        // Compute C array; '$' sorts before every nucleotide
+        C[0] = 1;
+        for (int c = 0; c < 4; c++) {
+            C[c + 1] = C[c] + counts[c];
+        }
+    }
+    
+    /**
+     * Occurrences of each code among the first rows symbols of a block,
+     * counting the sentinel as an 'A'.
+     */
+    static void block_symbol_counts(const OccBlock& block, uint32_t rows, uint32_t counts[4]) {
+        for (uint8_t c = 0; c < 4; c++) {
+            const uint64_t pattern = uint64_t(c) * 0x5555555555555555ULL;
+            for (uint32_t w = 0; w * 32 < rows; w++) {
+                uint64_t x = block.bits[w] ^ pattern;
+                uint64_t match = ~(x | (x >> 1)) & 0x5555555555555555ULL;
+                uint32_t lanes = std::min(rows - w * 32, 32u);
+                if (lanes < 32) {
+                    match &= (uint64_t(1) << (2 * lanes)) - 1;
+                }
+                counts[c] += __builtin_popcountll(match);
+            }
+        }
+    }
+    
+    /**
+     * Build the occurrence table and SA samples straight from the passes of
+     * sort_suffixes_parallel(), without materializing the suffix array.
+     */
+    void build_index_parallel(const std::string& text, const IndexBuildOptions& options) {
+        WorkStealingPool pool(options.threads ? options.threads : std::thread::hardware_concurrency());
+        const size_t words = (n + 63) / 64;
+        occ_storage.assign(n / OccBlock::SYMBOLS + 1, OccBlock{});
+        sampled_bits_storage.assign(words, 0);
+        sampled_rank_storage.assign(words, 0);
+        sa_samples_storage.clear();
+        sa_samples_storage.reserve(n / sa_sample_rate + 1);
+        
+        // Tasks cover whole blocks (and so whole 64-row words of sampled_bits);
+        // each collects its SA samples, which are appended in row order
+        const size_t BLOCKS_PER_TASK = 1024;
+        const size_t CHUNK = OccBlock::SYMBOLS * BLOCKS_PER_TASK;
+        sort_suffixes_parallel(text, options, pool, [&](uint32_t first, const uint32_t* sa, size_t count) {
+            size_t c0 = first / CHUNK;
+            size_t c1 = (first + count + CHUNK - 1) / CHUNK;
+            std::vector<std::vector<uint32_t>> samples(c1 - c0);
+            pool.parallel_for(c1 - c0, [&](size_t c) {
+                size_t lo = std::max<size_t>(first, (c0 + c) * CHUNK);
+                size_t hi = std::min<size_t>(first + count, (c0 + c + 1) * CHUNK);
+                for (size_t i = lo; i < hi; i++) {
+                    uint32_t pos = sa[i - first];
+                    uint8_t code = 0;
+                    if (pos == 0) {
+                        dollar_row = i;
+                    } else {
+                        code = dna_code(text[pos - 1]);
+                    }
+                    uint32_t r = i % OccBlock::SYMBOLS;
+                    occ_storage[i / OccBlock::SYMBOLS].bits[r / 32] |= uint64_t(code) << (2 * (r % 32));
+                    if (pos % sa_sample_rate == 0) {
+                        sampled_bits_storage[i / 64] |= uint64_t(1) << (i % 64);
+                        samples[c].push_back(pos);
+                    }
+                }
+            });
+            for (const std::vector<uint32_t>& chunk : samples) {
+                sa_samples_storage.insert(sa_samples_storage.end(), chunk.begin(), chunk.end());
+            }
+        });
+        
+        // Checkpoints: symbol counts per task in parallel, an exclusive prefix
+        // sum over tasks, then every task writes the running counts of its blocks
+        const size_t blocks = occ_storage.size();
+        const size_t tasks = (blocks + BLOCKS_PER_TASK - 1) / BLOCKS_PER_TASK;
+        auto rows_in = [this](size_t b) {
+            size_t start = b * OccBlock::SYMBOLS;
+            return static_cast<uint32_t>(start < n ? std::min<size_t>(OccBlock::SYMBOLS, n - start) : 0);
+        };
+        auto symbols = [&](size_t b, uint32_t counts[4]) {
+            block_symbol_counts(occ_storage[b], rows_in(b), counts);
+            if (dollar_row / OccBlock::SYMBOLS == b) {
+                counts[0]--;
+            }
+        };
+        std::vector<std::array<uint32_t, 4>> task_counts(tasks + 1, std::array<uint32_t, 4>{});
+        pool.parallel_for(tasks, [&](size_t task) {
+            size_t end = std::min(blocks, (task + 1) * BLOCKS_PER_TASK);
+            for (size_t b = task * BLOCKS_PER_TASK; b < end; b++) {
+                symbols(b, task_counts[task + 1].data());
+            }
+        });
+        for (size_t task = 0; task < tasks; task++) {
+            for (int c = 0; c < 4; c++) {
+                task_counts[task + 1][c] += task_counts[task][c];
+            }
+        }
+        pool.parallel_for(tasks, [&](size_t task) {
+            std::array<uint32_t, 4> running = task_counts[task];
+            size_t end = std::min(blocks, (task + 1) * BLOCKS_PER_TASK);
+            for (size_t b = task * BLOCKS_PER_TASK; b < end; b++) {
+                std::copy(running.begin(), running.end(), occ_storage[b].counts);
+                symbols(b, running.data());
+            }
+        });
+        
+        uint32_t total = 0;
+        for (size_t w = 0; w < words; w++) {
+            sampled_rank_storage[w] = total;
+            total += __builtin_popcountll(sampled_bits_storage[w]);
+        }
+        
+        C[0] = 1;
+        for (int c = 0; c < 4; c++) {
+            C[c + 1] = C[c] + task_counts[tasks][c];
+        }
+    }
+    
+    /**
+     * Half-open BWT row range [top, bottom) of suffixes prefixed by pattern.
+     *
+     * The range is kept within [0, n], so that checkpoints of a corrupt file
+     * that load() did not detect give wrong counts rather than reads past occ.
+     */
+    std::pair<uint32_t, uint32_t> backward_search(const std::string& pattern) const {
+        uint32_t top = 0;
+        uint32_t bottom = n;
+        
+        // Process pattern from right to left
+        for (size_t i = pattern.length(); i-- > 0;) {
+            uint8_t c = dna_code(pattern[i]);
+            
+            if (c > 3) {
+                return {0, 0};  // Pattern not found
+            }
+            
+            // Update range using LF mapping
+            top = std::min(C[c] + rank(c, top), n);
+            bottom = std::min(C[c] + rank(c, bottom), n);
+            metrics_count(Metric::BackwardSearchSteps);
+            
+            if (top >= bottom) {
+                return {0, 0};  // Pattern not found
+            }
+        }
+        
+        return {top, bottom};
+    }
+    
+    // Number of queries kept in flight by the batch APIs; enough independent
+    // rank lookups to cover DRAM latency without thrashing the L1
+    static const size_t BATCH_LANES = 32;
+    
+    void prefetch_rank(uint32_t row) const {
+        __builtin_prefetch(&occ[row / OccBlock::SYMBOLS]);
+    }
+    
+    /**
+     * Backward search for many patterns, advanced in lock-step.
+     *
+     * Up to BATCH_LANES searches are in flight. Each round performs one LF step
+     * per search and prefetches the rank blocks its next step will read, so by
+     * the time a search comes round again its block is (usually) in cache and
+     * the memory latency of all in-flight searches overlaps.
+     */
+    std::vector<std::pair<uint32_t, uint32_t>> backward_search_batch(const std::vector<std::string>& patterns) const {
+        struct Lane {
+            size_t pattern;
+            size_t remaining;
+            uint32_t top, bottom;
+        };
+        
+        std::vector<std::pair<uint32_t, uint32_t>> ranges(patterns.size(), {0, n});
+        Lane lanes[BATCH_LANES];
+        size_t active = 0;
+        size_t next = 0;
+        
+        // Start the next non-empty pattern in a lane (empty patterns match everywhere)
+        auto refill = [&](Lane& lane) {
+            while (next < patterns.size()) {
+                size_t p = next++;
+                if (!patterns[p].empty()) {
+                    lane = {p, patterns[p].length(), 0, n};
+                    prefetch_rank(lane.top);
+                    prefetch_rank(lane.bottom);
+                    return true;
+                }
+            }
+            return false;
+        };
+        
+        while (active < BATCH_LANES && refill(lanes[active])) {
+            active++;
+        }
+        
+        uint64_t steps = 0;
+        while (active > 0) {
+            for (size_t k = 0; k < active;) {
+                Lane& lane = lanes[k];
+                uint8_t c = dna_code(patterns[lane.pattern][lane.remaining - 1]);
+                
+                if (c > 3) {
+                    lane.top = lane.bottom = 0;  // Pattern not found
+                } else {
+                    lane.top = C[c] + rank(c, lane.top);
+                    lane.bottom = C[c] + rank(c, lane.bottom);
+                    lane.remaining--;
+                    steps++;
+                    if (lane.top >= lane.bottom) {
+                        lane.top = lane.bottom = 0;  // Pattern not found
+                    }
+                }
+                
+                if (lane.top < lane.bottom && lane.remaining > 0) {
+                    prefetch_rank(lane.top);
+                    prefetch_rank(lane.bottom);
+                    k++;
+                    continue;
+                }
+                
+                ranges[lane.pattern] = {lane.top, lane.bottom};
+                if (refill(lane)) {
+                    k++;
+                } else {
+                    lane = lanes[--active];  // Retire the lane; revisit k this round
+                }
+            }
+        }
+        metrics_count(Metric::BackwardSearchSteps, steps);
+        
+        return ranges;
+    }
+    
+    /**
+     * Resolve many BWT rows to text positions with interleaved LF walks.
+     *
+     * rows[i] is replaced by its text position. Like backward_search_batch, up to
+     * BATCH_LANES walks are in flight and each step prefetches the next block.
+     */
+    void resolve_positions_batch(std::vector<uint32_t>& rows) const {
+        struct Lane {
+            size_t hit;
+            uint32_t row;
+            uint32_t steps;
+        };
+        
+        Lane lanes[BATCH_LANES];
+        size_t active = 0;
+        size_t next = 0;
+        
+        auto refill = [&](Lane& lane) {
+            if (next == rows.size()) {
+                return false;
+            }
+            lane = {next, rows[next], 0};
+            next++;
+            prefetch_rank(lane.row);
+            return true;
+        };
+        
+        while (active < BATCH_LANES && refill(lanes[active])) {
+            active++;
+        }
+        
+        uint64_t steps = 0;
+        while (active > 0) {
+            for (size_t k = 0; k < active;) {
+                Lane& lane = lanes[k];
+                uint32_t row = lane.row;
+                uint64_t word = sampled_bits[row / 64];
+                
+                if (!(word >> (row % 64) & 1)) {
+                    lane.row = lf(row);
+                    lane.steps++;
+                    prefetch_rank(lane.row);
+                    __builtin_prefetch(&sampled_bits[lane.row / 64]);
+                    k++;
+                    continue;
+                }
+                
+                uint64_t below = word & ((uint64_t(1) << (row % 64)) - 1);
+                uint32_t sample = sampled_rank[row / 64] + __builtin_popcountll(below);
+                rows[lane.hit] = sa_samples[sample] + lane.steps;
+                steps += lane.steps;
+                
+                if (refill(lane)) {
+                    k++;
+                } else {
+                    lane = lanes[--active];
+                }
+            }
+        }
+        metrics_count(Metric::LFSteps, steps);
+    }
+
+public:
+    /**
+     * Build the index.
+     *
+     * @param input_text DNA text to index ('$' is appended if missing)
+     * @param sample_rate Keep the suffix array entry of every sample_rate-th text position
+     *                    (default: 32); bounds the LF steps per located hit
+     * @param options Threads and suffix-array memory per pass; the default is the serial
+     *                SA-IS build, anything else the partitioned parallel build
+     * @throws invalid_argument if the text contains characters other than A, C, G, T
+     */
+    FMIndex(std::string input_text, uint32_t sample_rate = 32, const IndexBuildOptions& options = {})
+        : sa_sample_rate(std::max(sample_rate, 1u)) {
+        // Add sentinel if not present
+        if (input_text.empty() || input_text.back() != '$') {
+            input_text += '$';
+        }
+        for (size_t i = 0; i + 1 < input_text.length(); i++) {
+            if (dna_code(input_text[i]) > 3) {
+                throw std::invalid_argument("FMIndex: text must contain only A, C, G, T");
+            }
+        }
+        
+        if (input_text.length() >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("FMIndex: text longer than 2^32 - 1 characters");
+        }
+        
+        n = input_text.length();
+        if (options.parallel()) {
+            build_index_parallel(input_text, options);
+        } else {
+            std::vector<uint32_t> sa = build_suffix_array(input_text);
+            build_index(input_text, sa);
+            build_sa_samples(sa);
+        }
+        bind_storage();
+    }
+    
+    // Tables may point into the index's own storage, so copies are not allowed
+    FMIndex(const FMIndex&) = delete;
+    FMIndex& operator=(const FMIndex&) = delete;
+    FMIndex(FMIndex&&) = default;
+    FMIndex& operator=(FMIndex&&) = default;
+    
+    /**
+     * Write the index to a file in the versioned FMIndexFileHeader format.
+     *
+     * @throws runtime_error if the file cannot be written
+     */
+    void save(const std::string& path) const {
+        auto align = [](uint64_t offset) { return (offset + 63) / 64 * 64; };
+        
+        FMIndexFileHeader header = {};
+        std::memcpy(header.magic, FMIndexFileHeader::MAGIC, sizeof(header.magic));
+        header.version = FMIndexFileHeader::VERSION;
+        header.n = n;
+        header.dollar_row = dollar_row;
+        header.sa_sample_rate = sa_sample_rate;
+        std::copy(C, C + 5, header.C);
+        header.occ_blocks = occ_blocks;
+        header.samples_count = samples_count;
+        header.bits_words = bits_words;
+        header.rank_words = bits_words;
+        header.occ_offset = align(sizeof(header));
+        header.samples_offset = align(header.occ_offset + occ_blocks * sizeof(OccBlock));
+        header.bits_offset = align(header.samples_offset + samples_count * sizeof(uint32_t));
+        header.rank_offset = align(header.bits_offset + bits_words * sizeof(uint64_t));
+        
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        auto write_at = [&out](uint64_t offset, const void* data, size_t bytes) {
+            static const char zeros[64] = {};
+            while (static_cast<uint64_t>(out.tellp()) < offset) {
+                out.write(zeros, std::min<uint64_t>(64, offset - out.tellp()));
+            }
+            out.write(static_cast<const char*>(data), bytes);
+        };
+        write_at(0, &header, sizeof(header));
+        write_at(header.occ_offset, occ, occ_blocks * sizeof(OccBlock));
+        write_at(header.samples_offset, sa_samples, samples_count * sizeof(uint32_t));
+        write_at(header.bits_offset, sampled_bits, bits_words * sizeof(uint64_t));
+        write_at(header.rank_offset, sampled_rank, bits_words * sizeof(uint32_t));
+        
+        if (!out) {
+            throw std::runtime_error("FMIndex::save: cannot write " + path);
+        }
+    }
+    
+    /**
+     * Map an index file written by save() read-only into memory.
+     *
+     * Nothing is copied or deserialized: the tables are used in place from a
+     * shared mapping, so processes loading the same file share one page-cache
+     * copy and pages are faulted in on first use. Only the header and the last
+     * entry of each table are checked, in O(1); call verify() on a file that
+     * is not trusted.
+     *
+     * @throws runtime_error if the file is missing, truncated, corrupt or of another format/version
+     */
+    static FMIndex load(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("FMIndex::load: cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FMIndexFileHeader)) {
+            close(fd);
+            throw std::runtime_error("FMIndex::load: " + path + " is not an FM-index file");
+        }
+        size_t size = st.st_size;
+        void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("FMIndex::load: cannot map " + path);
+        }
+        
+        FMIndex index;
+        index.mapping = std::shared_ptr<void>(base, [size](void* p) { munmap(p, size); });
+        
+        const char* bytes = static_cast<const char*>(base);
+        FMIndexFileHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::memcmp(header.magic, FMIndexFileHeader::MAGIC, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("FMIndex::load: " + path + " is not an FM-index file");
+        }
+        if (header.version != FMIndexFileHeader::VERSION) {
+            throw std::runtime_error("FMIndex::load: unsupported format version " + std::to_string(header.version));
+        }
+        auto fits = [size](uint64_t offset, uint64_t bytes) {
+            return offset % 64 == 0 && offset <= size && bytes <= size - offset;
+        };
+        if (!fits(header.occ_offset, header.occ_blocks * sizeof(OccBlock)) ||
+            !fits(header.samples_offset, header.samples_count * sizeof(uint32_t)) ||
+            !fits(header.bits_offset, header.bits_words * sizeof(uint64_t)) ||
+            !fits(header.rank_offset, header.rank_words * sizeof(uint32_t)) ||
+            header.occ_blocks != header.n / OccBlock::SYMBOLS + 1 ||
+            header.bits_words != (header.n + 63) / 64 || header.rank_words != header.bits_words) {
+            throw std::runtime_error("FMIndex::load: " + path + " is truncated or corrupt");
+        }
+        
+        // locate() indexes sa_samples through sampled_rank and LF-walks from
+        // C[], so these must be consistent with the sampled rows as well
+        const uint64_t* bits = reinterpret_cast<const uint64_t*>(bytes + header.bits_offset);
+        const uint32_t* ranks = reinterpret_cast<const uint32_t*>(bytes + header.rank_offset);
+        const uint64_t last = header.bits_words - 1;
+        bool consistent = header.dollar_row < header.n && header.sa_sample_rate > 0 && header.C[0] == 1 &&
+                          header.C[4] == header.n && (bits[header.dollar_row / 64] >> (header.dollar_row % 64) & 1) &&
+                          ranks[last] + __builtin_popcountll(bits[last]) == header.samples_count;
+        for (int c = 0; c < 4; c++) {
+            consistent = consistent && header.C[c] <= header.C[c + 1];
+        }
+        if (!consistent) {
+            throw std::runtime_error("FMIndex::load: " + path + " is truncated or corrupt");
+        }
+        
+        index.n = header.n;
+        index.dollar_row = header.dollar_row;
+        index.sa_sample_rate = header.sa_sample_rate;
+        std::copy(header.C, header.C + 5, index.C);
+        index.occ = reinterpret_cast<const OccBlock*>(bytes + header.occ_offset);
+        index.occ_blocks = header.occ_blocks;
+        index.sa_samples = reinterpret_cast<const uint32_t*>(bytes + header.samples_offset);
+        index.samples_count = header.samples_count;
+        index.sampled_bits = reinterpret_cast<const uint64_t*>(bytes + header.bits_offset);
+        index.sampled_rank = reinterpret_cast<const uint32_t*>(bytes + header.rank_offset);
+        index.bits_words = header.bits_words;
+        
+        // The last checkpoint plus the rest of its block must add up to C[]
+        for (uint8_t c = 0; c < 4; c++) {
+            if (index.rank(c, index.n) != index.C[c + 1] - index.C[c]) {
+                throw std::runtime_error("FMIndex::load: " + path + " is truncated or corrupt");
+            }
+        }
+        return index;
+    }
+    
+    /**
+     * Check every occurrence checkpoint, SA sample and sampled-row rank
+     * against the data they summarize, reading the whole index once.
+     *
+     * @throws runtime_error if any of them is inconsistent
+     */
+    void verify() const {
+        auto fail = [] { throw std::runtime_error("FMIndex::verify: the index is corrupt"); };
+        uint32_t counts[4] = {};
+        for (size_t b = 0; b < occ_blocks; b++) {
+            if (!std::equal(counts, counts + 4, occ[b].counts)) {
+                fail();
+            }
+            uint32_t first = b * OccBlock::SYMBOLS;
+            uint32_t last = std::min<uint64_t>(first + OccBlock::SYMBOLS, n);
+            for (uint32_t row = first; row < last; row++) {
+                counts[symbol(row)] += row != dollar_row;
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            if (counts[c] != C[c + 1] - C[c]) {
+                fail();
+            }
+        }
+        uint64_t sampled = 0;
+        for (size_t w = 0; w < bits_words; w++) {
+            if (sampled_rank[w] != sampled) {
+                fail();
+            }
+            sampled += __builtin_popcountll(sampled_bits[w]);
+        }
+        if (sampled != samples_count) {
+            fail();
+        }
+        for (size_t s = 0; s < samples_count; s++) {
+            if (sa_samples[s] >= n) {
+                fail();
+            }
+        }
+    }
+    
+    /**
+     * Count occurrences of pattern in the text.
+     */
+    uint32_t count(const std::string& pattern) const {
+        auto [top, bottom] = backward_search(pattern);
+        return bottom - top;
+    }
+    
+    /**
+     * Find all positions where pattern occurs in text.
+     */
+    std::vector<uint32_t> locate(const std::string& pattern) const {
+        auto [top, bottom] = backward_search(pattern);
+        
+        if (top >= bottom) {
+            return {};
+        }
+        
+        std::vector<uint32_t> positions;
+        positions.reserve(bottom - top);
+        for (uint32_t i = top; i < bottom; i++) {
+            positions.push_back(resolve_position(i));
+        }
+        
+        std::sort(positions.begin(), positions.end());
+        return positions;
+    }
+    
+    /**
+     * Count occurrences of many patterns, interleaving their backward searches.
+     *
+     * Equivalent to calling count() on each pattern, but keeps many searches in
+     * flight so the occurrence-table cache misses overlap.
+     */
+    std::vector<uint32_t> count_batch(const std::vector<std::string>& patterns) const {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges = backward_search_batch(patterns);
+        
+        std::vector<uint32_t> counts(patterns.size());
+        for (size_t i = 0; i < patterns.size(); i++) {
+            counts[i] = ranges[i].second - ranges[i].first;
+        }
+        return counts;
+    }
+    
+    /**
+     * Find all positions of many patterns, interleaving searches and LF walks.
+     *
+     * Equivalent to calling locate() on each pattern.
+     */
+    std::vector<std::vector<uint32_t>> locate_batch(const std::vector<std::string>& patterns) const {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges = backward_search_batch(patterns);
+        
+        // Resolve the rows of every hit in one interleaved pass
+        std::vector<uint32_t> rows;
+        for (const auto& [top, bottom] : ranges) {
+            for (uint32_t i = top; i < bottom; i++) {
+                rows.push_back(i);
+            }
+        }
+        resolve_positions_batch(rows);
+        
+        std::vector<std::vector<uint32_t>> positions(patterns.size());
+        size_t hit = 0;
+        for (size_t i = 0; i < patterns.size(); i++) {
+            auto [top, bottom] = ranges[i];
+            positions[i].assign(rows.begin() + hit, rows.begin() + hit + (bottom - top));
+            std::sort(positions[i].begin(), positions[i].end());
+            hit += bottom - top;
+        }
+        return positions;
+    }
+};
+
+/**
+ * Search scheme for approximate matching with a bidirectional index
+ * (Kucherov, Salikhov and Tsur 2016).
+ *
+ * The pattern is cut into pieces of near-equal length. Each search matches
+ * the pieces in its order, which grows the matched part one piece to the
+ * left or right at a time; once its t-th piece is matched the errors so far
+ * must lie in [lower[t], upper[t]]. A scheme for k errors is complete if
+ * every spread of at most k errors over the pieces passes some search. It
+ * prunes best when the first pieces allow few errors, as that is where the
+ * matched string is short and the index ranges are wide.
+ */
+struct SearchScheme {
+    struct Search {
+        std::vector<int> order;
+        std::vector<int> lower;
+        std::vector<int> upper;
+    };
+    
+    int pieces = 1;
+    std::vector<Search> searches;
+    
+    /**
+     * One piece with up to k errors anywhere: plain backtracking.
+     */
+    static SearchScheme backtracking(int k) {
+        return {1, {{{0}, {0}, {k}}}};
+    }
+    
+    /**
+     * k + 1 pieces. Search i matches piece i exactly, then the pieces to its
+     * right and then those to its left with up to k errors; complete because
+     * some piece is always error-free.
+     */
+    static SearchScheme pigeonhole(int k) {
+        SearchScheme scheme;
+        scheme.pieces = k + 1;
+        for (int i = 0; i <= k; i++) {
+            Search search;
+            for (int j = i; j <= k; j++) {
+                search.order.push_back(j);
+            }
+            for (int j = i - 1; j >= 0; j--) {
+                search.order.push_back(j);
+            }
+            search.lower.assign(k + 1, 0);
+            search.upper.assign(k + 1, k);
+            search.upper[0] = 0;
+            scheme.searches.push_back(search);
+        }
+        return scheme;
+    }
+    
+    /**
+     * The optimal schemes of Kucherov et al. for one and two errors, and the
+     * pigeonhole scheme for more.
+     */
+    static SearchScheme for_errors(int k) {
+        if (k <= 0) {
+            return backtracking(0);
+        }
+        if (k == 1) {
+            return {2, {{{0, 1}, {0, 0}, {0, 1}},
+                        {{1, 0}, {0, 1}, {0, 1}}}};
+        }
+        if (k == 2) {
+            return {3, {{{0, 1, 2}, {0, 0, 0}, {0, 2, 2}},
+                        {{2, 1, 0}, {0, 0, 0}, {0, 1, 2}},
+                        {{1, 0, 2}, {0, 1, 1}, {0, 1, 2}}}};
+        }
+        return pigeonhole(k);
+    }
+};
+
+/**
+ * Occurrence of a pattern in text[position, position + length) with errors
+ * mismatches (or edits).
+ */
+struct ApproximateMatch {
+    uint32_t position;
+    uint32_t length;
+    int errors;
+};
+
+/**
+ * Bidirectional FM-index: FM-indexes of the text and of the reversed text.
+ *
+ * A string is represented by its bi-interval, the first rows of its range in
+ * the text's BWT and of its reverse's range in the reversed text's BWT plus
+ * the common size. Prepending a character is a backward-search step on the
+ * text index; the string's reverse range then narrows to the sub-range of
+ * the rows followed by that character, found from the ranks of the smaller
+ * characters. Appending is the same with the roles of the indexes swapped,
+ * so a match can be grown in either direction from any starting piece.
+ *
+ * Only the text index keeps suffix array samples; the reversed one is used
+ * for ranks alone.
+ */
+class BidirectionalFMIndex {
+public:
+    struct BiInterval {
+        uint32_t forward;   // First row in the text index
+        uint32_t reverse;   // First row in the reversed text index
+        uint32_t size;
+    };
+    
+    /**
+     * query[query_start, query_end) occurs exactly at the rows of interval.
+     */
+    struct MaximalMatch {
+        int query_start;
+        int query_end;
+        BiInterval interval;
+    };
+
+private:
+    FMIndex forward;
+    FMIndex reverse;
+    
+    struct Step {
+        int pos;     // Pattern position matched by this step
+        bool right;  // Grows the match to the right
+        int lower;   // Errors required after this step (end of a piece), else 0
+        int upper;   // Errors allowed up to this step
+    };
+    
+    struct Candidate {
+        BiInterval interval;
+        uint32_t length;
+        int errors;
+    };
+    
+    static std::string reversed_text(const std::string& text) {
+        size_t length = !text.empty() && text.back() == '$' ? text.length() - 1 : text.length();
+        return std::string(text.rend() - length, text.rend());
+    }
+    
+    /**
+     * All four one-character extensions of a string: backward steps on index,
+     * whose range starts at row, narrowing the other index's range at other.
+     */
+    static void extend_all(const FMIndex& index, uint32_t row, uint32_t other, uint32_t size,
+                           uint32_t rows[4], uint32_t others[4], uint32_t sizes[4]) {
+        uint32_t lo[4], hi[4];
+        index.rank_all(row, lo);
+        index.rank_all(row + size, hi);
+        
+        // The occurrence at the start of the text (preceded by '$') sorts first
+        uint32_t offset = other + (index.dollar_row >= row && index.dollar_row < row + size);
+        for (int c = 0; c < 4; c++) {
+            rows[c] = index.C[c] + lo[c];
+            sizes[c] = hi[c] - lo[c];
+            others[c] = offset;
+            offset += sizes[c];
+        }
+    }
+    
+    void extend(const BiInterval& interval, bool right, BiInterval next[4]) const {
+        metrics_count(Metric::BackwardSearchSteps);
+        uint32_t rows[4], others[4], sizes[4];
+        if (right) {
+            extend_all(reverse, interval.reverse, interval.forward, interval.size, rows, others, sizes);
+        } else {
+            extend_all(forward, interval.forward, interval.reverse, interval.size, rows, others, sizes);
+        }
+        for (int c = 0; c < 4; c++) {
+            next[c] = right ? BiInterval{others[c], rows[c], sizes[c]}
+                            : BiInterval{rows[c], others[c], sizes[c]};
+        }
+    }
+    
+    /**
+     * Match steps[q...] from a matched string of the given interval and length.
+     *
+     * Besides (mis)matching the step's pattern character, edits may skip it
+     * (an insertion in the pattern) or match an extra text character first (a
+     * deletion). Deletions are not tried before the first step, and an
+     * insertion never directly follows a deletion or vice versa: either would
+     * only rediscover a match with fewer errors.
+     */
+    void backtrack(const std::vector<Step>& steps, const std::vector<uint8_t>& codes, bool edits, size_t q,
+                   const BiInterval& interval, int errors, uint32_t length, char last,
+                   std::vector<Candidate>& out) const {
+        if (q == steps.size()) {
+            if (length > 0) {
+                out.push_back({interval, length, errors});
+            }
+            return;
+        }
+        const Step& step = steps[q];
+        BiInterval next[4];
+        extend(interval, step.right, next);
+        for (uint8_t c = 0; c < 4; c++) {
+            if (next[c].size == 0) {
+                continue;
+            }
+            int cost = errors + (codes[step.pos] != c);
+            if (cost <= step.upper && cost >= step.lower) {
+                backtrack(steps, codes, edits, q + 1, next[c], cost, length + 1, 'M', out);
+            }
+            if (edits && q > 0 && last != 'I' && errors < step.upper) {
+                backtrack(steps, codes, edits, q, next[c], errors + 1, length + 1, 'D', out);
+            }
+        }
+        if (edits && last != 'D' && errors < step.upper && errors + 1 >= step.lower) {
+            backtrack(steps, codes, edits, q + 1, interval, errors + 1, length, 'I', out);
+        }
+    }
+
+public:
+    /**
+     * Build both indexes.
+     *
+     * @param text DNA text to index ('$' is appended if missing)
+     * @param sample_rate Suffix array sampling of the text index (see FMIndex)
+     * @param options Threads and memory per pass for both builds
+     * @throws invalid_argument if the text contains characters other than A, C, G, T
+     */
+    explicit BidirectionalFMIndex(const std::string& text, uint32_t sample_rate = 32,
+                                  const IndexBuildOptions& options = {})
+        : forward(text, sample_rate, options),
+          reverse(reversed_text(text), std::numeric_limits<uint32_t>::max(), options) {}
+    
+    /**
+     * Count exact occurrences of pattern in the text.
+     */
+    uint32_t count(const std::string& pattern) const {
+        return forward.count(pattern);
+    }
+    
+    /**
+     * Find all positions where pattern occurs exactly in the text.
+     */
+    std::vector<uint32_t> locate(const std::string& pattern) const {
+        return forward.locate(pattern);
+    }
+    
+    /**
+     * Text positions of the rows of interval, sorted.
+     */
+    std::vector<uint32_t> positions(const BiInterval& interval) const {
+        std::vector<uint32_t> rows;
+        positions(interval, rows);
+        return rows;
+    }
+    
+    /**
+     * positions() into rows, reusing its storage.
+     */
+    void positions(const BiInterval& interval, std::vector<uint32_t>& rows) const {
+        rows.resize(interval.size);
+        for (uint32_t i = 0; i < interval.size; i++) {
+            rows[i] = interval.forward + i;
+        }
+        forward.resolve_positions_batch(rows);
+        std::sort(rows.begin(), rows.end());
+    }
+    
+    /**
+     * Super-maximal exact matches (SMEMs) of query of at least min_length.
+     *
+     * A maximal exact match cannot be extended either way and still occur
+     * in the text; an SMEM is one not contained in any other maximal match
+     * (as seeded by BWA-MEM). Matches do not span characters other than A,
+     * C, G, T. Returned in order of query start (and so of end).
+     *
+     * SMEMs are found left to right, using that no two contain each other:
+     * - From a start x, query[x, x + min_length) is looked up right to left;
+     *   if query[j, x + min_length) is absent, no long enough SMEM starts
+     *   at or before j, and the scan resumes at j + 1
+     * - Otherwise the match is grown right to its end e, and query[x, e) is
+     *   an SMEM: query[x - 1, e) is absent by the choice of x
+     * - The next SMEM must end beyond e, so it starts where the longest match
+     *   ending at e + 1 starts, found by growing left from there
+     * This only spends index steps near long enough matches, so a query with
+     * none (the wrong strand of a read) costs about |query| / (min_length -
+     * log4(text length)) short lookups.
+     */
+    std::vector<MaximalMatch> smems(const std::string& query, int min_length = 1) const {
+        std::vector<MaximalMatch> result;
+        smems(query, min_length, result);
+        return result;
+    }
+    
+    /**
+     * smems() into result, reusing its storage.
+     */
+    void smems(const std::string& query, int min_length, std::vector<MaximalMatch>& result) const {
+        const int n = query.length();
+        const int length = std::max(min_length, 1);
+        
+        const BiInterval whole = {0, 0, forward.n};
+        BiInterval next[4];
+        auto grow = [&](BiInterval& interval, bool right, int i) {
+            uint8_t code = dna_code(query[i]);
+            if (code > 3) {
+                return false;
+            }
+            extend(interval, right, next);
+            if (next[code].size == 0) {
+                return false;
+            }
+            interval = next[code];
+            return true;
+        };
+        
+        result.clear();
+        int x = 0, end = 0;          // match holds query[x, end)
+        BiInterval match = whole;
+        while (true) {
+            if (end - x < length) {
+                if (x + length > n) {
+                    break;
+                }
+                int j = x + length;
+                match = whole;
+                while (j > x && grow(match, false, j - 1)) {
+                    j--;
+                }
+                if (j > x) {
+                    x = end = j;
+                    continue;
+                }
+                end = x + length;
+            }
+            while (end < n && grow(match, true, end)) {
+                end++;
+            }
+            result.push_back({x, end, match});
+            if (end == n) {
+                break;
+            }
+            
+            // query[x, end + 1) is absent, so the next start is beyond x
+            int start = end + 1;
+            BiInterval prefix = whole;
+            while (start > x + 1 && grow(prefix, false, start - 1)) {
+                start--;
+            }
+            end++;
+            x = start;
+            match = prefix;
+        }
+    }
+    
+    /**
+     * Find all occurrences of pattern within max_errors mismatches, or edits
+     * if edits is set, using the search scheme of SearchScheme::for_errors().
+     */
+    std::vector<ApproximateMatch> approximate_search(const std::string& pattern, int max_errors,
+                                                     bool edits = false) const {
+        return approximate_search(pattern, SearchScheme::for_errors(std::max(max_errors, 0)), edits);
+    }
+    
+    /**
+     * Find all occurrences of pattern that some search of scheme accepts.
+     *
+     * An occurrence is reported once per (position, length) with its fewest
+     * errors, sorted by position then length; with edits its first and last
+     * text characters are aligned to pattern characters. Characters other
+     * than A, C, G, T in the pattern mismatch everything. Patterns shorter
+     * than the scheme's piece count are searched by plain backtracking.
+     */
+    std::vector<ApproximateMatch> approximate_search(const std::string& pattern, const SearchScheme& scheme,
+                                                     bool edits = false) const {
+        const int m = pattern.length();
+        if (m == 0) {
+            return {};
+        }
+        SearchScheme fallback;
+        const SearchScheme* use = &scheme;
+        if (m < scheme.pieces) {
+            int k = 0;
+            for (const SearchScheme::Search& search : scheme.searches) {
+                k = std::max(k, search.upper.back());
+            }
+            fallback = SearchScheme::backtracking(k);
+            use = &fallback;
+        }
+        
+        std::vector<uint8_t> codes(m);
+        for (int i = 0; i < m; i++) {
+            codes[i] = dna_code(pattern[i]);
+        }
+        std::vector<int> bounds(use->pieces + 1);
+        for (int p = 0; p <= use->pieces; p++) {
+            bounds[p] = static_cast<long>(p) * m / use->pieces;
+        }
+        
+        // Unroll every search into single-character steps: the first piece
+        // right to left, then each piece in the direction it grows the match
+        std::vector<Candidate> candidates;
+        for (const SearchScheme::Search& search : use->searches) {
+            std::vector<Step> steps;
+            int rightmost = search.order[0];
+            for (size_t t = 0; t < search.order.size(); t++) {
+                int piece = search.order[t];
+                bool right = piece > rightmost;
+                rightmost = std::max(rightmost, piece);
+                size_t first = steps.size();
+                for (int i = bounds[piece]; i < bounds[piece + 1]; i++) {
+                    int pos = right ? i : bounds[piece] + bounds[piece + 1] - 1 - i;
+                    steps.push_back({pos, right, 0, search.upper[t]});
+                }
+                if (steps.size() > first) {
+                    steps.back().lower = search.lower[t];
+                }
+            }
+            BiInterval whole = {0, 0, forward.n};
+            backtrack(steps, codes, edits, 0, whole, 0, 0, 'M', candidates);
+        }
+        
+        std::vector<ApproximateMatch> matches;
+        for (const Candidate& candidate : candidates) {
+            for (uint32_t i = 0; i < candidate.interval.size; i++) {
+                matches.push_back({forward.resolve_position(candidate.interval.forward + i),
+                                   candidate.length, candidate.errors});
+            }
+        }
+        std::sort(matches.begin(), matches.end(), [](const ApproximateMatch& a, const ApproximateMatch& b) {
+            return std::tie(a.position, a.length, a.errors) < std::tie(b.position, b.length, b.errors);
+        });
+        matches.erase(std::unique(matches.begin(), matches.end(),
+                                  [](const ApproximateMatch& a, const ApproximateMatch& b) {
+                                      return a.position == b.position && a.length == b.length;
+                                  }),
+                      matches.end());
+        return matches;
+    }
+};
+
+#endif // FM_INDEX_H
@@ -0,0 +1,895 @@
+/**
+ * Hirschberg Algorithm for Space-Efficient Global Sequence Alignment
+ * 
+ * This is a space-efficient divide-and-conquer algorithm for global sequence alignment,
+ * developed by Dan Hirschberg in 1975. It improves upon the Needleman-Wunsch algorithm
+ * by reducing space complexity from O(m * n) to O(min(m, n)) while maintaining the
+ * same O(m * n) time complexity.
+ * 
+ * The algorithm works by:
+ * 1. Using only two rows of the DP matrix at a time (space optimization)
+ * 2. Dividing the problem recursively at the midpoint
+ * 3. Finding the optimal split point using NW score function
+ * 4. Recursively aligning left and right halves
+ * 5. Concatenating the results (appending CIGAR runs, so combining is linear)
+ * 
+ * myers_miller() extends the same scheme to affine gaps (Myers & Miller 1988):
+ * the score passes carry Gotoh's match and deletion states, and the split may
+ * fall inside a deletion crossing the middle row.
+ * 
+ * In parallel mode (HirschbergOptions) the forward and reverse score passes
+ * of a subproblem run concurrently and its two halves are forked as tasks on
+ * a work-stealing pool; small subproblems are solved by a full-matrix DP with
+ * 2-bit traceback instead of recursing down to single characters.
+ * 
+ * Time Complexity: O(m * n) where m and n are the lengths of the sequences
+ * Space Complexity: O(min(m, n)) - key improvement over standard Needleman-Wunsch
+ * 
+ * Reference:
+ * Hirschberg, D. S. (1975). A linear space algorithm for computing maximal common
+ * subsequences. Communications of the ACM, 18(6), 341-343.
+ * Myers, E. W. & Miller, W. (1988). Optimal alignments in linear space.
+ * Computer Applications in the Biosciences, 4(1), 11-17.
+ */
+
+#ifndef HIRSCHBERG_H
+#define HIRSCHBERG_H
+
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <limits>
+
+#include "aligner_context.h"
+#include "cigar.h"
+#include "dp_matrix.h"
+#include "metrics.h"
+#include "scoring.h"
+#include "thread_pool.h"
+#include "wavefront.h"
+
+// Score of cells outside a band; small enough to never win, safe to add penalties to
+const int HIRSCHBERG_NEG_INF = std::numeric_limits<int>::min() / 2;
+
+/**
+ * Compute the last row of Needleman-Wunsch scores using only O(n) space.
+ * 
+ * This function calculates the alignment scores but only keeps the last row
+ * of the DP matrix, which is sufficient for finding the optimal split point
+ * in Hirschberg's algorithm.
+ * 
+ * When a band is given, only cells with band_lo <= j - i <= band_hi are
+ * computed (O(band width) time per row) and every other cell scores HIRSCHBERG_NEG_INF.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param scoring Substitution policy and linear gap model (see scoring.h)
+ * @param band_lo Lowest diagonal j - i to compute
+ * @param band_hi Highest diagonal j - i to compute
+ * @param arena Scratch for the second row
+ * @param row Receives the last row of DP scores (length n+1)
+ */
+template <typename ScoringPolicy>
+void nw_score_row(std::string_view seq1, std::string_view seq2, const ScoringPolicy& scoring,
+                  int band_lo, int band_hi, ScratchArena& arena, int* row) {
+    int m = seq1.length();
+    int n = seq2.length();
+    const int gap_penalty = scoring.gap.extend();
+    band_lo = std::max(band_lo, -m);
+    band_hi = std::min(band_hi, n);
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    
+    // Only maintain two rows: previous and current
+    int* prev_row = row;
+    int* curr_row = arena.allocate<int>(n + 1);
+    std::fill(prev_row, prev_row + n + 1, HIRSCHBERG_NEG_INF);
+    std::fill(curr_row, curr_row + n + 1, HIRSCHBERG_NEG_INF);
+    
+    // Initialize first row
+    for (int j = 0; j <= std::min(n, band_hi); j++) {
+        prev_row[j] = j * gap_penalty;
+    }
+    
+    // Fill rows one at a time, within the band
+    uint64_t cells = 0;
+    for (int i = 1; i <= m; i++) {
+        int j_begin = std::max(0, i + band_lo);
+        int j_end = std::min(n, i + band_hi);
+        
+        // Cells just outside the band read as HIRSCHBERG_NEG_INF in the next row (a
+        // band may miss the row entirely)
+        if (j_begin > 0 && j_begin <= n + 1) {
+            curr_row[j_begin - 1] = HIRSCHBERG_NEG_INF;
+        }
+        if (j_end < n && j_end >= -1) {
+            curr_row[j_end + 1] = HIRSCHBERG_NEG_INF;
+        }
+        if (j_begin == 0) {
+            curr_row[0] = i * gap_penalty;
+            j_begin = 1;
+        }
+        
+        cells += std::max(0, j_end - j_begin + 1);
+        auto substitution = profile.row(seq1[i - 1]);
+        for (int j = j_begin; j <= j_end; j++) {
+            int match = prev_row[j - 1] + substitution[j - 1];
+            int del = prev_row[j] + gap_penalty;
+            int insert = curr_row[j - 1] + gap_penalty;
+            
+            curr_row[j] = std::max({match, del, insert});
+        }
+        
+        // Swap rows for next iteration
+        std::swap(prev_row, curr_row);
+    }
+    metrics_count(Metric::DPCells, cells);
+    
+    // Clear stale cells outside the last row's band
+    int j_begin = std::min(std::max(0, m + band_lo), n + 1);
+    int j_end = std::max(std::min(n, m + band_hi), -1);
+    std::fill(prev_row, prev_row + j_begin, HIRSCHBERG_NEG_INF);
+    std::fill(prev_row + j_end + 1, prev_row + n + 1, HIRSCHBERG_NEG_INF);
+    if (prev_row != row) {
+        std::copy(prev_row, prev_row + n + 1, row);
+    }
+}
+
+/**
+ * Last row of Needleman-Wunsch scores of seq1 against seq2 (see nw_score_row()).
+ * 
+ * @param band_lo Lowest diagonal j - i to compute (default: unbanded)
+ * @param band_hi Highest diagonal j - i to compute (default: unbanded)
+ * @return Vector containing the last row of DP scores (length n+1)
+ */
+template <typename ScoringPolicy>
+std::vector<int> nw_score(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                          int band_lo = HIRSCHBERG_NEG_INF,
+                          int band_hi = -HIRSCHBERG_NEG_INF) {
+    std::vector<int> row(seq2.length() + 1);
+    nw_score_row(seq1, seq2, scoring, band_lo, band_hi, AlignerContext::local().arena, row.data());
+    return row;
+}
+
+/**
+ * nw_score() reusing context.
+ *
+ * @return context.scores, valid until the next call with context
+ */
+template <typename ScoringPolicy>
+const std::vector<int>& nw_score(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                                 AlignerContext& context,
+                                 int band_lo = HIRSCHBERG_NEG_INF,
+                                 int band_hi = -HIRSCHBERG_NEG_INF) {
+    context.scores.resize(seq2.length() + 1);
+    nw_score_row(seq1, seq2, scoring, band_lo, band_hi, context.arena, context.scores.data());
+    return context.scores;
+}
+
+/**
+ * Parallel mode of hirschberg_cigar().
+ *
+ * Subproblems of at least grain_cells DP cells run their two score passes
+ * concurrently and fork their halves as tasks; subproblems of at most
+ * base_cells cells are aligned with one full-matrix DP. The defaults keep
+ * the serial recursion down to single characters.
+ */
+struct HirschbergOptions {
+    size_t threads = 1;            // Worker threads; 0 = all cores
+    long long grain_cells = 1 << 22;
+    long long base_cells = 0;      // 0 = recurse to the m == 1 / n == 1 cases
+
+    static HirschbergOptions parallel(size_t threads = 0) {
+        HirschbergOptions options;
+        options.threads = threads;
+        options.base_cells = 1 << 16;
+        return options;
+    }
+};
+
+/**
+ * Full-matrix Needleman-Wunsch within the band band_lo <= j - i <= band_hi:
+ * append the alignment of seq1 against seq2 to cigar.
+ *
+ * Scores are kept two rows at a time and moves in a 2-bit traceback matrix,
+ * so a base case of c cells needs c / 4 bytes of arena.
+ *
+ * @return Score of the appended alignment
+ */
+template <typename ScoringPolicy, typename Script>
+int nw_full_append(std::string_view seq1, std::string_view seq2, const ScoringPolicy& scoring,
+                   int band_lo, int band_hi, Script& cigar, ScratchArena& arena) {
+    const uint8_t DIAG = 0, UP = 1, LEFT = 2;
+    int m = seq1.length();
+    int n = seq2.length();
+    const int gap_penalty = scoring.gap.extend();
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    metrics_count(Metric::DPCells, uint64_t(m) * n);
+    
+    TracebackMatrix<2> trace(m + 1, n + 1, arena);
+    int* prev_row = arena.allocate<int>(n + 1);
+    int* curr_row = arena.allocate<int>(n + 1);
+    std::fill(prev_row, prev_row + n + 1, HIRSCHBERG_NEG_INF);
+    std::fill(curr_row, curr_row + n + 1, HIRSCHBERG_NEG_INF);
+    for (int j = 0; j <= std::min(n, band_hi); j++) {
+        prev_row[j] = j * gap_penalty;
+        trace.set(0, j, LEFT);
+    }
+    
+    for (int i = 1; i <= m; i++) {
+        curr_row[0] = -i >= band_lo ? i * gap_penalty : HIRSCHBERG_NEG_INF;
+        trace.set(i, 0, UP);
+        auto substitution = profile.row(seq1[i - 1]);
+        for (int j = 1; j <= n; j++) {
+            if (j - i < band_lo || j - i > band_hi) {
+                curr_row[j] = HIRSCHBERG_NEG_INF;
+                continue;
+            }
+            int match = prev_row[j - 1] + substitution[j - 1];
+            int del = prev_row[j] + gap_penalty;
+            int insert = curr_row[j - 1] + gap_penalty;
+            
+            if (match >= del && match >= insert) {
+                curr_row[j] = match;
+            } else if (del >= insert) {
+                curr_row[j] = del;
+                trace.set(i, j, UP);
+            } else {
+                curr_row[j] = insert;
+                trace.set(i, j, LEFT);
+            }
+        }
+        std::swap(prev_row, curr_row);
+    }
+    
+    // Moves from the end back to (0, 0), appended to cigar in forward order
+    char* path = arena.allocate<char>(m + n);
+    int length = 0;
+    for (int i = m, j = n; i > 0 || j > 0;) {
+        uint8_t move = trace.get(i, j);
+        if (move == DIAG) {
+            path[length++] = 'M';
+            i--;
+            j--;
+        } else if (move == UP) {
+            path[length++] = 'I';
+            i--;
+        } else {
+            path[length++] = 'D';
+            j--;
+        }
+    }
+    while (length > 0) {
+        cigar.push(path[--length]);
+    }
+    return prev_row[n];
+}
+
+/**
+ * Optimal split of seq2 for aligning seq1[0, mid) against its left part: the
+ * column maximizing forward plus reverse last-row scores.
+ *
+ * Both score rows and the reversed sequences are taken from arena. With a
+ * pool the two score passes run concurrently, each on the scratch arena of
+ * the thread running it.
+ */
+template <typename ScoringPolicy>
+int hirschberg_split(std::string_view seq1, std::string_view seq2, int mid, const ScoringPolicy& scoring,
+                     int band_lo, int band_hi, int band_width, ScratchArena& arena,
+                     WorkStealingPool* pool) {
+    int m = seq1.length();
+    int n = seq2.length();
+    ScratchArena::Scope scope(arena);
+    int* score_left = arena.allocate<int>(n + 1);
+    int* score_right = arena.allocate<int>(n + 1);
+    
+    // Large unbanded match/mismatch passes are themselves split into a
+    // wavefront of SIMD tiles
+    WorkStealingPool* tiles = pool && band_width < 0 && (long long)m * n >= (1LL << 26) ? pool : nullptr;
+    auto pass = [&](std::string_view a, std::string_view b, int lo, int hi, int* out) {
+        ScratchArena& scratch = pool ? AlignerContext::local().arena : arena;
+        if constexpr (is_match_mismatch<typename ScoringPolicy::substitution_type>::value) {
+            if (tiles) {
+                nw_wavefront_last_row(a, b, scoring.substitution.match, scoring.substitution.mismatch,
+                                      scoring.gap.extend(), tiles, scratch, out);
+                return;
+            }
+        }
+        nw_score_row(a, b, scoring, lo, hi, scratch, out);
+    };
+    
+    // Compute NW scores from left (seq1[:mid] vs seq2)
+    auto left_pass = [&] {
+        pass(seq1.substr(0, mid), seq2, band_lo, band_hi, score_left);
+    };
+    
+    // Compute NW scores from right (seq1[mid:][::-1] vs seq2[::-1])
+    // We reverse both sequences to compute scores from the end
+    char* seq1_right = arena.allocate<char>(m - mid);
+    char* seq2_rev = arena.allocate<char>(n);
+    std::reverse_copy(seq1.begin() + mid, seq1.end(), seq1_right);
+    std::reverse_copy(seq2.begin(), seq2.end(), seq2_rev);
+    auto right_pass = [&] {
+        // In reversed coordinates the diagonal j - i becomes (n - m) - (j - i)
+        pass(std::string_view(seq1_right, m - mid), std::string_view(seq2_rev, n),
+             band_width >= 0 ? (n - m) - band_hi : band_lo,
+             band_width >= 0 ? (n - m) - band_lo : band_hi, score_right);
+        
+        // Reverse score_right to align with seq2
+        std::reverse(score_right, score_right + n + 1);
+    };
+    
+    if (pool) {
+        pool->fork_join(left_pass, right_pass);
+    } else {
+        left_pass();
+        right_pass();
+    }
+    
+    // Find the split point in seq2 that maximizes total score
+    int max_score = std::numeric_limits<int>::min();
+    int split = 0;
+    
+    for (int j = 0; j <= n; j++) {
+        int total_score = score_left[j] + score_right[j];
+        if (total_score > max_score) {
+            max_score = total_score;
+            split = j;
+        }
+    }
+    return split;
+}
+
+/**
+ * Hirschberg recursion: append the alignment of seq1 against seq2 to cigar
+ * (a Cigar or CigarSpan).
+ *
+ * The subproblems view seq1 and seq2 and take their scratch from arena.
+ * pool, if given, runs the score passes and halves of subproblems of at
+ * least options.grain_cells cells in parallel; a task on another thread
+ * uses that thread's AlignerContext::local() arena. The right half of a
+ * fork writes its runs to a CigarSpan in arena, appended once both are done.
+ *
+ * @return Score of the appended alignment
+ */
+template <typename ScoringPolicy, typename Script>
+int hirschberg_append(std::string_view seq1, std::string_view seq2, const ScoringPolicy& scoring,
+                      int band_width, Script& cigar, ScratchArena& arena,
+                      const HirschbergOptions& options = {}, WorkStealingPool* pool = nullptr) {
+    int m = seq1.length();
+    int n = seq2.length();
+    const int gap_penalty = scoring.gap.extend();
+    
+    // Base cases
+    if (m == 0) {
+        // All gaps in seq1
+        cigar.push('D', n);
+        return n * gap_penalty;
+    }
+    
+    if (n == 0) {
+        // All gaps in seq2
+        cigar.push('I', m);
+        return m * gap_penalty;
+    }
+    
+    // Band of this subproblem as diagonals j - i (the same band as needleman_wunsch_banded())
+    int band_lo = HIRSCHBERG_NEG_INF;
+    int band_hi = -HIRSCHBERG_NEG_INF;
+    if (band_width >= 0) {
+        band_lo = std::min(0, n - m) - band_width;
+        band_hi = std::max(0, n - m) + band_width;
+    }
+    
+    // A banded subproblem keeps the recursive base cases: its band depends on
+    // the subproblem's corners, so a different base case could change the result
+    if (band_width < 0 && (long long)(m + 1) * (n + 1) <= options.base_cells) {
+        return nw_full_append(seq1, seq2, scoring, band_lo, band_hi, cigar, arena);
+    }
+    
+    if (m == 1) {
+        // Single character in seq1 - use simple alignment
+        // Try to match seq1[0] with each position in seq2
+        int best_score = std::numeric_limits<int>::min();
+        int best_j = 0;
+        
+        for (int j = 0; j <= n; j++) {
+            // Calculate score for aligning seq1[0] at position j in seq2
+            int score = j * gap_penalty;  // gaps before
+            if (j < n) {
+                score += scoring(seq1[0], seq2[j]);
+                score += (n - j - 1) * gap_penalty;  // gaps after
+            } else {
+                score += gap_penalty;  // seq1[0] aligned to gap
+            }
+            
+            if (score > best_score) {
+                best_score = score;
+                best_j = j;
+            }
+        }
+        
+        // Build alignment based on best position
+        if (best_j == n) {
+            // Align seq1[0] to gap at end
+            cigar.push('D', n);
+            cigar.push('I');
+        } else {
+            // Align seq1[0] to seq2[best_j]
+            cigar.push('D', best_j);
+            cigar.push('M');
+            cigar.push('D', n - best_j - 1);
+        }
+        
+        return best_score;
+    }
+    
+    if (n == 1) {
+        // Single character in seq2 - use simple alignment
+        int best_score = std::numeric_limits<int>::min();
+        int best_i = 0;
+        
+        for (int i = 0; i <= m; i++) {
+            int score = i * gap_penalty;
+            if (i < m) {
+                score += scoring(seq1[i], seq2[0]);
+                score += (m - i - 1) * gap_penalty;
+            } else {
+                score += gap_penalty;
+            }
+            
+            if (score > best_score) {
+                best_score = score;
+                best_i = i;
+            }
+        }
+        
+        if (best_i == m) {
+            cigar.push('I', m);
+            cigar.push('D');
+        } else {
+            cigar.push('I', best_i);
+            cigar.push('M');
+            cigar.push('I', m - best_i - 1);
+        }
+        
+        return best_score;
+    }
+    
+    // Divide and conquer
+    // Find the midpoint of seq1
+    int mid = m / 2;
+    
+    // Subproblems below the grain run serially
+    long long cells = (long long)(m + 1) * (n + 1);
+    if (cells < options.grain_cells) {
+        pool = nullptr;
+    }
+    
+    int split = hirschberg_split(seq1, seq2, mid, scoring, band_lo, band_hi, band_width, arena, pool);
+    
+    // Recursively align left and right parts; the right half's runs follow the left's
+    int left_score = 0, right_score = 0;
+    auto align_left = [&](auto& out) {
+        left_score = hirschberg_append(seq1.substr(0, mid), seq2.substr(0, split), scoring, band_width, out,
+                                       pool ? AlignerContext::local().arena : arena, options, pool);
+    };
+    auto align_right = [&](auto& out) {
+        right_score = hirschberg_append(seq1.substr(mid), seq2.substr(split), scoring, band_width, out,
+                                        pool ? AlignerContext::local().arena : arena, options, pool);
+    };
+    
+    if (pool) {
+        // The right half's runs (at most one per base) wait in the arena
+        ScratchArena::Scope scope(arena);
+        CigarSpan right(arena.allocate<uint32_t>((m - mid) + (n - split)));
+        pool->fork_join([&] { align_left(cigar); }, [&] { align_right(right); });
+        cigar.append(right);
+    } else {
+        align_left(cigar);
+        align_right(cigar);
+    }
+    
+    return left_score + right_score;
+}
+
+/**
+ * Hirschberg alignment of seq1 against seq2 into result; serial subproblems
+ * take their scratch from context's arena, parallel ones run on its pool.
+ */
+template <typename ScoringPolicy>
+void hirschberg_into(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                     int band_width, const HirschbergOptions& options,
+                     AlignerContext& context, AlignmentResult& result) {
+    static_assert(ScoringPolicy::gap_type::linear, "hirschberg takes a linear gap model");
+    result.cigar.clear();
+    WorkStealingPool* pool = options.threads == 1 ? nullptr : &context.pool(options.threads);
+    result.score = hirschberg_append(seq1, seq2, scoring, band_width, result.cigar, context.arena, options, pool);
+    result.start1 = 0;
+    result.end1 = seq1.length();
+    result.start2 = 0;
+    result.end2 = seq2.length();
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+}
+
+/**
+ * Perform space-efficient global sequence alignment using Hirschberg algorithm.
+ * 
+ * This is a divide-and-conquer algorithm that produces the same optimal alignment
+ * as Needleman-Wunsch but uses only O(min(m, n)) space instead of O(m * n).
+ * 
+ * The algorithm recursively:
+ * 1. Finds the midpoint of the first sequence
+ * 2. Computes NW scores from both ends to find optimal split in second sequence
+ * 3. Recursively aligns the left halves and right halves
+ * 4. Concatenates the results
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param scoring Substitution policy and linear gap model (see scoring.h)
+ * @param band_width If >= 0, restrict each subproblem's score passes to a band
+ *                   extending band_width diagonals beyond both of its corners,
+ *                   making each pass O(band width) per row (default: -1, unbanded)
+ * @param options Threads, fork grain and full-matrix base case size (default: serial)
+ * @return Score and CIGAR of the alignment, viewing seq1 and seq2
+ */
+template <typename ScoringPolicy>
+AlignmentResult hirschberg_cigar(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                                 int band_width = -1,
+                                 const HirschbergOptions& options = {}) {
+    AlignmentResult result;
+    hirschberg_into(seq1, seq2, scoring, band_width, options, AlignerContext::local(), result);
+    return result;
+}
+
+/**
+ * Hirschberg alignment reusing context: no heap allocation once the context
+ * (and, when parallel, its pool's threads) has aligned a pair this large.
+ *
+ * @return context.result, valid until the next alignment with context
+ */
+template <typename ScoringPolicy>
+const AlignmentResult& hirschberg_cigar(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                                        AlignerContext& context,
+                                        int band_width = -1,
+                                        const HirschbergOptions& options = {}) {
+    hirschberg_into(seq1, seq2, scoring, band_width, options, context, context.result);
+    return context.result;
+}
+
+/**
+ * Hirschberg alignment with match/mismatch scoring and a linear gap.
+ * 
+ * @param match_score Score for matching characters (default: 1)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_penalty Penalty for gaps (default: -1)
+ * @param band_width If >= 0, band each subproblem's score passes (default: -1, unbanded)
+ * @param options Threads, fork grain and full-matrix base case size (default: serial)
+ */
+AlignmentResult hirschberg_cigar(const std::string& seq1, const std::string& seq2,
+                                 int match_score = 1,
+                                 int mismatch_penalty = -1,
+                                 int gap_penalty = -1,
+                                 int band_width = -1,
+                                 const HirschbergOptions& options = {});
+
+/**
+ * Hirschberg alignment with match/mismatch scoring and a linear gap, reusing context.
+ *
+ * @return context.result, valid until the next alignment with context
+ */
+const AlignmentResult& hirschberg_cigar(const std::string& seq1, const std::string& seq2,
+                                        AlignerContext& context,
+                                        int match_score = 1,
+                                        int mismatch_penalty = -1,
+                                        int gap_penalty = -1,
+                                        int band_width = -1,
+                                        const HirschbergOptions& options = {});
+
+/**
+ * Perform space-efficient global sequence alignment using Hirschberg algorithm.
+ * 
+ * @return Alignment structure containing aligned sequences and score
+ */
+Alignment hirschberg(const std::string& seq1, const std::string& seq2,
+                    int match_score = 1,
+                    int mismatch_penalty = -1,
+                    int gap_penalty = -1,
+                    int band_width = -1);
+
+/**
+ * Forward pass of Myers-Miller: last-row scores of seq1 against every prefix
+ * of seq2 under affine gaps, in O(n) memory.
+ *
+ * CC[j] is the best score of seq1 against seq2[0, j); DD[j] the best of those
+ * ending in a deletion (seq1 residues against gaps, CIGAR 'I'). A deletion
+ * touching the top edge opens for gap_start instead of gap.open(), so that a
+ * gap continuing one from a neighbouring subproblem is not charged twice.
+ * CC and DD hold n + 1 scores each; the query profile is taken from arena.
+ */
+template <typename ScoringPolicy>
+void myers_miller_score(std::string_view seq1, std::string_view seq2, const ScoringPolicy& scoring,
+                        int gap_start, ScratchArena& arena, int* CC, int* DD) {
+    int m = seq1.length();
+    int n = seq2.length();
+    const int g = scoring.gap.open();
+    const int h = scoring.gap.extend();
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    metrics_count(Metric::DPCells, uint64_t(m) * n);
+    std::fill(CC, CC + n + 1, 0);
+    std::fill(DD, DD + n + 1, 0);
+    
+    // Row 0: insertions only; DD is seeded so that a deletion below opens from CC
+    int t = g;
+    for (int j = 1; j <= n; j++) {
+        t += h;
+        CC[j] = t;
+        DD[j] = t + g;
+    }
+    
+    t = gap_start;
+    for (int i = 1; i <= m; i++) {
+        int diag = CC[0];
+        t += h;
+        int c = t;
+        CC[0] = c;
+        int e = t + g;  // Best score ending in an insertion, in this row
+        auto substitution = profile.row(seq1[i - 1]);
+        for (int j = 1; j <= n; j++) {
+            e = std::max(e, c + g) + h;
+            DD[j] = std::max(DD[j], CC[j] + g) + h;
+            c = std::max({DD[j], e, diag + substitution[j - 1]});
+            diag = CC[j];
+            CC[j] = c;
+        }
+    }
+    DD[0] = CC[0];
+}
+
+/**
+ * Myers-Miller recursion: append the affine-gap alignment of seq1 against
+ * seq2 to cigar (a Cigar or CigarSpan).
+ *
+ * gap_start / gap_end are what a deletion touching the top / bottom edge
+ * pays to open: gap.open(), or 0 when it continues a deletion that crosses
+ * the edge and was already opened. Score rows and reversed sequences are
+ * taken from arena. Subproblems of at least grain_cells cells run their two
+ * passes and their halves in parallel on pool, as in hirschberg_append().
+ */
+template <typename ScoringPolicy, typename Script>
+void myers_miller_append(std::string_view seq1, std::string_view seq2, const ScoringPolicy& scoring,
+                         int gap_start, int gap_end, Script& cigar, ScratchArena& arena,
+                         const HirschbergOptions& options, WorkStealingPool* pool) {
+    int m = seq1.length();
+    int n = seq2.length();
+    const int g = scoring.gap.open();
+    const int h = scoring.gap.extend();
+    auto gap = [&](int k) { return k > 0 ? g + h * k : 0; };
+    
+    if (n == 0) {
+        cigar.push('I', m);
+        return;
+    }
+    if (m == 0) {
+        cigar.push('D', n);
+        return;
+    }
+    
+    if (m == 1) {
+        // Either delete seq1[0] (joining an open edge gap if there is one) and
+        // insert all of seq2, or align it to one seq2[j - 1] between two insertions
+        int best_score = std::max(gap_start, gap_end) + h + gap(n);
+        int best_j = 0;
+        for (int j = 1; j <= n; j++) {
+            int score = gap(j - 1) + scoring(seq1[0], seq2[j - 1]) + gap(n - j);
+            if (score > best_score) {
+                best_score = score;
+                best_j = j;
+            }
+        }
+        if (best_j > 0) {
+            cigar.push('D', best_j - 1);
+            cigar.push('M');
+            cigar.push('D', n - best_j);
+        } else if (gap_start >= gap_end) {
+            cigar.push('I');
+            cigar.push('D', n);
+        } else {
+            cigar.push('D', n);
+            cigar.push('I');
+        }
+        return;
+    }
+    
+    long long cells = (long long)(m + 1) * (n + 1);
+    if (cells < options.grain_cells) {
+        pool = nullptr;
+    }
+    
+    // Forward pass over the top half, reverse pass over the bottom half
+    int mid = m / 2;
+    ScratchArena::Scope scope(arena);
+    int* CC = arena.allocate<int>(n + 1);
+    int* DD = arena.allocate<int>(n + 1);
+    int* RR = arena.allocate<int>(n + 1);
+    int* SS = arena.allocate<int>(n + 1);
+    char* seq1_rev = arena.allocate<char>(m - mid);
+    char* seq2_rev = arena.allocate<char>(n);
+    std::reverse_copy(seq1.begin() + mid, seq1.end(), seq1_rev);
+    std::reverse_copy(seq2.begin(), seq2.end(), seq2_rev);
+    auto forward = [&] {
+        myers_miller_score(seq1.substr(0, mid), seq2, scoring, gap_start,
+                           pool ? AlignerContext::local().arena : arena, CC, DD);
+    };
+    auto backward = [&] {
+        myers_miller_score(std::string_view(seq1_rev, m - mid), std::string_view(seq2_rev, n), scoring, gap_end,
+                           pool ? AlignerContext::local().arena : arena, RR, SS);
+    };
+    if (pool) {
+        pool->fork_join(forward, backward);
+    } else {
+        forward();
+        backward();
+    }
+    
+    // Cross the middle either between two cells, or inside a deletion that
+    // spans rows mid and mid + 1 (opened once, not in both halves)
+    int best_score = std::numeric_limits<int>::min();
+    int split = 0;
+    bool in_deletion = false;
+    for (int j = 0; j <= n; j++) {
+        int through = CC[j] + RR[n - j];
+        if (through > best_score) {
+            best_score = through;
+            split = j;
+            in_deletion = false;
+        }
+        int deletion = DD[j] + SS[n - j] - g;
+        if (deletion > best_score) {
+            best_score = deletion;
+            split = j;
+            in_deletion = true;
+        }
+    }
+    
+    std::string_view top = seq1.substr(0, in_deletion ? mid - 1 : mid);
+    std::string_view bottom = seq1.substr(in_deletion ? mid + 1 : mid);
+    int top_end = in_deletion ? 0 : g;
+    int bottom_start = in_deletion ? 0 : g;
+    auto align_top = [&](auto& out) {
+        myers_miller_append(top, seq2.substr(0, split), scoring, gap_start, top_end, out,
+                            pool ? AlignerContext::local().arena : arena, options, pool);
+        if (in_deletion) {
+            out.push('I', 2);
+        }
+    };
+    auto align_bottom = [&](auto& out) {
+        myers_miller_append(bottom, seq2.substr(split), scoring, bottom_start, gap_end, out,
+                            pool ? AlignerContext::local().arena : arena, options, pool);
+    };
+    
+    if (pool) {
+        // The bottom half's runs (at most one per base) wait in the arena
+        CigarSpan bottom_cigar(arena.allocate<uint32_t>(bottom.length() + (n - split)));
+        pool->fork_join([&] { align_top(cigar); }, [&] { align_bottom(bottom_cigar); });
+        cigar.append(bottom_cigar);
+    } else {
+        align_top(cigar);
+        align_bottom(cigar);
+    }
+}
+
+/**
+ * Myers-Miller alignment of seq1 against seq2 into result; serial
+ * subproblems take their scratch from context's arena, parallel ones run on
+ * its pool. The recursion runs with the shorter sequence second, so its
+ * score rows take O(min(m, n)) memory.
+ */
+template <typename ScoringPolicy>
+void myers_miller_into(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                       const HirschbergOptions& options, AlignerContext& context, AlignmentResult& result) {
+    result.cigar.clear();
+    WorkStealingPool* pool = options.threads == 1 ? nullptr : &context.pool(options.threads);
+    if (seq2.length() > seq1.length()) {
+        // The score rows span the second sequence, so put the shorter one there
+        myers_miller_append(seq2, seq1, transposed(scoring), scoring.gap.open(), scoring.gap.open(),
+                            result.cigar, context.arena, options, pool);
+        result.cigar.transpose();
+    } else {
+        myers_miller_append(seq1, seq2, scoring, scoring.gap.open(), scoring.gap.open(), result.cigar,
+                            context.arena, options, pool);
+    }
+    result.start1 = 0;
+    result.end1 = seq1.length();
+    result.start2 = 0;
+    result.end2 = seq2.length();
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+    
+    // Score the alignment: each run of I or D is one gap
+    result.score = 0;
+    size_t i = 0, j = 0;
+    for (size_t r = 0; r < result.cigar.size(); r++) {
+        uint32_t length = result.cigar.length(r);
+        char op = result.cigar.op(r);
+        if (op == 'M') {
+            for (uint32_t k = 0; k < length; k++) {
+                result.score += scoring(seq1[i + k], seq2[j + k]);
+            }
+            i += length;
+            j += length;
+        } else {
+            result.score += scoring.gap.open() + (int)length * scoring.gap.extend();
+            (op == 'I' ? i : j) += length;
+        }
+    }
+}
+
+/**
+ * Affine-gap global alignment in linear space (Myers & Miller 1988).
+ *
+ * Hirschberg's divide and conquer, with the score passes carrying the
+ * match and deletion states of Gotoh's recurrences, so the split point
+ * may also fall inside a deletion crossing the middle row. Gives the
+ * optimal global score under gaps costing open + k * extend in
+ * O(m * n) time and O(min(m, n)) memory.
+ *
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param scoring Substitution policy and gap model (see scoring.h)
+ * @param options Threads and fork grain (base_cells is not used here)
+ * @return Score and CIGAR of the alignment, viewing seq1 and seq2
+ */
+template <typename ScoringPolicy>
+AlignmentResult myers_miller_cigar(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                                   const HirschbergOptions& options = {}) {
+    AlignmentResult result;
+    myers_miller_into(seq1, seq2, scoring, options, AlignerContext::local(), result);
+    return result;
+}
+
+/**
+ * Myers-Miller alignment reusing context: no heap allocation once the
+ * context (and, when parallel, its pool's threads) has aligned a pair this
+ * large.
+ *
+ * @return context.result, valid until the next alignment with context
+ */
+template <typename ScoringPolicy>
+const AlignmentResult& myers_miller_cigar(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                                          AlignerContext& context, const HirschbergOptions& options = {}) {
+    myers_miller_into(seq1, seq2, scoring, options, context, context.result);
+    return context.result;
+}
+
+/**
+ * Affine-gap global alignment in linear space with match/mismatch scoring.
+ * 
+ * @param match_score Score for matching characters (default: 1)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_open Penalty for opening a gap (default: -3)
+ * @param gap_extend Penalty for each gap character (default: -1)
+ * @param options Threads and fork grain (default: serial)
+ */
+AlignmentResult myers_miller_cigar(const std::string& seq1, const std::string& seq2,
+                                   int match_score = 1,
+                                   int mismatch_penalty = -1,
+                                   int gap_open = -3,
+                                   int gap_extend = -1,
+                                   const HirschbergOptions& options = {});
+
+/**
+ * Affine-gap global alignment in linear space, rendered as aligned strings.
+ */
+Alignment myers_miller(const std::string& seq1, const std::string& seq2,
+                       int match_score = 1,
+                       int mismatch_penalty = -1,
+                       int gap_open = -3,
+                       int gap_extend = -1);
+
+#endif // HIRSCHBERG_H
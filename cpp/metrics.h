@@ -0,0 +1,301 @@
+/**
+ * Pipeline Instrumentation
+ *
+ * Counters and per-stage wall-clock histograms for the hot paths, compiled
+ * in only when ALIGN_METRICS is defined (-DALIGN_METRICS). Without it every
+ * recording call below is an empty inline function and StageTimer an empty
+ * object, so the instrumented code compiles to what it was without them.
+ *
+ * - metrics_count(metric, n) adds n to a counter; hot loops count locally
+ *   and add once per call
+ * - StageTimer measures its lifetime (or until stop()) into the histogram of
+ *   a stage; histogram bucket b counts durations in [2^b, 2^(b+1)) ns, the
+ *   last bucket everything longer
+ * - metrics_snapshot() sums all threads, metrics_json() and
+ *   metrics_prometheus() render a snapshot
+ *
+ * Each thread records into its own shard with relaxed loads and stores (one
+ * writer, so no read-modify-write is needed), and a snapshot may be taken at
+ * any time from any thread. Shards outlive their threads, so nothing
+ * recorded is lost when a worker exits.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef ALIGN_METRICS
+constexpr bool METRICS_ENABLED = true;
+#else
+constexpr bool METRICS_ENABLED = false;
+#endif
+
+enum class Metric {
+    SeedsFound,            // Seeds returned by find_seeds()
+    SeedsFiltered,         // Seeds dropped by find_seeds() with k-mers over max_hits
+    Extensions,            // Seed extensions run (extend_seed(), extend_seed_gapped())
+    ExtensionsXDropped,    // ... that X-drop stopped short of an end of the query (clipped)
+    DPCells,               // DP cells computed by the aligners and the X-drop kernel
+    BackwardSearchSteps,   // FM-index backward (or bidirectional) search steps
+    LFSteps,               // LF steps walked by locate() to reach a suffix array sample
+    COUNT
+};
+
+enum class Stage {
+    Seed,       // Seeding: k-mer lookup and merging, or SMEM search
+    Chain,      // Chaining DP and chain read-back
+    Verify,     // Edit distance verification of one chain
+    Extend,     // Extension of one chain, traceback included
+    Traceback,  // Traceback of one X-drop extension
+    Read,       // Mapping one read, both strands (mapper)
+    COUNT
+};
+
+const size_t METRIC_COUNT = static_cast<size_t>(Metric::COUNT);
+const size_t STAGE_COUNT = static_cast<size_t>(Stage::COUNT);
+const size_t HISTOGRAM_BUCKETS = 40;
+
+inline const char* metric_name(Metric metric) {
+    static const char* const NAMES[METRIC_COUNT] = {
+        "seeds_found", "seeds_filtered", "extensions", "extensions_xdropped",
+        "dp_cells", "backward_search_steps", "lf_steps",
+    };
+    return NAMES[static_cast<size_t>(metric)];
+}
+
+inline const char* stage_name(Stage stage) {
+    static const char* const NAMES[STAGE_COUNT] = {
+        "seed", "chain", "verify", "extend", "traceback", "read",
+    };
+    return NAMES[static_cast<size_t>(stage)];
+}
+
+/**
+ * Totals of all threads at one point in time.
+ */
+struct MetricsSnapshot {
+    struct Histogram {
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        uint64_t buckets[HISTOGRAM_BUCKETS] = {};
+    };
+
+    uint64_t counters[METRIC_COUNT] = {};
+    Histogram stages[STAGE_COUNT];
+
+    uint64_t operator[](Metric metric) const { return counters[static_cast<size_t>(metric)]; }
+    const Histogram& operator[](Stage stage) const { return stages[static_cast<size_t>(stage)]; }
+};
+
+/**
+ * One thread's counters and histograms.
+ */
+struct MetricsShard {
+    struct Histogram {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum_ns{0};
+        std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS] = {};
+    };
+
+    std::atomic<uint64_t> counters[METRIC_COUNT] = {};
+    Histogram stages[STAGE_COUNT];
+
+    // Only the owning thread writes, so a relaxed load and store is a safe add
+    static void add(std::atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * All shards ever created; the calling thread's is created on first use.
+ */
+class MetricsRegistry {
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MetricsShard>> shards;
+
+public:
+    static MetricsRegistry& instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    MetricsShard& local() {
+        thread_local MetricsShard* shard = nullptr;
+        if (!shard) {
+            std::lock_guard<std::mutex> lock(mutex);
+            shards.push_back(std::make_unique<MetricsShard>());
+            shard = shards.back().get();
+        }
+        return *shard;
+    }
+
+    MetricsSnapshot snapshot() {
+        MetricsSnapshot total;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& shard : shards) {
+            for (size_t m = 0; m < METRIC_COUNT; m++) {
+                total.counters[m] += shard->counters[m].load(std::memory_order_relaxed);
+            }
+            for (size_t s = 0; s < STAGE_COUNT; s++) {
+                const MetricsShard::Histogram& from = shard->stages[s];
+                MetricsSnapshot::Histogram& to = total.stages[s];
+                to.count += from.count.load(std::memory_order_relaxed);
+                to.sum_ns += from.sum_ns.load(std::memory_order_relaxed);
+                for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                    to.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+        return total;
+    }
+
+    /**
+     * Zero every shard (e.g. between benchmark runs); counts recorded
+     * concurrently may survive.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& shard : shards) {
+            for (auto& counter : shard->counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            for (auto& stage : shard->stages) {
+                stage.count.store(0, std::memory_order_relaxed);
+                stage.sum_ns.store(0, std::memory_order_relaxed);
+                for (auto& bucket : stage.buckets) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+};
+
+/**
+ * Add n to a counter (no-op unless ALIGN_METRICS is defined).
+ */
+inline void metrics_count(Metric metric, uint64_t n = 1) {
+    if constexpr (METRICS_ENABLED) {
+        MetricsShard::add(MetricsRegistry::instance().local().counters[static_cast<size_t>(metric)], n);
+    }
+}
+
+/**
+ * Record one duration of a stage (no-op unless ALIGN_METRICS is defined).
+ */
+inline void metrics_record(Stage stage, uint64_t ns) {
+    if constexpr (METRICS_ENABLED) {
+        MetricsShard::Histogram& histogram = MetricsRegistry::instance().local().stages[static_cast<size_t>(stage)];
+        size_t bucket = ns > 1 ? 63 - __builtin_clzll(ns) : 0;
+        MetricsShard::add(histogram.count, 1);
+        MetricsShard::add(histogram.sum_ns, ns);
+        MetricsShard::add(histogram.buckets[bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1], 1);
+    }
+}
+
+/**
+ * Times a stage from construction until stop() or destruction.
+ */
+class StageTimer {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Stage stage;
+    Clock::time_point start;
+    bool running = true;
+
+public:
+    explicit StageTimer(Stage stage) : stage(stage) {
+        if constexpr (METRICS_ENABLED) {
+            start = Clock::now();
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    ~StageTimer() { stop(); }
+
+    void stop() {
+        if constexpr (METRICS_ENABLED) {
+            if (running) {
+                running = false;
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+                metrics_record(stage, elapsed.count());
+            }
+        }
+    }
+};
+
+inline MetricsSnapshot metrics_snapshot() {
+    return MetricsRegistry::instance().snapshot();
+}
+
+inline void metrics_reset() {
+    MetricsRegistry::instance().reset();
+}
+
+/**
+ * JSON object of a snapshot: counters by name, and per stage the number of
+ * timings, their sum and the histogram buckets (see above) in nanoseconds.
+ */
+inline std::string metrics_json(const MetricsSnapshot& snapshot = metrics_snapshot()) {
+    std::ostringstream out;
+    out << "{\n  \"enabled\": " << (METRICS_ENABLED ? "true" : "false") << ",\n  \"counters\": {";
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        out << (m ? ",\n" : "\n") << "    \"" << metric_name(static_cast<Metric>(m)) << "\": "
+            << snapshot.counters[m];
+    }
+    out << "\n  },\n  \"stages\": {";
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        const MetricsSnapshot::Histogram& histogram = snapshot.stages[s];
+        out << (s ? ",\n" : "\n") << "    \"" << stage_name(static_cast<Stage>(s)) << "\": {\"count\": "
+            << histogram.count << ", \"sum_ns\": " << histogram.sum_ns << ", \"buckets_ns\": [";
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            out << (b ? ", " : "") << histogram.buckets[b];
+        }
+        out << "]}";
+    }
+    out << "\n  }\n}\n";
+    return out.str();
+}
+
+/**
+ * Prometheus text exposition of a snapshot: one align_<name>_total counter
+ * per metric and the align_stage_seconds histogram labelled by stage.
+ */
+inline std::string metrics_prometheus(const MetricsSnapshot& snapshot = metrics_snapshot()) {
+    std::ostringstream out;
+    for (size_t m = 0; m < METRIC_COUNT; m++) {
+        const char* name = metric_name(static_cast<Metric>(m));
+        out << "# TYPE align_" << name << "_total counter\n"
+            << "align_" << name << "_total " << snapshot.counters[m] << '\n';
+    }
+    out << "# HELP align_stage_seconds Wall-clock time per invocation of a pipeline stage\n"
+        << "# TYPE align_stage_seconds histogram\n";
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        const MetricsSnapshot::Histogram& histogram = snapshot.stages[s];
+        const char* name = stage_name(static_cast<Stage>(s));
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b + 1 < HISTOGRAM_BUCKETS; b++) {
+            cumulative += histogram.buckets[b];
+            out << "align_stage_seconds_bucket{stage=\"" << name << "\",le=\""
+                << double(uint64_t(1) << (b + 1)) * 1e-9 << "\"} " << cumulative << '\n';
+        }
+        out << "align_stage_seconds_bucket{stage=\"" << name << "\",le=\"+Inf\"} " << histogram.count << '\n'
+            << "align_stage_seconds_sum{stage=\"" << name << "\"} " << histogram.sum_ns * 1e-9 << '\n'
+            << "align_stage_seconds_count{stage=\"" << name << "\"} " << histogram.count << '\n';
+    }
+    return out.str();
+}
+
+#endif // METRICS_H
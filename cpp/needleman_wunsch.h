@@ -0,0 +1,420 @@
+/**
+ * Needleman-Wunsch Algorithm for Global Sequence Alignment
+ * 
+ * This is a dynamic programming algorithm for aligning two sequences globally.
+ * It finds the optimal alignment between two sequences by maximizing the alignment score.
+ * 
+ * Time Complexity: O(m * n) where m and n are the lengths of the sequences
+ * Space Complexity: O(m * n) bits: 2 bits of traceback per cell plus two score rows
+ */
+
+#ifndef NEEDLEMAN_WUNSCH_H
+#define NEEDLEMAN_WUNSCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <algorithm>
+#include <limits>
+
+#include "aligner_context.h"
+#include "dp_matrix.h"
+#include "cigar.h"
+#include "metrics.h"
+#include "scoring.h"
+
+/**
+ * Needleman-Wunsch alignment of seq1 against seq2 into result, with all
+ * scratch memory taken from arena.
+ */
+template <typename ScoringPolicy>
+void needleman_wunsch_into(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                           ScratchArena& arena, AlignmentResult& result) {
+    static_assert(ScoringPolicy::gap_type::linear, "needleman_wunsch takes a linear gap model");
+    int m = seq1.length();
+    int n = seq2.length();
+    const int gap_penalty = scoring.gap.extend();
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    metrics_count(Metric::DPCells, uint64_t(m) * n);
+    
+    // Two rows of scores; the move that produced each cell is kept as a 2-bit code
+    enum { DIAG = 0, UP = 1, LEFT = 2 };
+    int* prev_row = arena.allocate<int>(n + 1);
+    int* curr_row = arena.allocate<int>(n + 1);
+    TracebackMatrix<2> trace(m + 1, n + 1, arena);
+    
+    // Initialize first row with gap penalties
+    for (int j = 0; j <= n; j++) {
+        prev_row[j] = j * gap_penalty;
+        trace.set(0, j, LEFT);
+    }
+    
+    // Fill DP matrix
+    for (int i = 1; i <= m; i++) {
+        curr_row[0] = i * gap_penalty;
+        trace.set(i, 0, UP);
+        auto substitution = profile.row(seq1[i-1]);
+        
+        for (int j = 1; j <= n; j++) {
+            int match = prev_row[j-1] + substitution[j-1];
+            int del = prev_row[j] + gap_penalty;
+            int insert = curr_row[j-1] + gap_penalty;
+            
+            // Prefer diagonal, then deletion, then insertion on ties
+            int best = std::max({match, del, insert});
+            curr_row[j] = best;
+            trace.set(i, j, best == match ? DIAG : best == del ? UP : LEFT);
+        }
+        
+        std::swap(prev_row, curr_row);
+    }
+    
+    // Traceback to find alignment, following the recorded moves
+    result.cigar.clear();
+    int i = m, j = n;
+    
+    while (i > 0 || j > 0) {
+        uint8_t move = trace.get(i, j);
+        if (move == DIAG) {
+            result.cigar.push('M');
+            i--;
+            j--;
+        } else if (move == UP) {
+            result.cigar.push('I');
+            i--;
+        } else {
+            result.cigar.push('D');
+            j--;
+        }
+    }
+    result.cigar.reverse();
+    
+    result.score = prev_row[n];
+    result.start1 = 0;
+    result.end1 = m;
+    result.start2 = 0;
+    result.end2 = n;
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+}
+
+/**
+ * Perform global sequence alignment using Needleman-Wunsch algorithm.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param scoring Substitution policy and linear gap model (see scoring.h)
+ * @return Score and CIGAR of the alignment, viewing seq1 and seq2
+ */
+template <typename ScoringPolicy>
+AlignmentResult needleman_wunsch_cigar(const std::string& seq1, const std::string& seq2,
+                                       const ScoringPolicy& scoring) {
+    AlignmentResult result;
+    needleman_wunsch_into(seq1, seq2, scoring, AlignerContext::local().arena, result);
+    return result;
+}
+
+/**
+ * Needleman-Wunsch alignment reusing context: no heap allocation once the
+ * context has aligned a pair this large.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+template <typename ScoringPolicy>
+const AlignmentResult& needleman_wunsch_cigar(const std::string& seq1, const std::string& seq2,
+                                              const ScoringPolicy& scoring, AlignerContext& context) {
+    needleman_wunsch_into(seq1, seq2, scoring, context.arena, context.result);
+    return context.result;
+}
+
+/**
+ * Perform global sequence alignment using Needleman-Wunsch algorithm.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param match_score Score for matching characters (default: 1)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_penalty Penalty for gaps (default: -1)
+ * @return Score and CIGAR of the alignment, viewing seq1 and seq2
+ */
+AlignmentResult needleman_wunsch_cigar(const std::string& seq1, const std::string& seq2, 
+                                       int match_score = 1, 
+                                       int mismatch_penalty = -1, 
+                                       int gap_penalty = -1);
+
+/**
+ * Needleman-Wunsch alignment with match/mismatch scoring, reusing context.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+const AlignmentResult& needleman_wunsch_cigar(const std::string& seq1, const std::string& seq2,
+                                              AlignerContext& context,
+                                              int match_score = 1,
+                                              int mismatch_penalty = -1,
+                                              int gap_penalty = -1);
+
+/**
+ * Perform global sequence alignment using Needleman-Wunsch algorithm.
+ * 
+ * @return Alignment structure containing aligned sequences and score
+ */
+Alignment needleman_wunsch(const std::string& seq1, const std::string& seq2, 
+                          int match_score = 1, 
+                          int mismatch_penalty = -1, 
+                          int gap_penalty = -1);
+
+/**
+ * Global alignment of long sequence pairs on all cores.
+ *
+ * The matrix is filled in tiles of tile x tile cells, one anti-diagonal of
+ * tiles at a time in parallel, each tile swept along its own anti-diagonals
+ * with SIMD (see wavefront.h). The result is identical to
+ * needleman_wunsch_cigar(); the traceback still keeps 2 bits per cell, so for
+ * pairs whose matrix does not fit in memory use hirschberg_cigar() instead,
+ * whose score passes use the same fill.
+ *
+ * @param threads Worker threads (0 = all cores)
+ * @param tile Tile edge in cells; 256 keeps a tile's working set in L1/L2
+ * @return Score and CIGAR of the alignment, viewing seq1 and seq2
+ */
+AlignmentResult needleman_wunsch_wavefront(const std::string& seq1, const std::string& seq2,
+                                           int match_score = 1,
+                                           int mismatch_penalty = -1,
+                                           int gap_penalty = -1,
+                                           size_t threads = 0,
+                                           int tile = 256);
+
+/**
+ * Wavefront global alignment reusing context and its pool: no heap
+ * allocation once the context and the pool's threads have aligned a pair
+ * this large.
+ *
+ * @return context.result, valid until the next alignment with context
+ */
+const AlignmentResult& needleman_wunsch_wavefront(const std::string& seq1, const std::string& seq2,
+                                                  AlignerContext& context,
+                                                  int match_score = 1,
+                                                  int mismatch_penalty = -1,
+                                                  int gap_penalty = -1,
+                                                  size_t threads = 0,
+                                                  int tile = 256);
+
+/**
+ * Result of a banded global alignment: score and CIGAR as for the other
+ * aligners, viewing seq1 and seq2.
+ *
+ * band_edge_hit is true when the traceback passed through a cell on the edge of
+ * a band that actually cut the matrix; a wider band might then score higher.
+ */
+struct BandedAlignmentResult : AlignmentResult {
+    bool band_edge_hit = false;
+};
+
+/**
+ * A banded global alignment rendered as two gapped rows.
+ */
+struct BandedAlignment {
+    std::string aligned_seq1;
+    std::string aligned_seq2;
+    int score;
+    bool band_edge_hit;
+};
+
+/**
+ * Banded Needleman-Wunsch alignment of seq1 against seq2 into result, with
+ * all scratch memory taken from arena.
+ * 
+ * Only cells with lo <= j - i <= hi are computed, where the band extends
+ * band_width diagonals beyond both corners of the matrix:
+ * lo = min(0, n - m) - band_width and hi = max(0, n - m) + band_width.
+ * Time is O((|m - n| + band_width) * m); the band keeps 2 bits of traceback
+ * per cell plus two rows of scores. A negative band_width means no band,
+ * as in hirschberg(): the whole matrix is filled.
+ * 
+ * @return Whether the alignment touched the band edge (see BandedAlignmentResult)
+ */
+template <typename ScoringPolicy>
+bool needleman_wunsch_banded_into(const std::string& seq1, const std::string& seq2, int band_width,
+                                  const ScoringPolicy& scoring, ScratchArena& arena, AlignmentResult& result) {
+    static_assert(ScoringPolicy::gap_type::linear, "needleman_wunsch takes a linear gap model");
+    int m = seq1.length();
+    int n = seq2.length();
+    const int gap_penalty = scoring.gap.extend();
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    
+    if (band_width < 0 || band_width > std::max(m, n)) {
+        band_width = std::max(m, n);
+    }
+    int lo = std::max(std::min(0, n - m) - band_width, -m);
+    int hi = std::min(std::max(0, n - m) + band_width, n);
+    int width = hi - lo + 1;
+    
+    const int NEG_INF = std::numeric_limits<int>::min() / 2;
+    
+    // Row i of the band holds columns j = i + lo ... i + hi at k = j - i - lo, so
+    // cell (i-1, j-1) is at k and (i-1, j) at k+1 of the row above; the extra
+    // last entry of each row stays NEG_INF
+    enum { DIAG = 0, UP = 1, LEFT = 2 };
+    int* prev_row = arena.allocate<int>(width + 1);
+    int* curr_row = arena.allocate<int>(width + 1);
+    TracebackMatrix<2> trace(m + 1, width, arena);
+    std::fill(prev_row, prev_row + width + 1, NEG_INF);
+    
+    // Fill the band
+    uint64_t cells = 0;
+    for (int i = 0; i <= m; i++) {
+        int j_begin = std::max(0, i + lo);
+        int j_end = std::min(n, i + hi);
+        cells += std::max(0, j_end - j_begin + 1);
+        std::fill(curr_row, curr_row + width + 1, NEG_INF);
+        for (int j = j_begin; j <= j_end; j++) {
+            int k = j - i - lo;
+            if (i == 0) {
+                curr_row[k] = j * gap_penalty;
+                trace.set(i, k, LEFT);
+            } else if (j == 0) {
+                curr_row[k] = i * gap_penalty;
+                trace.set(i, k, UP);
+            } else {
+                int match = prev_row[k] + profile.row(seq1[i-1])[j-1];
+                int del = prev_row[k + 1] + gap_penalty;
+                int insert = (k > 0 ? curr_row[k - 1] : NEG_INF) + gap_penalty;
+                
+                // Same preference order as needleman_wunsch(): diagonal, deletion, insertion
+                int best = std::max({match, del, insert});
+                curr_row[k] = best;
+                trace.set(i, k, best == match ? DIAG : best == del ? UP : LEFT);
+            }
+        }
+        std::swap(prev_row, curr_row);
+    }
+    metrics_count(Metric::DPCells, cells);
+    
+    // Traceback, following the recorded moves
+    result.cigar.clear();
+    bool edge_hit = false;
+    int i = m, j = n;
+    
+    while (i > 0 || j > 0) {
+        if ((j - i == lo && lo > -m) || (j - i == hi && hi < n)) {
+            edge_hit = true;
+        }
+        
+        uint8_t move = trace.get(i, j - i - lo);
+        if (move == DIAG) {
+            result.cigar.push('M');
+            i--;
+            j--;
+        } else if (move == UP) {
+            result.cigar.push('I');
+            i--;
+        } else {
+            result.cigar.push('D');
+            j--;
+        }
+    }
+    result.cigar.reverse();
+    
+    result.score = prev_row[n - m - lo];
+    result.start1 = 0;
+    result.end1 = m;
+    result.start2 = 0;
+    result.end2 = n;
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+    return edge_hit;
+}
+
+/**
+ * Perform banded global alignment (Needleman-Wunsch restricted to a diagonal
+ * band; see needleman_wunsch_banded_into()).
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param band_width Extra diagonals on each side of the corner-to-corner band; negative for no band
+ * @param scoring Substitution policy and linear gap model (see scoring.h)
+ * @return Best alignment within the band, viewing seq1 and seq2, and whether it touched the band edge
+ */
+template <typename ScoringPolicy>
+BandedAlignmentResult needleman_wunsch_banded_cigar(const std::string& seq1, const std::string& seq2,
+                                                    int band_width, const ScoringPolicy& scoring) {
+    BandedAlignmentResult result;
+    result.band_edge_hit = needleman_wunsch_banded_into(seq1, seq2, band_width, scoring,
+                                                        AlignerContext::local().arena, result);
+    return result;
+}
+
+/**
+ * Banded Needleman-Wunsch alignment reusing context: no heap allocation once
+ * the context has aligned a pair this large.
+ * 
+ * @param band_edge_hit If given, receives whether the alignment touched the band edge
+ * @return context.result, valid until the next alignment with context
+ */
+template <typename ScoringPolicy>
+const AlignmentResult& needleman_wunsch_banded_cigar(const std::string& seq1, const std::string& seq2,
+                                                     int band_width, const ScoringPolicy& scoring,
+                                                     AlignerContext& context, bool* band_edge_hit = nullptr) {
+    bool edge_hit = needleman_wunsch_banded_into(seq1, seq2, band_width, scoring, context.arena, context.result);
+    if (band_edge_hit) {
+        *band_edge_hit = edge_hit;
+    }
+    return context.result;
+}
+
+/**
+ * Perform banded global alignment with match/mismatch scoring and a linear gap.
+ * 
+ * @param band_width Extra diagonals on each side of the corner-to-corner band; negative for no band
+ * @param match_score Score for matching characters (default: 1)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_penalty Penalty for gaps (default: -1)
+ * @return Best alignment within the band, viewing seq1 and seq2, and whether it touched the band edge
+ */
+BandedAlignmentResult needleman_wunsch_banded_cigar(const std::string& seq1, const std::string& seq2,
+                                                    int band_width,
+                                                    int match_score = 1,
+                                                    int mismatch_penalty = -1,
+                                                    int gap_penalty = -1);
+
+/**
+ * Banded Needleman-Wunsch alignment with match/mismatch scoring, reusing
+ * context.
+ * 
+ * @param band_edge_hit If given, receives whether the alignment touched the band edge
+ * @return context.result, valid until the next alignment with context
+ */
+const AlignmentResult& needleman_wunsch_banded_cigar(const std::string& seq1, const std::string& seq2,
+                                                     int band_width,
+                                                     AlignerContext& context,
+                                                     int match_score = 1,
+                                                     int mismatch_penalty = -1,
+                                                     int gap_penalty = -1,
+                                                     bool* band_edge_hit = nullptr);
+
+/**
+ * Perform banded global alignment, rendered as aligned strings.
+ * 
+ * @return Best alignment within the band, and whether it touched the band edge
+ */
+template <typename ScoringPolicy>
+BandedAlignment needleman_wunsch_banded(const std::string& seq1, const std::string& seq2,
+                                        int band_width, const ScoringPolicy& scoring) {
+    BandedAlignmentResult result = needleman_wunsch_banded_cigar(seq1, seq2, band_width, scoring);
+    auto rows = result.render();
+    return {rows.first, rows.second, result.score, result.band_edge_hit};
+}
+
+/**
+ * Perform banded global alignment with match/mismatch scoring and a linear
+ * gap, rendered as aligned strings.
+ */
+BandedAlignment needleman_wunsch_banded(const std::string& seq1, const std::string& seq2,
+                                        int band_width,
+                                        int match_score = 1,
+                                        int mismatch_penalty = -1,
+                                        int gap_penalty = -1);
+
+#endif // NEEDLEMAN_WUNSCH_H
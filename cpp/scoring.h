@@ -0,0 +1,378 @@
+/**
+ * Scoring Policies
+ *
+ * A Scoring<Substitution, Gap> bundles how two residues score against each
+ * other with how gaps are penalized. The aligners take it as a template
+ * parameter, so each scheme gets its own compiled inner loop:
+ * - MatchMismatch and LinearGap / AffineGap carry their values at run time;
+ *   FixedMatchMismatch<M, X>, FixedLinearGap<G> and FixedAffineGap<O, E> make
+ *   them compile-time constants the optimizer folds into the loop
+ * - SubstitutionMatrix holds a residue x residue table: BLOSUM62 and PAM250
+ *   for proteins, or a DNA matrix scoring transitions apart from transversions
+ *
+ * A gap of length k costs open() + k * extend(); a linear gap has open() == 0.
+ *
+ * QueryProfile turns the substitution lookup into one table load: for each
+ * residue c of the outer sequence it precomputes row(c)[j] = score(c, inner[j])
+ * over the inner sequence, so the inner DP loop reads row[j - 1] instead of
+ * branching on a comparison or indexing a matrix by two residues. For
+ * match/mismatch policies the "row" is just the comparison, which already
+ * compiles to a conditional move, so nothing is stored.
+ */
+
+#ifndef SCORING_H
+#define SCORING_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "dp_matrix.h"
+
+/**
+ * Match/mismatch scoring with run-time values.
+ */
+struct MatchMismatch {
+    int match = 1;
+    int mismatch = -1;
+
+    constexpr int operator()(char a, char b) const { return a == b ? match : mismatch; }
+};
+
+/**
+ * Match/mismatch scoring with compile-time values.
+ */
+template <int MATCH, int MISMATCH>
+struct FixedMatchMismatch {
+    static constexpr int match = MATCH;
+    static constexpr int mismatch = MISMATCH;
+
+    constexpr int operator()(char a, char b) const { return a == b ? MATCH : MISMATCH; }
+};
+
+template <typename Substitution>
+struct is_match_mismatch : std::false_type {};
+template <>
+struct is_match_mismatch<MatchMismatch> : std::true_type {};
+template <int MATCH, int MISMATCH>
+struct is_match_mismatch<FixedMatchMismatch<MATCH, MISMATCH>> : std::true_type {};
+
+/**
+ * Residue x residue substitution scores over an alphabet of up to 32 symbols.
+ *
+ * Lower-case residues score like upper-case ones; residues outside the
+ * alphabet score as its wildcard symbol (the last one, e.g. 'X' or 'N').
+ */
+class SubstitutionMatrix {
+private:
+    static constexpr int STRIDE = 32;
+    std::array<uint8_t, 256> codes{};
+    std::array<int, STRIDE * STRIDE> scores{};
+    std::string alphabet;
+
+public:
+    /**
+     * Build from an alphabet and its row-major size x size score table.
+     *
+     * @throws invalid_argument if the sizes disagree or the alphabet is too large
+     */
+    SubstitutionMatrix(std::string_view alphabet, const std::vector<int>& table)
+        : alphabet(alphabet) {
+        size_t size = alphabet.size();
+        if (size == 0 || size > STRIDE || table.size() != size * size) {
+            throw std::invalid_argument("SubstitutionMatrix: table does not match alphabet");
+        }
+        codes.fill(size - 1);
+        for (size_t k = 0; k < size; k++) {
+            unsigned char c = alphabet[k];
+            codes[c] = k;
+            if (c >= 'A' && c <= 'Z') {
+                codes[c + ('a' - 'A')] = k;
+            }
+        }
+        for (size_t a = 0; a < size; a++) {
+            for (size_t b = 0; b < size; b++) {
+                scores[a * STRIDE + b] = table[a * size + b];
+            }
+        }
+    }
+
+    int operator()(char a, char b) const {
+        return scores[codes[static_cast<unsigned char>(a)] * STRIDE + codes[static_cast<unsigned char>(b)]];
+    }
+
+    const std::string& symbols() const { return alphabet; }
+
+    /**
+     * Nucleotide scores: match, transitions (A <-> G, C <-> T) and
+     * transversions scored apart; U reads as T and anything else as N.
+     */
+    static SubstitutionMatrix dna(int match = 1, int transition = -1, int transversion = -2,
+                                  int unknown = -1) {
+        const char* bases = "ACGTN";
+        std::vector<int> table(25);
+        for (int a = 0; a < 5; a++) {
+            for (int b = 0; b < 5; b++) {
+                bool purines = (a == 0 || a == 2) && (b == 0 || b == 2);
+                bool pyrimidines = (a == 1 || a == 3) && (b == 1 || b == 3);
+                table[a * 5 + b] = a == 4 || b == 4 ? unknown
+                                   : a == b ? match
+                                   : purines || pyrimidines ? transition : transversion;
+            }
+        }
+        SubstitutionMatrix matrix(bases, table);
+        matrix.codes['U'] = matrix.codes['u'] = 3;
+        return matrix;
+    }
+
+    /**
+     * BLOSUM62 (Henikoff & Henikoff 1992), the NCBI table.
+     */
+    static const SubstitutionMatrix& blosum62() {
+        static const SubstitutionMatrix matrix("ARNDCQEGHILKMFPSTWYVBZ*X", reorder({
+        //   A   R   N   D   C   Q   E   G   H   I   L   K   M   F   P   S   T   W   Y   V   B   Z   X   *
+             4, -1, -2, -2,  0, -1, -1,  0, -2, -1, -1, -1, -1, -2, -1,  1,  0, -3, -2,  0, -2, -1,  0, -4,
+            -1,  5,  0, -2, -3,  1,  0, -2,  0, -3, -2,  2, -1, -3, -2, -1, -1, -3, -2, -3, -1,  0, -1, -4,
+            -2,  0,  6,  1, -3,  0,  0,  0,  1, -3, -3,  0, -2, -3, -2,  1,  0, -4, -2, -3,  3,  0, -1, -4,
+            -2, -2,  1,  6, -3,  0,  2, -1, -1, -3, -4, -1, -3, -3, -1,  0, -1, -4, -3, -3,  4,  1, -1, -4,
+             0, -3, -3, -3,  9, -3, -4, -3, -3, -1, -1, -3, -1, -2, -3, -1, -1, -2, -2, -1, -3, -3, -2, -4,
+            -1,  1,  0,  0, -3,  5,  2, -2,  0, -3, -2,  1,  0, -3, -1,  0, -1, -2, -1, -2,  0,  3, -1, -4,
+            -1,  0,  0,  2, -4,  2,  5, -2,  0, -3, -3,  1, -2, -3, -1,  0, -1, -3, -2, -2,  1,  4, -1, -4,
+             0, -2,  0, -1, -3, -2, -2,  6, -2, -4, -4, -2, -3, -3, -2,  0, -2, -2, -3, -3, -1, -2, -1, -4,
+            -2,  0,  1, -1, -3,  0,  0, -2,  8, -3, -3, -1, -2, -1, -2, -1, -2, -2,  2, -3,  0,  0, -1, -4,
+            -1, -3, -3, -3, -1, -3, -3, -4, -3,  4,  2, -3,  1,  0, -3, -2, -1, -3, -1,  3, -3, -3, -1, -4,
+            -1, -2, -3, -4, -1, -2, -3, -4, -3,  2,  4, -2,  2,  0, -3, -2, -1, -2, -1,  1, -4, -3, -1, -4,
+            -1,  2,  0, -1, -3,  1,  1, -2, -1, -3, -2,  5, -1, -3, -1,  0, -1, -3, -2, -2,  0,  1, -1, -4,
+            -1, -1, -2, -3, -1,  0, -2, -3, -2,  1,  2, -1,  5,  0, -2, -1, -1, -1, -1,  1, -3, -1, -1, -4,
+            -2, -3, -3, -3, -2, -3, -3, -3, -1,  0,  0, -3,  0,  6, -4, -2, -2,  1,  3, -1, -3, -3, -1, -4,
+            -1, -2, -2, -1, -3, -1, -1, -2, -2, -3, -3, -1, -2, -4,  7, -1, -1, -4, -3, -2, -2, -1, -2, -4,
+             1, -1,  1,  0, -1,  0,  0,  0, -1, -2, -2,  0, -1, -2, -1,  4,  1, -3, -2, -2,  0,  0,  0, -4,
+             0, -1,  0, -1, -1, -1, -1, -2, -2, -1, -1, -1, -1, -2, -1,  1,  5, -2, -2,  0, -1, -1,  0, -4,
+            -3, -3, -4, -4, -2, -2, -3, -2, -2, -3, -2, -3, -1,  1, -4, -3, -2, 11,  2, -3, -4, -3, -2, -4,
+            -2, -2, -2, -3, -2, -1, -2, -3,  2, -1, -1, -2, -1,  3, -3, -2, -2,  2,  7, -1, -3, -2, -1, -4,
+             0, -3, -3, -3, -1, -2, -2, -3, -3,  3,  1, -2,  1, -1, -2, -2,  0, -3, -1,  4, -3, -2, -1, -4,
+            -2, -1,  3,  4, -3,  0,  1, -1,  0, -3, -4,  0, -3, -3, -2,  0, -1, -4, -3, -3,  4,  1, -1, -4,
+            -1,  0,  0,  1, -3,  3,  4, -2,  0, -3, -3,  1, -1, -3, -1,  0, -1, -3, -2, -2,  1,  4, -1, -4,
+             0, -1, -1, -1, -2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -2,  0,  0, -2, -1, -1, -1, -1, -1, -4,
+            -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4,  1,
+        }));
+        return matrix;
+    }
+
+    /**
+     * PAM250 (Dayhoff et al. 1978), the NCBI table.
+     */
+    static const SubstitutionMatrix& pam250() {
+        static const SubstitutionMatrix matrix("ARNDCQEGHILKMFPSTWYVBZ*X", reorder({
+        //   A   R   N   D   C   Q   E   G   H   I   L   K   M   F   P   S   T   W   Y   V   B   Z   X   *
+             2, -2,  0,  0, -2,  0,  0,  1, -1, -1, -2, -1, -1, -3,  1,  1,  1, -6, -3,  0,  0,  0,  0, -8,
+            -2,  6,  0, -1, -4,  1, -1, -3,  2, -2, -3,  3,  0, -4,  0,  0, -1,  2, -4, -2, -1,  0, -1, -8,
+             0,  0,  2,  2, -4,  1,  1,  0,  2, -2, -3,  1, -2, -3,  0,  1,  0, -4, -2, -2,  2,  1,  0, -8,
+             0, -1,  2,  4, -5,  2,  3,  1,  1, -2, -4,  0, -3, -6, -1,  0,  0, -7, -4, -2,  3,  3, -1, -8,
+            -2, -4, -4, -5, 12, -5, -5, -3, -3, -2, -6, -5, -5, -4, -3,  0, -2, -8,  0, -2, -4, -5, -3, -8,
+             0,  1,  1,  2, -5,  4,  2, -1,  3, -2, -2,  1, -1, -5,  0, -1, -1, -5, -4, -2,  1,  3, -1, -8,
+             0, -1,  1,  3, -5,  2,  4,  0,  1, -2, -3,  0, -2, -5, -1,  0,  0, -7, -4, -2,  3,  3, -1, -8,
+             1, -3,  0,  1, -3, -1,  0,  5, -2, -3, -4, -2, -3, -5,  0,  1,  0, -7, -5, -1,  0,  0, -1, -8,
+            -1,  2,  2,  1, -3,  3,  1, -2,  6, -2, -2,  0, -2, -2,  0, -1, -1, -3,  0, -2,  1,  2, -1, -8,
+            -1, -2, -2, -2, -2, -2, -2, -3, -2,  5,  2, -2,  2,  1, -2, -1,  0, -5, -1,  4, -2, -2, -1, -8,
+            -2, -3, -3, -4, -6, -2, -3, -4, -2,  2,  6, -3,  4,  2, -3, -3, -2, -2, -1,  2, -3, -3, -1, -8,
+            -1,  3,  1,  0, -5,  1,  0, -2,  0, -2, -3,  5,  0, -5, -1,  0,  0, -3, -4, -2,  1,  0, -1, -8,
+            -1,  0, -2, -3, -5, -1, -2, -3, -2,  2,  4,  0,  6,  0, -2, -2, -1, -4, -2,  2, -2, -2, -1, -8,
+            -3, -4, -3, -6, -4, -5, -5, -5, -2,  1,  2, -5,  0,  9, -5, -3, -3,  0,  7, -1, -4, -5, -2, -8,
+             1,  0,  0, -1, -3,  0, -1,  0,  0, -2, -3, -1, -2, -5,  6,  1,  0, -6, -5, -1, -1,  0, -1, -8,
+             1,  0,  1,  0,  0, -1,  0,  1, -1, -1, -3,  0, -2, -3,  1,  2,  1, -2, -3, -1,  0,  0,  0, -8,
+             1, -1,  0,  0, -2, -1,  0,  0, -1,  0, -2,  0, -1, -3,  0,  1,  3, -5, -3,  0,  0, -1,  0, -8,
+            -6,  2, -4, -7, -8, -5, -7, -7, -3, -5, -2, -3, -4,  0, -6, -2, -5, 17,  0, -6, -5, -6, -4, -8,
+            -3, -4, -2, -4,  0, -4, -4, -5,  0, -1, -1, -4, -2,  7, -5, -3, -3,  0, 10, -2, -3, -4, -2, -8,
+             0, -2, -2, -2, -2, -2, -2, -1, -2,  4,  2, -2,  2, -1, -1, -1,  0, -6, -2,  4, -2, -2, -1, -8,
+             0, -1,  2,  3, -4,  1,  3,  0,  1, -2, -3,  1, -2, -4, -1,  0,  0, -5, -3, -2,  3,  2, -1, -8,
+             0,  0,  1,  3, -5,  3,  3,  0,  2, -2, -3,  0, -2, -5,  0,  0, -1, -6, -4, -2,  2,  3, -1, -8,
+             0, -1,  0, -1, -3, -1, -1, -1, -1, -1, -1, -1, -1, -2, -1,  0,  0, -4, -2, -1, -1, -1, -1, -8,
+            -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8,  1,
+        }));
+        return matrix;
+    }
+
+private:
+    /**
+     * Swap the last two symbols of an NCBI-ordered 24 x 24 table (..., X, *),
+     * so that the wildcard X comes last.
+     */
+    static std::vector<int> reorder(std::vector<int> table) {
+        const int n = 24;
+        for (int r = 0; r < n; r++) {
+            std::swap(table[r * n + n - 2], table[r * n + n - 1]);
+        }
+        for (int c = 0; c < n; c++) {
+            std::swap(table[(n - 2) * n + c], table[(n - 1) * n + c]);
+        }
+        return table;
+    }
+};
+
+/**
+ * Linear gap penalty with a run-time value.
+ */
+struct LinearGap {
+    static constexpr bool linear = true;
+    int gap = -1;
+
+    constexpr int open() const { return 0; }
+    constexpr int extend() const { return gap; }
+};
+
+/**
+ * Linear gap penalty with a compile-time value.
+ */
+template <int GAP>
+struct FixedLinearGap {
+    static constexpr bool linear = true;
+
+    static constexpr int open() { return 0; }
+    static constexpr int extend() { return GAP; }
+};
+
+/**
+ * Affine gap penalty with run-time values: open_penalty + k * extend_penalty.
+ */
+struct AffineGap {
+    static constexpr bool linear = false;
+    int open_penalty = -3;
+    int extend_penalty = -1;
+
+    constexpr int open() const { return open_penalty; }
+    constexpr int extend() const { return extend_penalty; }
+};
+
+/**
+ * Affine gap penalty with compile-time values: OPEN + k * EXTEND.
+ */
+template <int OPEN, int EXTEND>
+struct FixedAffineGap {
+    static constexpr bool linear = false;
+
+    static constexpr int open() { return OPEN; }
+    static constexpr int extend() { return EXTEND; }
+};
+
+/**
+ * Substitution scores of every residue of an outer sequence against each
+ * position of an inner sequence: row(c)[j] == substitution(c, inner[j]).
+ *
+ * The table is taken from a scratch arena and lives until the arena is
+ * rewound past it, so an aligner builds its profile inside its own scope.
+ */
+template <typename Substitution, bool = is_match_mismatch<Substitution>::value>
+class QueryProfile {
+private:
+    std::array<int, 256> offsets;  // Start of each residue's row, -1 if absent
+    int* rows;
+
+public:
+    QueryProfile(const Substitution& substitution, std::string_view inner, std::string_view outer,
+                 ScratchArena& arena) {
+        offsets.fill(-1);
+        size_t residues = 0;
+        for (char c : outer) {
+            int& offset = offsets[static_cast<unsigned char>(c)];
+            if (offset < 0) {
+                offset = residues++ * inner.length();
+            }
+        }
+        rows = arena.allocate<int>(residues * inner.length());
+        for (int c = 0; c < 256; c++) {
+            if (offsets[c] >= 0) {
+                int* row = rows + offsets[c];
+                for (size_t j = 0; j < inner.length(); j++) {
+                    row[j] = substitution(static_cast<char>(c), inner[j]);
+                }
+            }
+        }
+    }
+
+    /**
+     * Row of residue c, which must occur in the outer sequence.
+     */
+    const int* row(char c) const { return rows + offsets[static_cast<unsigned char>(c)]; }
+};
+
+/**
+ * Match/mismatch policies compare directly; branch-free already, so no table.
+ */
+template <typename Substitution>
+class QueryProfile<Substitution, true> {
+private:
+    Substitution substitution;
+    std::string_view inner;
+
+public:
+    struct Row {
+        const Substitution& substitution;
+        char c;
+        const char* inner;
+
+        int operator[](size_t j) const { return substitution(c, inner[j]); }
+    };
+
+    QueryProfile(const Substitution& substitution, std::string_view inner, std::string_view, ScratchArena&)
+        : substitution(substitution), inner(inner) {}
+
+    Row row(char c) const { return {substitution, c, inner.data()}; }
+};
+
+/**
+ * A substitution policy together with a gap policy.
+ */
+template <typename Substitution = MatchMismatch, typename Gap = LinearGap>
+struct Scoring {
+    typedef Substitution substitution_type;
+    typedef Gap gap_type;
+
+    Substitution substitution;
+    Gap gap;
+
+    int operator()(char a, char b) const { return substitution(a, b); }
+
+    /**
+     * Profile of the inner sequence for the residues of the outer one, its
+     * table taken from arena.
+     */
+    QueryProfile<Substitution> profile(std::string_view inner, std::string_view outer, ScratchArena& arena) const {
+        return QueryProfile<Substitution>(substitution, inner, outer, arena);
+    }
+};
+
+template <typename Substitution, typename Gap>
+Scoring<Substitution, Gap> make_scoring(const Substitution& substitution, const Gap& gap) {
+    return {substitution, gap};
+}
+
+/**
+ * A substitution policy with its arguments swapped, viewing the original.
+ */
+template <typename Substitution>
+struct TransposedSubstitution {
+    const Substitution& substitution;
+
+    int operator()(char a, char b) const { return substitution(b, a); }
+};
+
+/**
+ * Scoring of seq2 against seq1 that gives the scores of seq1 against seq2;
+ * match/mismatch scoring is symmetric and comes back as it is.
+ */
+template <typename Substitution, typename Gap>
+auto transposed(const Scoring<Substitution, Gap>& scoring) {
+    if constexpr (is_match_mismatch<Substitution>::value) {
+        return scoring;
+    } else {
+        return Scoring<TransposedSubstitution<Substitution>, Gap>{{scoring.substitution}, scoring.gap};
+    }
+}
+
+#endif // SCORING_H
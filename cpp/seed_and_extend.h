@@ -0,0 +1,1524 @@
+/**
+ * Seed-and-Extend Algorithm using K-mer Hashing
+ * 
+ * This algorithm is used for fast sequence alignment by:
+ * 1. Finding exact k-mer matches (seeds) using hash tables
+ * 2. Extending seeds to find longer alignments
+ * 
+ * This is the foundational approach used in BLAST, MAQ, and SOAP.
+ *
+ * K-mers are packed 2 bits per base into integers and indexed in CSR form
+ * (sorted k-mer codes with offsets into one flat positions array) rather
+ * than as string keys, and query k-mers are looked up with a rolling code.
+ * Seeds are merged per diagonal and chained co-linearly before extension,
+ * so each candidate locus is extended once instead of once per seed.
+ * Alternatively the seeds are super-maximal exact matches (SMEMs) from a
+ * bidirectional FM-index: few, long and of variable length.
+ * Extension is either ungapped or a banded X-drop affine DP evaluated one
+ * anti-diagonal at a time with vector instructions. Optionally each chain is
+ * first verified with a bit-parallel edit distance search of the whole query
+ * around its diagonal, and dropped without extension if that needs too many
+ * edits. Given a SeedExtendContext, queries reuse its buffers and run without
+ * heap allocation once it has seen the largest query of the workload.
+ */
+
+#ifndef SEED_AND_EXTEND_H
+#define SEED_AND_EXTEND_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "aligner_context.h"
+#include "cigar.h"
+#include "cpu_dispatch.h"
+#include "dp_matrix.h"
+#include "edit_distance.h"
+#include "fm_index.h"
+#include "metrics.h"
+#include "thread_pool.h"
+
+struct Seed {
+    int query_pos;
+    int ref_pos;
+};
+
+/**
+ * Local hit of query[query_start, query_end) on reference[ref_start, ref_end).
+ *
+ * query and reference view the complete input sequences, which must outlive
+ * the hit; the aligned bases are only sliced out of them on request.
+ */
+struct AlignmentHit {
+    int query_start;
+    int query_end;
+    int ref_start;
+    int ref_end;
+    int score;
+    Cigar cigar;
+    std::string_view query;
+    std::string_view reference;
+    
+    std::string_view query_seq() const { return query.substr(query_start, query_end - query_start); }
+    std::string_view ref_seq() const { return reference.substr(ref_start, ref_end - ref_start); }
+};
+
+/**
+ * Which reference/query k-mers become seeds.
+ *
+ * - Contiguous: every k-mer (w = 1, empty pattern).
+ * - (w,k)-minimizers: of every w consecutive k-mers only the one with the
+ *   smallest hash is kept, cutting the index by about (w + 1) / 2 while any
+ *   w + k - 1 bases shared exactly by reference and query still share a seed.
+ * - Spaced seeds: pattern marks with '1' the bases of a span that enter the
+ *   code, so mismatches at '0' positions do not break the seed. k is the
+ *   pattern weight. Spaced seeds combine with minimizer sampling.
+ */
+struct SeedShape {
+    int k = 11;      // Bases in each seed code (1..32)
+    int w = 1;       // Minimizer window in k-mers; 1 keeps every k-mer
+    std::string pattern;  // Spaced seed mask such as "1101101"; empty = contiguous
+
+    static SeedShape contiguous(int k) {
+        SeedShape shape;
+        shape.k = k;
+        return shape;
+    }
+
+    static SeedShape minimizer(int w, int k) {
+        SeedShape shape;
+        shape.k = k;
+        shape.w = w;
+        return shape;
+    }
+
+    static SeedShape spaced(const std::string& pattern, int w = 1) {
+        SeedShape shape;
+        shape.k = std::count(pattern.begin(), pattern.end(), '1');
+        shape.w = w;
+        shape.pattern = pattern;
+        return shape;
+    }
+
+    /**
+     * Bases covered by one seed.
+     */
+    int span() const { return pattern.empty() ? k : (int)pattern.length(); }
+};
+
+/**
+ * Throw invalid_argument unless shape is usable.
+ */
+inline void validate_seed_shape(const SeedShape& shape) {
+    if (shape.k < 1 || shape.k > 32) {
+        throw std::invalid_argument("seed weight must be between 1 and 32");
+    }
+    if (shape.w < 1) {
+        throw std::invalid_argument("minimizer window must be at least 1");
+    }
+    if (!shape.pattern.empty()) {
+        if (shape.pattern.length() > 32 ||
+            shape.pattern.find_first_not_of("01") != std::string::npos ||
+            shape.pattern.front() != '1' || shape.pattern.back() != '1' ||
+            std::count(shape.pattern.begin(), shape.pattern.end(), '1') != shape.k) {
+            throw std::invalid_argument("spaced seed pattern must be 0/1, start and end with 1, "
+                                   "span at most 32 bases and have weight k");
+        }
+    }
+}
+
+/**
+ * Call visit(pos, code) for every seed of sequence made only of ACGT.
+ *
+ * The 2-bit code of the span is rolled one base at a time; a non-ACGT base
+ * restarts the window, so seeds spanning an N are skipped. For spaced seeds
+ * the '1' bases of the span are then gathered into a k-base code.
+ */
+template <typename Visit>
+inline void for_each_kmer(std::string_view sequence, const SeedShape& shape, Visit visit) {
+    const int span = shape.span();
+    const uint64_t mask = (span == 32) ? ~uint64_t(0) : (uint64_t(1) << (2 * span)) - 1;
+
+    uint8_t shifts[32];  // Bit offset in the span code of each '1' base, left to right
+    int weight = 0;
+    for (int j = 0; j < (int)shape.pattern.length(); j++) {
+        if (shape.pattern[j] == '1') {
+            shifts[weight++] = 2 * (span - 1 - j);
+        }
+    }
+
+    uint64_t code = 0;
+    int valid = 0;
+
+    for (size_t i = 0; i < sequence.length(); i++) {
+        uint8_t c = dna_code(sequence[i]);
+        if (c > 3) {
+            valid = 0;
+            code = 0;
+            continue;
+        }
+        code = ((code << 2) | c) & mask;
+        if (++valid < span) {
+            continue;
+        }
+        if (weight == 0) {
+            visit(i + 1 - span, code);
+        } else {
+            uint64_t gathered = 0;
+            for (int j = 0; j < weight; j++) {
+                gathered = (gathered << 2) | ((code >> shifts[j]) & 3);
+            }
+            visit(i + 1 - span, gathered);
+        }
+    }
+}
+
+/**
+ * Invertible mix of a k-mer code so minimizers are not biased to poly-A.
+ */
+inline uint64_t kmer_hash(uint64_t key, uint64_t mask) {
+    key = (~key + (key << 21)) & mask;
+    key = key ^ key >> 24;
+    key = ((key + (key << 3)) + (key << 8)) & mask;
+    key = key ^ key >> 14;
+    key = ((key + (key << 2)) + (key << 4)) & mask;
+    key = key ^ key >> 28;
+    key = (key + (key << 31)) & mask;
+    return key;
+}
+
+/**
+ * Call visit(pos, code) for each seed selected by shape, in position order.
+ *
+ * With w > 1 a monotone queue tracks the minimum hash of the last w k-mers
+ * of the current ACGT run (ties keep the rightmost one); each minimizer is
+ * reported once. A run shorter than w k-mers reports its single minimum, so
+ * short queries still produce a seed.
+ */
+template <typename Visit>
+inline void for_each_seed(std::string_view sequence, const SeedShape& shape, Visit visit) {
+    if (shape.w == 1) {
+        for_each_kmer(sequence, shape, visit);
+        return;
+    }
+
+    struct Entry {
+        uint64_t hash;
+        uint64_t code;
+        size_t pos;
+    };
+    const int w = shape.w;
+    const uint64_t mask = (shape.k == 32) ? ~uint64_t(0) : (uint64_t(1) << (2 * shape.k)) - 1;
+
+    // Ring buffer holding the monotone queue; it never exceeds w entries
+    const int STACK_ENTRIES = 64;
+    Entry stack[STACK_ENTRIES];
+    std::vector<Entry> heap;
+    Entry* ring = stack;
+    if (w > STACK_ENTRIES) {
+        heap.resize(w);
+        ring = heap.data();
+    }
+    size_t head = 0, tail = 0;
+    size_t run = 0;        // K-mers in the current ACGT run
+    size_t next_pos = 0;   // Position the next k-mer must have to extend the run
+    size_t reported = SIZE_MAX;
+
+    auto flush_short_run = [&]() {
+        if (run > 0 && run < (size_t)w && head != tail) {
+            const Entry& e = ring[head % w];
+            visit(e.pos, e.code);
+        }
+    };
+
+    for_each_kmer(sequence, shape, [&](size_t pos, uint64_t code) {
+        if (run > 0 && pos != next_pos) {
+            flush_short_run();
+            head = tail = 0;
+            run = 0;
+        }
+        next_pos = pos + 1;
+        run++;
+
+        if (head != tail && ring[head % w].pos + w <= pos) {
+            head++;
+        }
+        Entry e = {kmer_hash(code, mask), code, pos};
+        while (tail != head && ring[(tail - 1) % w].hash >= e.hash) {
+            tail--;
+        }
+        ring[tail++ % w] = e;
+
+        if (run >= (size_t)w) {
+            const Entry& m = ring[head % w];
+            if (m.pos != reported) {
+                reported = m.pos;
+                visit(m.pos, m.code);
+            }
+        }
+    });
+    flush_short_run();
+}
+
+/**
+ * K-mer index over 2-bit packed k-mer codes in CSR layout.
+ *
+ * kmers holds the distinct k-mer codes in ascending order, and the reference
+ * positions of kmers[i] are positions[offsets[i] .. offsets[i + 1]), ascending.
+ * A direct-address table over the top bucket_bits bits of the code narrows
+ * each lookup to the few kmers sharing that prefix. Memory is 4 bytes per
+ * indexed position plus 12 bytes per distinct k-mer.
+ */
+struct KmerIndex {
+    SeedShape shape;
+    int bucket_bits = 0;
+    std::vector<uint64_t> kmers;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> positions;
+    std::vector<uint32_t> buckets;  // kmers[buckets[p] .. buckets[p + 1]) have prefix p
+
+    uint32_t max_occurrences = 0;   // Build-time cap; 0 = unlimited
+    size_t masked_kmers = 0;        // Distinct k-mers dropped for exceeding the cap
+    size_t masked_positions = 0;    // Positions those k-mers would have used
+
+    /**
+     * Positions of the k-mer with the given code as a [first, last) range;
+     * empty when it does not occur.
+     */
+    std::pair<const uint32_t*, const uint32_t*> lookup(uint64_t code) const {
+        uint64_t prefix = code >> (2 * shape.k - bucket_bits);
+        auto first = kmers.begin() + buckets[prefix];
+        auto last = kmers.begin() + buckets[prefix + 1];
+        auto it = std::lower_bound(first, last, code);
+        if (it == last || *it != code) {
+            return {nullptr, nullptr};
+        }
+        size_t i = it - kmers.begin();
+        return {positions.data() + offsets[i], positions.data() + offsets[i + 1]};
+    }
+};
+
+/**
+ * Threads and memory used by build_kmer_index().
+ */
+struct KmerIndexBuildOptions {
+    size_t threads = 1;     // Worker threads; 0 = all cores
+    size_t max_memory = 0;  // Target bytes of seed scratch per pass; 0 = one pass
+    
+    bool parallel() const { return threads != 1; }
+};
+
+/**
+ * Build k-mer index from reference sequence, indexing the seeds selected by shape.
+ *
+ * Parallel counting sort, in passes over partitions of the top bucket bits:
+ * - The reference is cut into slices that are seeded concurrently; each
+ *   slice has a count per partition, so every (slice, partition) pair gets
+ *   its own output range and the scatter needs no synchronisation
+ * - A pass scatters the (code, position) seeds of as many partitions as fit
+ *   in max_memory, in position order
+ * - Each partition is then counting-sorted into its buckets, and buckets
+ *   holding several distinct k-mers are sorted by full code, independently
+ *   of all other partitions
+ * No per-k-mer strings or vectors are allocated, and the index is the same
+ * whatever the thread count or memory target. A serial build runs the same
+ * steps on the calling thread, over a single slice.
+ *
+ * K-mers occurring more than max_occurrences times (0 = no cap) are masked:
+ * they are left out of the index entirely, so repeats cost neither memory
+ * nor query time and look the same as absent k-mers to find_seeds().
+ */
+inline KmerIndex build_kmer_index(const std::string& sequence, const SeedShape& shape,
+                                  uint32_t max_occurrences = 0,
+                                  const KmerIndexBuildOptions& build = {}) {
+    validate_seed_shape(shape);
+    if (sequence.length() > UINT32_MAX) {
+        throw std::length_error("reference too long for 32-bit positions");
+    }
+
+    KmerIndex index;
+    index.shape = shape;
+    index.max_occurrences = max_occurrences;
+    const int k = shape.k;
+    const size_t n = sequence.length();
+
+    // About one bucket per reference base, capped at 2^24 buckets
+    int bits = 8;
+    while (bits < 24 && (uint64_t(1) << bits) < n) {
+        bits++;
+    }
+    index.bucket_bits = std::min(2 * k, bits);
+    const int shift = 2 * k - index.bucket_bits;
+    const int part_bits = std::min(8, index.bucket_bits);
+    const int part_shift = 2 * k - part_bits;
+    const size_t parts = size_t(1) << part_bits;
+    const size_t subs = size_t(1) << (index.bucket_bits - part_bits);
+
+    std::unique_ptr<WorkStealingPool> pool;
+    if (build.parallel()) {
+        pool = std::make_unique<WorkStealingPool>(build.threads ? build.threads
+                                                                : std::thread::hardware_concurrency());
+    }
+    auto for_each_task = [&pool](size_t count, auto body) {
+        if (pool) {
+            pool->parallel_for(count, body);
+        } else {
+            for (size_t task = 0; task < count; task++) {
+                body(task);
+            }
+        }
+    };
+
+    // Every window that can pick a seed starting in [lo, hi) lies within
+    // [lo - (w - 1), hi + w - 1) k-mer starts, and a run cut short at either
+    // end of that scan only yields seeds outside [lo, hi)
+    const size_t slices = pool ? std::min(4 * pool->size(), n / 65536 + 1) : 1;
+    const size_t slice_len = (n + slices - 1) / slices;
+    auto scan = [&](size_t s, auto visit) {
+        size_t lo = s * slice_len;
+        size_t hi = std::min(n, lo + slice_len);
+        if (lo >= hi) {
+            return;
+        }
+        size_t from = lo - std::min<size_t>(lo, shape.w - 1);
+        size_t to = std::min(n, hi + shape.w - 1 + shape.span() - 1);
+        for_each_seed(std::string_view(sequence).substr(from, to - from), shape,
+                      [&](size_t pos, uint64_t code) {
+            pos += from;
+            if (pos >= lo && pos < hi) {
+                visit(pos, code);
+            }
+        });
+    };
+
+    std::vector<uint32_t> counts(slices * parts, 0);
+    for_each_task(slices, [&](size_t s) {
+        uint32_t* count = &counts[s * parts];
+        scan(s, [&](size_t, uint64_t code) { count[code >> part_shift]++; });
+    });
+    std::vector<size_t> part_size(parts, 0);
+    for (size_t s = 0; s < slices; s++) {
+        for (size_t p = 0; p < parts; p++) {
+            part_size[p] += counts[s * parts + p];
+        }
+    }
+
+    // Bucket split of one partition: kmers, their local offsets and the
+    // local first-kmer index of each bucket; kept positions are compacted
+    // leftwards in place over any masked k-mer
+    struct Partition {
+        std::vector<uint64_t> kmers;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> buckets;
+        uint32_t kept = 0;
+        size_t masked_kmers = 0;
+        size_t masked_positions = 0;
+    };
+    auto split = [&](const uint64_t* codes, uint32_t* positions, size_t size, Partition& out) {
+        std::vector<uint32_t> sub_start(subs + 1, 0);
+        for (size_t r = 0; r < size; r++) {
+            sub_start[((codes[r] >> shift) & (subs - 1)) + 1]++;
+        }
+        for (size_t b = 0; b < subs; b++) {
+            sub_start[b + 1] += sub_start[b];
+        }
+        std::vector<std::pair<uint64_t, uint32_t>> entries(size);
+        std::vector<uint32_t> cursor(sub_start.begin(), sub_start.end() - 1);
+        for (size_t r = 0; r < size; r++) {
+            entries[cursor[(codes[r] >> shift) & (subs - 1)]++] = {codes[r], positions[r]};
+        }
+
+        out.buckets.resize(subs);
+        for (size_t b = 0; b < subs; b++) {
+            out.buckets[b] = out.kmers.size();
+            auto first = entries.begin() + sub_start[b];
+            auto last = entries.begin() + sub_start[b + 1];
+            if (shift != 0) {
+                std::sort(first, last);
+            }
+            for (auto g = first; g != last;) {
+                auto end = g + 1;
+                while (end != last && end->first == g->first) {
+                    end++;
+                }
+                if (max_occurrences > 0 && size_t(end - g) > max_occurrences) {
+                    out.masked_kmers++;
+                    out.masked_positions += end - g;
+                } else {
+                    out.kmers.push_back(g->first);
+                    out.offsets.push_back(out.kept);
+                    for (auto e = g; e != end; e++) {
+                        positions[out.kept++] = e->second;
+                    }
+                }
+                g = end;
+            }
+        }
+    };
+
+    const size_t seed_bytes = sizeof(uint64_t) + sizeof(uint32_t);
+    std::vector<uint64_t> codes;
+    std::vector<uint32_t> positions;
+    for (size_t first = 0; first < parts;) {
+        // Take partitions while the pass fits (always at least one)
+        size_t last = first + 1;
+        size_t seeds = part_size[first];
+        while (last < parts &&
+               (build.max_memory == 0 || (seeds + part_size[last]) * seed_bytes <= build.max_memory)) {
+            seeds += part_size[last++];
+        }
+        const size_t np = last - first;
+
+        // Output range of each (slice, partition): partitions in order, and
+        // slices in order within a partition so positions stay ascending
+        std::vector<size_t> part_start(np + 1, 0);
+        std::vector<size_t> cursor(slices * np);
+        for (size_t p = 0; p < np; p++) {
+            size_t at = part_start[p];
+            for (size_t s = 0; s < slices; s++) {
+                cursor[s * np + p] = at;
+                at += counts[s * parts + first + p];
+            }
+            part_start[p + 1] = at;
+        }
+
+        codes.resize(seeds);
+        positions.resize(seeds);
+        for_each_task(slices, [&](size_t s) {
+            size_t* slot = &cursor[s * np];
+            scan(s, [&](size_t pos, uint64_t code) {
+                size_t p = code >> part_shift;
+                if (p >= first && p < last) {
+                    size_t r = slot[p - first]++;
+                    codes[r] = code;
+                    positions[r] = pos;
+                }
+            });
+        });
+
+        std::vector<Partition> split_parts(np);
+        for_each_task(np, [&](size_t p) {
+            split(codes.data() + part_start[p], positions.data() + part_start[p],
+                  part_start[p + 1] - part_start[p], split_parts[p]);
+        });
+
+        for (size_t p = 0; p < np; p++) {
+            const Partition& part = split_parts[p];
+            uint32_t kmer_base = index.kmers.size();
+            uint32_t position_base = index.positions.size();
+            for (uint32_t b : part.buckets) {
+                index.buckets.push_back(kmer_base + b);
+            }
+            for (uint32_t offset : part.offsets) {
+                index.offsets.push_back(position_base + offset);
+            }
+            index.kmers.insert(index.kmers.end(), part.kmers.begin(), part.kmers.end());
+            index.positions.insert(index.positions.end(), positions.begin() + part_start[p],
+                                   positions.begin() + part_start[p] + part.kept);
+            index.masked_kmers += part.masked_kmers;
+            index.masked_positions += part.masked_positions;
+        }
+        first = last;
+    }
+    index.buckets.push_back(index.kmers.size());
+    index.offsets.push_back(index.positions.size());
+    index.positions.shrink_to_fit();
+
+    return index;
+}
+
+/**
+ * Build k-mer index of every contiguous k-mer of the reference.
+ */
+inline KmerIndex build_kmer_index(const std::string& sequence, int k) {
+    return build_kmer_index(sequence, SeedShape::contiguous(k));
+}
+
+/**
+ * Find exact k-mer matches between query and reference.
+ *
+ * The query is sampled with the index's own seed shape, so minimizer and
+ * spaced-seed indexes are queried consistently. A query k-mer with more than
+ * max_hits reference positions (0 = no limit) is skipped rather than
+ * truncated, which would bias seeds towards the start of the reference; the
+ * number of seeds is then at most max_hits per query k-mer.
+ *
+ * Seeds are written to seeds, replacing its contents but keeping its storage.
+ */
+inline void find_seeds(const std::string& query, const KmerIndex& index, uint32_t max_hits,
+                       std::vector<Seed>& seeds) {
+    seeds.clear();
+    uint64_t filtered = 0;
+    for_each_seed(query, index.shape, [&](size_t i, uint64_t code) {
+        auto hits = index.lookup(code);
+        if (max_hits > 0 && (size_t)(hits.second - hits.first) > max_hits) {
+            filtered += hits.second - hits.first;
+            return;
+        }
+        for (const uint32_t* p = hits.first; p != hits.second; p++) {
+            seeds.push_back({(int)i, (int)*p});
+        }
+    });
+    metrics_count(Metric::SeedsFound, seeds.size());
+    metrics_count(Metric::SeedsFiltered, filtered);
+}
+
+/**
+ * Exact k-mer matches between query and reference, as a new vector.
+ */
+inline std::vector<Seed> find_seeds(const std::string& query, const KmerIndex& index,
+                                    uint32_t max_hits = 0) {
+    std::vector<Seed> seeds;
+    find_seeds(query, index, max_hits, seeds);
+    return seeds;
+}
+
+/**
+ * Run of exact matches on one diagonal: query[query_pos, query_pos + length)
+ * matches reference[ref_pos, ref_pos + length).
+ */
+struct Anchor {
+    int query_pos;
+    int ref_pos;
+    int length;
+};
+
+/**
+ * Buffers of the seed-and-extend pipeline, kept from one query to the next.
+ *
+ * Passing the same context to successive seed_and_extend() calls reuses the
+ * seed, anchor and hit storage, the CIGARs of the previous hits, the edit
+ * distance verifier and the arena the chaining and extension DPs take their
+ * scratch from; once the largest query of a workload has been through it, a
+ * query allocates nothing. A context belongs to one thread at a time, and
+ * each call overwrites the hits of the previous one.
+ */
+struct SeedExtendContext {
+    std::vector<Seed> seeds;
+    std::vector<Anchor> anchors;
+    std::vector<BidirectionalFMIndex::MaximalMatch> smems;
+    std::vector<uint32_t> positions;
+    std::vector<AlignmentHit> hits;
+    std::vector<Cigar> spare_cigars;  // Storage of earlier hits' CIGARs
+    MyersPattern verifier;
+    ScratchArena arena;
+
+    /**
+     * Drop all hits, keeping their CIGAR storage for new_hit().
+     */
+    void clear_hits() {
+        for (AlignmentHit& hit : hits) {
+            spare_cigars.push_back(std::move(hit.cigar));
+        }
+        hits.clear();
+    }
+
+    /**
+     * Append a hit, with an empty CIGAR reusing earlier storage if there is any.
+     */
+    AlignmentHit& new_hit() {
+        hits.emplace_back();
+        if (!spare_cigars.empty()) {
+            hits.back().cigar = std::move(spare_cigars.back());
+            hits.back().cigar.clear();
+            spare_cigars.pop_back();
+        }
+        return hits.back();
+    }
+};
+
+/**
+ * Anchors of the super-maximal exact matches of query of at least min_length
+ * bases, one per reference occurrence, sorted by reference then query
+ * position, into context.anchors.
+ *
+ * An SMEM with more than max_hits occurrences (0 = no limit) is skipped, as
+ * find_seeds() skips repetitive k-mers.
+ */
+inline void find_smem_anchors(const std::string& query, const BidirectionalFMIndex& index,
+                              int min_length, uint32_t max_hits, SeedExtendContext& context) {
+    std::vector<Anchor>& anchors = context.anchors;
+    anchors.clear();
+    index.smems(query, min_length, context.smems);
+    for (const BidirectionalFMIndex::MaximalMatch& match : context.smems) {
+        if (max_hits > 0 && match.interval.size > max_hits) {
+            continue;
+        }
+        index.positions(match.interval, context.positions);
+        for (uint32_t pos : context.positions) {
+            anchors.push_back({match.query_start, (int)pos, match.query_end - match.query_start});
+        }
+    }
+    std::sort(anchors.begin(), anchors.end(), [](const Anchor& a, const Anchor& b) {
+        return a.ref_pos != b.ref_pos ? a.ref_pos < b.ref_pos : a.query_pos < b.query_pos;
+    });
+}
+
+/**
+ * SMEM anchors of query (see above), as a new vector.
+ */
+inline std::vector<Anchor> find_smem_anchors(const std::string& query, const BidirectionalFMIndex& index,
+                                             int min_length, uint32_t max_hits = 0) {
+    SeedExtendContext context;
+    find_smem_anchors(query, index, min_length, max_hits, context);
+    return std::move(context.anchors);
+}
+
+/**
+ * Co-linear anchors, ordered by position in both sequences.
+ */
+struct Chain {
+    int score;
+    int query_start;
+    int query_end;
+    int ref_start;
+    int ref_end;
+    std::vector<Anchor> anchors;
+};
+
+struct ChainOptions {
+    int max_gap = 5000;          // Max distance between chained anchors in either sequence
+    int bandwidth = 500;         // Max diagonal shift between chained anchors
+    int max_predecessors = 50;   // Anchors looked back at per DP step
+    int min_score = 0;           // Chains scoring below this are dropped
+};
+
+/**
+ * Merge seeds of span k that overlap or abut on the same diagonal into
+ * anchors, sorted by reference then query position.
+ *
+ * seeds is sorted in place by diagonal; anchors is replaced, keeping its storage.
+ */
+inline void merge_seeds(std::vector<Seed>& seeds, int k, std::vector<Anchor>& anchors) {
+    std::sort(seeds.begin(), seeds.end(), [](const Seed& a, const Seed& b) {
+        int da = a.ref_pos - a.query_pos, db = b.ref_pos - b.query_pos;
+        return da != db ? da < db : a.query_pos < b.query_pos;
+    });
+
+    anchors.clear();
+    for (const Seed& seed : seeds) {
+        if (!anchors.empty()) {
+            Anchor& last = anchors.back();
+            if (last.ref_pos - last.query_pos == seed.ref_pos - seed.query_pos &&
+                seed.query_pos <= last.query_pos + last.length) {
+                last.length = std::max(last.length, seed.query_pos + k - last.query_pos);
+                continue;
+            }
+        }
+        anchors.push_back({seed.query_pos, seed.ref_pos, k});
+    }
+
+    std::sort(anchors.begin(), anchors.end(), [](const Anchor& a, const Anchor& b) {
+        return a.ref_pos != b.ref_pos ? a.ref_pos < b.ref_pos : a.query_pos < b.query_pos;
+    });
+}
+
+/**
+ * Anchors of merged seeds of span k (see above), as a new vector.
+ */
+inline std::vector<Anchor> merge_seeds(std::vector<Seed> seeds, int k) {
+    std::vector<Anchor> anchors;
+    merge_seeds(seeds, k, anchors);
+    return anchors;
+}
+
+/**
+ * Chain anchors, sorted by reference then query position, co-linearly with
+ * the minimap2 chaining DP.
+ *
+ * f(i) = max(len_i, max_j f(j) + min(dq, dr, len_i) - gap_cost(|dq - dr|)),
+ * over the previous max_predecessors anchors j that start strictly before
+ * anchor i in both sequences, with gap_cost(l) = 0.01 * avg_len * l + 0.5 * log2(l).
+ * Chains are then read back from the best-scoring ends, each anchor used by
+ * at most one chain; a chain that runs into an anchor already taken keeps only
+ * its own part and score.
+ *
+ * Calls emit(chain, path, count) for each chain by descending score (ties
+ * in the order they were read back): chain holds the score and extent but
+ * no anchors, and path the indices of its count anchors, last to first.
+ * All scratch is taken from arena.
+ */
+template <typename Emit>
+inline void for_each_chain(const std::vector<Anchor>& anchors, const ChainOptions& options,
+                           ScratchArena& arena, Emit emit) {
+    const int n = anchors.size();
+    if (n == 0) {
+        return;
+    }
+    ScratchArena::Scope scope(arena);
+    StageTimer timer(Stage::Chain);
+
+    double avg_len = 0;
+    for (const Anchor& a : anchors) {
+        avg_len += a.length;
+    }
+    avg_len /= n;
+
+    int* f = arena.allocate<int>(n);
+    int* prev = arena.allocate<int>(n);
+    std::fill(prev, prev + n, -1);
+    for (int i = 0; i < n; i++) {
+        const Anchor& ai = anchors[i];
+        f[i] = ai.length;
+        for (int j = i - 1; j >= 0 && j >= i - options.max_predecessors; j--) {
+            const Anchor& aj = anchors[j];
+            int dr = ai.ref_pos - aj.ref_pos;
+            int dq = ai.query_pos - aj.query_pos;
+            if (dr > options.max_gap) {
+                break;
+            }
+            if (dr <= 0 || dq <= 0 || dq > options.max_gap) {
+                continue;
+            }
+            int dd = std::abs(dr - dq);
+            if (dd > options.bandwidth) {
+                continue;
+            }
+            int gain = std::min(std::min(dq, dr), ai.length);
+            int cost = dd > 0 ? (int)(0.01 * avg_len * dd + 0.5 * std::log2(dd)) : 0;
+            if (f[j] + gain - cost > f[i]) {
+                f[i] = f[j] + gain - cost;
+                prev[i] = j;
+            }
+        }
+    }
+
+    // Ends by descending score; index order breaks ties as a stable sort would
+    int* order = arena.allocate<int>(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::sort(order, order + n, [&](int a, int b) { return f[a] != f[b] ? f[a] > f[b] : a < b; });
+
+    // Read chains back into path, recording where each one's indices start
+    struct Kept {
+        int score;
+        int begin;
+        int count;
+    };
+    uint8_t* used = arena.allocate<uint8_t>(n);
+    std::fill(used, used + n, 0);
+    int* path = arena.allocate<int>(n);
+    Kept* kept = arena.allocate<Kept>(n);
+    int chains = 0, filled = 0;
+    for (int k = 0; k < n; k++) {
+        int end = order[k];
+        if (used[end]) {
+            continue;
+        }
+        int begin = filled;
+        int i = end;
+        while (i >= 0 && !used[i]) {
+            used[i] = 1;
+            path[filled++] = i;
+            i = prev[i];
+        }
+        int score = f[end] - (i >= 0 ? f[i] : 0);
+        if (score >= options.min_score) {
+            kept[chains++] = {score, begin, filled - begin};
+        }
+    }
+    std::sort(kept, kept + chains, [](const Kept& a, const Kept& b) {
+        return a.score != b.score ? a.score > b.score : a.begin < b.begin;
+    });
+    timer.stop();
+
+    for (int c = 0; c < chains; c++) {
+        const int* indices = path + kept[c].begin;
+        const Anchor& first = anchors[indices[kept[c].count - 1]];
+        const Anchor& last = anchors[indices[0]];
+        Chain chain = {kept[c].score, first.query_pos, last.query_pos + last.length,
+                       first.ref_pos, last.ref_pos + last.length, {}};
+        emit(chain, indices, kept[c].count);
+    }
+}
+
+/**
+ * Chain anchors as for_each_chain() does; returns chains by descending score.
+ */
+inline std::vector<Chain> chain_anchors(const std::vector<Anchor>& anchors,
+                                        const ChainOptions& options = ChainOptions()) {
+    std::vector<Chain> chains;
+    for_each_chain(anchors, options, AlignerContext::local().arena,
+                   [&](const Chain& extent, const int* path, int count) {
+        chains.push_back(extent);
+        Chain& chain = chains.back();
+        for (int k = count - 1; k >= 0; k--) {
+            chain.anchors.push_back(anchors[path[k]]);
+        }
+    });
+    return chains;
+}
+
+/**
+ * Chain seeds of span k: merge_seeds() followed by chain_anchors().
+ */
+inline std::vector<Chain> chain_seeds(const std::vector<Seed>& seeds, int k,
+                                      const ChainOptions& options = ChainOptions()) {
+    return chain_anchors(merge_seeds(seeds, k), options);
+}
+
+/**
+ * Extend a seed match in both directions, into hit (its CIGAR storage is reused).
+ * Each direction stops once its score falls more than xdrop below its best.
+ */
+inline void extend_seed(const std::string& seq1, const std::string& seq2,
+                        int seed_pos1, int seed_pos2, AlignmentHit& hit,
+                        int match_score = 1, int mismatch_penalty = -1, int xdrop = 5) {
+    int len1 = seq1.length();
+    int len2 = seq2.length();
+    
+    // Extend right
+    int score = 0;
+    int max_score = 0;
+    int max_right = 0;
+    
+    int i = 0;
+    while (seed_pos1 + i < len1 && seed_pos2 + i < len2) {
+        if (seq1[seed_pos1 + i] == seq2[seed_pos2 + i]) {
+            score += match_score;
+        } else {
+            score += mismatch_penalty;
+        }
+        
+        if (score > max_score) {
+            max_score = score;
+            max_right = i + 1;
+        }
+        
+        // Stop if score drops too much below max
+        if (score < max_score - xdrop) {
+            break;
+        }
+        
+        i++;
+    }
+    // Stopped before the end of either sequence: X-dropped
+    bool dropped = seed_pos1 + i < len1 && seed_pos2 + i < len2;
+    
+    // Extend left
+    score = max_score;
+    int max_left = 0;
+    
+    i = 1;
+    while (seed_pos1 - i >= 0 && seed_pos2 - i >= 0) {
+        if (seq1[seed_pos1 - i] == seq2[seed_pos2 - i]) {
+            score += match_score;
+        } else {
+            score += mismatch_penalty;
+        }
+        
+        if (score > max_score) {
+            max_score = score;
+            max_left = i;
+        }
+        
+        // Stop if score drops too much below max
+        if (score < max_score - xdrop) {
+            break;
+        }
+        
+        i++;
+    }
+    dropped = dropped || (seed_pos1 - i >= 0 && seed_pos2 - i >= 0);
+    metrics_count(Metric::Extensions);
+    metrics_count(Metric::ExtensionsXDropped, dropped);
+    
+    int start1 = seed_pos1 - max_left;
+    int end1 = seed_pos1 + max_right;
+    int start2 = seed_pos2 - max_left;
+    int end2 = seed_pos2 + max_right;
+    
+    hit.query_start = start1;
+    hit.query_end = end1;
+    hit.ref_start = start2;
+    hit.ref_end = end2;
+    hit.score = max_score;
+    hit.cigar.clear();
+    hit.cigar.push('M', end1 - start1);
+    hit.query = seq1;
+    hit.reference = seq2;
+}
+
+/**
+ * Extend a seed match in both directions.
+ */
+inline AlignmentHit extend_seed(const std::string& seq1, const std::string& seq2,
+                                int seed_pos1, int seed_pos2,
+                                int match_score = 1, int mismatch_penalty = -1, int xdrop = 5) {
+    AlignmentHit hit;
+    extend_seed(seq1, seq2, seed_pos1, seed_pos2, hit, match_score, mismatch_penalty, xdrop);
+    return hit;
+}
+
+/**
+ * Scoring and limits of seed extension.
+ *
+ * The gapped mode scores like smith_waterman_affine(): a gap of length k
+ * costs gap_open + k * gap_extend.
+ */
+struct ExtensionOptions {
+    bool gapped = false;        // false: ungapped extend_seed()
+    int match_score = 2;
+    int mismatch_penalty = -1;
+    int gap_open = -3;
+    int gap_extend = -1;
+    int xdrop = 20;             // Stop once every cell is this far below the best score
+    int band = 32;              // Max cells off the seed diagonal
+};
+
+/**
+ * Best end of an extension: score over query[0, query_len) x ref[0, ref_len).
+ */
+struct ExtensionEnd {
+    int score;
+    int query_len;
+    int ref_len;
+    bool xdropped = false;  // X-drop ended the walk before the best path reached the query's end
+};
+
+/**
+ * X-drop affine extension anchored at (0, 0), one anti-diagonal at a time.
+ *
+ * Cell (i, j) lies on anti-diagonal d = i + j and depends only on diagonals
+ * d - 1 (gaps) and d - 2 (match), so a whole diagonal is computed with
+ * 32-bit vector lanes. Diagonals are stored by i; the reference is read
+ * reversed so that ref[j - 1] is contiguous in i as well. The live range of
+ * a diagonal is cut to |i - j| <= band and trimmed at both ends to cells
+ * within xdrop of the best score so far, and the walk stops when no cell is
+ * left: work is O(alignment length x band) rather than O(n x m).
+ *
+ * q and r hold n and m symbols (any int codes; equal codes match). If path
+ * is given, one traceback byte per computed cell is kept and the operations
+ * ('M', 'I', 'D') of the path to the best cell are pushed onto it from the
+ * far end back to (0, 0). All scratch, path included, comes from arena; the
+ * caller rewinds it.
+ */
+template <typename T, size_t BYTES>
+static inline __attribute__((always_inline))
+ExtensionEnd xdrop_kernel(const int* q, int n, const int* r, int m, const ExtensionOptions& opt,
+                          ScratchArena& arena, ArenaVector<char>* path) {
+    typedef T V __attribute__((vector_size(BYTES)));
+    const int LANES = BYTES / sizeof(T);
+    const T NEG = std::numeric_limits<T>::min() / 4;
+
+    // Vectors are loaded into locals and never returned by value, which
+    // would change the ABI of a lambda compiled for the baseline ISA
+    auto load = [](V& v, const T* p) __attribute__((always_inline)) { std::memcpy(&v, p, sizeof(V)); };
+    auto store = [](T* p, const V& v) __attribute__((always_inline)) { std::memcpy(p, &v, sizeof(V)); };
+
+    // qv[i] = query symbol of row i (1-based), rv[m - d + i] = ref symbol of column d - i
+    T* qv = arena.allocate<T>(n + LANES + 1);
+    T* rv = arena.allocate<T>(m + LANES + 1);
+    std::fill(qv, qv + n + LANES + 1, T(-1));
+    std::fill(rv, rv + m + LANES + 1, T(-2));
+    for (int i = 0; i < n; i++) {
+        qv[i + 1] = q[i];
+    }
+    for (int j = 0; j < m; j++) {
+        rv[m - 1 - j] = r[j];
+    }
+
+    // One slot per live diagonal (d, d - 1, d - 2), indexed by i + 1 so that
+    // index -1 exists. Every entry outside a diagonal's live cells is NEG.
+    struct Diag {
+        T* h;
+        T* e;
+        T* f;
+        int lo, hi;                  // Live cells after X-drop trimming; empty if lo > hi
+        int written_lo, written_hi;  // Entries the vector loop wrote
+    };
+    const int width = n + 2 * LANES + 2;
+    T* buffers = arena.allocate<T>(9 * width);
+    std::fill(buffers, buffers + 9 * width, NEG);
+    Diag slots[3];
+    for (int s = 0; s < 3; s++) {
+        slots[s] = {buffers + 3 * s * width, buffers + (3 * s + 1) * width,
+                    buffers + (3 * s + 2) * width, 1, 0, 1, 0};
+    }
+    Diag* D2 = &slots[0];  // Diagonal d - 2
+    Diag* D1 = &slots[1];  // Diagonal d - 1
+    Diag* D0 = &slots[2];  // Diagonal d
+
+    D1->h[1] = 0;  // Diagonal 0 is the anchor cell
+    D1->lo = D1->hi = 0;
+    D1->written_lo = D1->written_hi = 0;
+    ExtensionEnd best = {0, 0, 0};
+
+    const V v_zero = {};
+    const V v_neg = v_zero + NEG;
+    const V v_open = v_zero + (opt.gap_open + opt.gap_extend);
+    const V v_ext = v_zero + opt.gap_extend;
+    const V v_match = v_zero + opt.match_score;
+    const V v_mismatch = v_zero + opt.mismatch_penalty;
+    V v_lane = v_zero;
+    for (int l = 0; l < LANES; l++) {
+        v_lane[l] = l;
+    }
+
+    // Traceback byte per computed cell: bits 0-1 the source of H (0 match,
+    // 1 E, 2 F), bit 2 set if E extended a gap, bit 3 set if F did
+    const bool trace = path != nullptr;
+    ArenaVector<uint8_t> codes{ArenaAllocator<uint8_t>(arena)};
+    size_t* diag_start = nullptr;  // Index in codes of cell (diag_lo[d], d - diag_lo[d])
+    int* diag_lo = nullptr;
+    if (trace) {
+        diag_start = arena.allocate<size_t>(n + m + 1);
+        diag_lo = arena.allocate<int>(n + m + 1);
+    }
+    const V v_one = v_zero + 1;
+    const V v_two = v_zero + 2;
+    const V v_e_ext = v_zero + 4;
+    const V v_f_ext = v_zero + 8;
+
+    uint64_t cells = 0;
+    bool dropped = false;
+    for (int d = 1; d <= n + m; d++) {
+        bool live1 = D1->lo <= D1->hi;
+        bool live2 = D2->lo <= D2->hi;
+        if (!live1 && !live2) {
+            dropped = true;
+            break;
+        }
+
+        // Reset the slot to all-NEG, then bound diagonal d by what d - 1
+        // (gaps) and d - 2 (match) can reach, the band and both sequences
+        std::fill(D0->h + D0->written_lo, D0->h + D0->written_hi + 2, NEG);
+        std::fill(D0->e + D0->written_lo, D0->e + D0->written_hi + 2, NEG);
+        std::fill(D0->f + D0->written_lo, D0->f + D0->written_hi + 2, NEG);
+        int lo = std::min(live1 ? D1->lo : INT32_MAX, live2 ? D2->lo + 1 : INT32_MAX);
+        int hi = std::max(live1 ? D1->hi + 1 : -1, live2 ? D2->hi + 1 : -1);
+        int band_lo = d - opt.band <= 0 ? 0 : (d - opt.band + 1) / 2;
+        lo = std::max(std::max(lo, d - m), band_lo);
+        hi = std::min(std::min(hi, n), (d + opt.band) / 2);
+
+        D0->lo = 1;
+        D0->hi = 0;
+        D0->written_lo = D0->written_hi = 0;
+        if (lo <= hi) {
+            cells += hi - lo + 1;
+            const V v_floor = v_zero + (best.score - opt.xdrop);
+            const V v_hi = v_zero + hi;
+            const T* rd = rv + (m - d);
+            uint8_t* trace_row = nullptr;
+            if (trace) {
+                diag_start[d] = codes.size();
+                diag_lo[d] = lo;
+                codes.resize(codes.size() + hi - lo + 1);
+                trace_row = codes.data() + diag_start[d] - lo;
+            }
+            V v_best = v_neg;
+            int i = lo;
+            for (; i <= hi; i += LANES) {
+                V e_open, e_ext, f_open, f_ext, qi, ri, diag;
+                load(e_open, D1->h + i + 1);
+                load(e_ext, D1->e + i + 1);
+                load(f_open, D1->h + i);
+                load(f_ext, D1->f + i);
+                load(qi, qv + i);
+                load(ri, rd + i);
+                load(diag, D2->h + i);
+                e_open += v_open;
+                e_ext += v_ext;
+                f_open += v_open;
+                f_ext += v_ext;
+                V e = e_open > e_ext ? e_open : e_ext;
+                V f = f_open > f_ext ? f_open : f_ext;
+                diag += qi == ri ? v_match : v_mismatch;
+                V h = e > f ? e : f;
+                h = diag > h ? diag : h;
+                if (trace) {
+                    V code = h == diag ? v_zero : (h == e ? v_one : v_two);
+                    code |= e_ext > e_open ? v_e_ext : v_zero;
+                    code |= f_ext > f_open ? v_f_ext : v_zero;
+                    for (int l = 0; l < LANES && i + l <= hi; l++) {
+                        trace_row[i + l] = code[l];
+                    }
+                }
+                auto dead = (h < v_floor) | (v_lane + i > v_hi);
+                h = dead ? v_neg : h;
+                store(D0->h + i + 1, h);
+                store(D0->e + i + 1, dead ? v_neg : e);
+                store(D0->f + i + 1, dead ? v_neg : f);
+                v_best = h > v_best ? h : v_best;
+            }
+            D0->written_lo = lo + 1;
+            D0->written_hi = i;
+
+            T diag_best = NEG;
+            for (int l = 0; l < LANES; l++) {
+                diag_best = std::max(diag_best, v_best[l]);
+            }
+            if (diag_best != NEG) {
+                if (diag_best > best.score) {
+                    int c = lo;
+                    while (D0->h[c + 1] != diag_best) {
+                        c++;
+                    }
+                    best = {diag_best, c, d - c};
+                }
+                // X-drop trimming of both ends
+                while (D0->h[lo + 1] == NEG) {
+                    lo++;
+                }
+                while (D0->h[hi + 1] == NEG) {
+                    hi--;
+                }
+                D0->lo = lo;
+                D0->hi = hi;
+            }
+        }
+
+        Diag* t = D2;
+        D2 = D1;
+        D1 = D0;
+        D0 = t;
+    }
+
+    metrics_count(Metric::DPCells, cells);
+    best.xdropped = dropped && best.query_len < n;
+
+    if (trace) {
+        StageTimer timer(Stage::Traceback);
+        int i = best.query_len, j = best.ref_len;
+        int state = 0;  // 0 in H, 1 in E, 2 in F
+        while (i > 0 || j > 0) {
+            uint8_t code = codes[diag_start[i + j] + (i - diag_lo[i + j])];
+            if (state == 0) {
+                state = code & 3;
+                if (state == 0) {
+                    path->push_back('M');
+                    i--;
+                    j--;
+                }
+            } else if (state == 1) {
+                path->push_back('D');
+                state = (code & 4) ? 1 : 0;
+                j--;
+            } else {
+                path->push_back('I');
+                state = (code & 8) ? 2 : 0;
+                i--;
+            }
+        }
+    }
+    return best;
+}
+
+typedef ExtensionEnd (*XDropFn)(const int*, int, const int*, int, const ExtensionOptions&,
+                                ScratchArena&, ArenaVector<char>*);
+
+// Define the X-drop wrapper of one ISA; ATTR selects the instruction set
+#define XDROP_VARIANT(NAME, ATTR, BYTES)                                                     \
+    ATTR static ExtensionEnd xdrop_##NAME(const int* q, int n, const int* r, int m,         \
+                                          const ExtensionOptions& opt, ScratchArena& arena, \
+                                          ArenaVector<char>* path) {                        \
+        return xdrop_kernel<int32_t, BYTES>(q, n, r, m, opt, arena, path);                  \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+XDROP_VARIANT(avx512, __attribute__((target("avx512bw"))), 64)
+XDROP_VARIANT(avx2, __attribute__((target("avx2"))), 32)
+XDROP_VARIANT(sse41, __attribute__((target("sse4.1"))), 16)
+#endif
+// Baseline build: NEON on AArch64, SSE2 on x86-64, plain vector code elsewhere
+XDROP_VARIANT(generic, , 16)
+
+#undef XDROP_VARIANT
+
+/**
+ * Select the widest X-drop kernel the running CPU supports (detected once).
+ */
+inline XDropFn xdrop_kernel_for_cpu() {
+    static const XDropFn kernel = []() -> XDropFn {
+#if defined(__x86_64__) || defined(__i386__)
+        if (ALIGN_CPU_SUPPORTS("avx512bw")) {
+            return xdrop_avx512;
+        }
+        if (ALIGN_CPU_SUPPORTS("avx2")) {
+            return xdrop_avx2;
+        }
+        if (ALIGN_CPU_SUPPORTS("sse4.1")) {
+            return xdrop_sse41;
+        }
+#endif
+        return xdrop_generic;
+    }();
+    return kernel;
+}
+
+/**
+ * Gapped extension of an anchor of the given length in both directions, into
+ * hit (its CIGAR storage is reused), with scratch from arena.
+ *
+ * The anchor itself is scored base by base (spaced seeds may mismatch inside
+ * it); each side is extended with the X-drop kernel, the left side on the
+ * reversed prefixes, and the CIGAR is joined from both tracebacks. The reference is only read up to band bases beyond the
+ * query length on either side.
+ */
+inline void extend_seed_gapped(const std::string& seq1, const std::string& seq2,
+                               int seed_pos1, int seed_pos2, int length,
+                               const ExtensionOptions& options, ScratchArena& arena, AlignmentHit& hit) {
+    ScratchArena::Scope scope(arena);
+    XDropFn kernel = xdrop_kernel_for_cpu();
+    int len1 = seq1.length();
+    int len2 = seq2.length();
+    
+    int seed_score = 0;
+    for (int i = 0; i < length; i++) {
+        seed_score += seq1[seed_pos1 + i] == seq2[seed_pos2 + i]
+                      ? options.match_score : options.mismatch_penalty;
+    }
+    
+    // Extend right
+    int end1 = seed_pos1 + length;
+    int end2 = seed_pos2 + length;
+    int n = len1 - end1;
+    int m = std::min(len2 - end2, n + options.band);
+    int* a = arena.allocate<int>(std::max(n, seed_pos1));
+    int* b = arena.allocate<int>(std::max(m, std::min(seed_pos2, seed_pos1 + options.band)));
+    for (int i = 0; i < n; i++) {
+        a[i] = static_cast<unsigned char>(seq1[end1 + i]);
+    }
+    for (int j = 0; j < m; j++) {
+        b[j] = static_cast<unsigned char>(seq2[end2 + j]);
+    }
+    ArenaVector<char> right_path{ArenaAllocator<char>(arena)};
+    ExtensionEnd right = kernel(a, n, b, m, options, arena, &right_path);
+    
+    // Extend left
+    n = seed_pos1;
+    m = std::min(seed_pos2, n + options.band);
+    for (int i = 0; i < n; i++) {
+        a[i] = static_cast<unsigned char>(seq1[seed_pos1 - 1 - i]);
+    }
+    for (int j = 0; j < m; j++) {
+        b[j] = static_cast<unsigned char>(seq2[seed_pos2 - 1 - j]);
+    }
+    ArenaVector<char> left_path{ArenaAllocator<char>(arena)};
+    ExtensionEnd left = kernel(a, n, b, m, options, arena, &left_path);
+    metrics_count(Metric::Extensions);
+    metrics_count(Metric::ExtensionsXDropped, left.xdropped || right.xdropped);
+    
+    hit.query_start = seed_pos1 - left.query_len;
+    hit.query_end = end1 + right.query_len;
+    hit.ref_start = seed_pos2 - left.ref_len;
+    hit.ref_end = end2 + right.ref_len;
+    hit.score = left.score + seed_score + right.score;
+    hit.query = seq1;
+    hit.reference = seq2;
+
+    // Traced back from its far end, the reversed left side is already in forward order
+    hit.cigar.clear();
+    for (char op : left_path) {
+        hit.cigar.push(op);
+    }
+    hit.cigar.push('M', length);
+    for (auto op = right_path.rbegin(); op != right_path.rend(); ++op) {
+        hit.cigar.push(*op);
+    }
+}
+
+/**
+ * Gapped extension of an anchor of the given length in both directions (see above).
+ */
+inline AlignmentHit extend_seed_gapped(const std::string& seq1, const std::string& seq2,
+                                       int seed_pos1, int seed_pos2, int length,
+                                       const ExtensionOptions& options = ExtensionOptions()) {
+    AlignmentHit hit;
+    extend_seed_gapped(seq1, seq2, seed_pos1, seed_pos2, length, options,
+                       AlignerContext::local().arena, hit);
+    return hit;
+}
+
+/**
+ * Limits and scoring of the seed-and-extend pipeline.
+ */
+struct SeedExtendOptions {
+    uint32_t max_occurrences = 0;   // Mask k-mers more frequent than this at build time (0 = off)
+    uint32_t max_hits = 0;          // Skip query k-mers (or SMEMs) with more hits than this (0 = off)
+    size_t max_chains = 10;         // Chains extended per query (0 = all)
+    int max_edits = -1;             // Skip chains the whole query can't match within this many edits (-1 = off)
+    int min_smem_length = 19;       // Shortest SMEM used as a seed (FM-index seeding only)
+    ChainOptions chain;
+    ExtensionOptions extension;
+};
+
+/**
+ * Whether query can match, within max_edits edits, the reference window the
+ * chain's diagonal projects onto (widened by max_edits on either side).
+ */
+inline bool verify_chain(const Chain& chain, const std::string& reference, const std::string& query,
+                         const SeedExtendOptions& options, const MyersPattern& verifier) {
+    StageTimer timer(Stage::Verify);
+    long begin = long(chain.ref_start) - chain.query_start - options.max_edits;
+    long end = long(chain.ref_end) + long(query.size()) - chain.query_end + options.max_edits;
+    begin = std::max(0L, begin);
+    end = std::min(long(reference.size()), end);
+    std::string_view window(reference.data() + begin, std::max(0L, end - begin));
+    return verifier.search_distance(window, options.max_edits) >= 0;
+}
+
+/**
+ * Extend one anchor, ungapped or gapped as options say, into hit.
+ */
+inline void extend_anchor(const Anchor& anchor, const std::string& reference, const std::string& query,
+                          const ExtensionOptions& options, ScratchArena& arena, AlignmentHit& hit) {
+    StageTimer timer(Stage::Extend);
+    if (options.gapped) {
+        extend_seed_gapped(query, reference, anchor.query_pos, anchor.ref_pos, anchor.length,
+                           options, arena, hit);
+    } else {
+        extend_seed(query, reference, anchor.query_pos, anchor.ref_pos, hit,
+                    options.match_score, options.mismatch_penalty, options.xdrop);
+    }
+}
+
+/**
+ * Chain context.anchors and extend the best max_chains chains of query into
+ * context.hits, by descending score, without building the chains
+ * themselves. Each chain is extended from its longest anchor, ungapped or
+ * with the gapped X-drop DP, after the optional max_edits verification.
+ */
+inline void extend_anchors(const std::string& reference, const std::string& query,
+                           const SeedExtendOptions& options, SeedExtendContext& context) {
+    context.clear_hits();
+    if (options.max_edits >= 0) {
+        context.verifier.assign(query);
+    }
+    size_t taken = 0;
+    for_each_chain(context.anchors, options.chain, context.arena,
+                   [&](const Chain& chain, const int* path, int count) {
+        if (options.max_chains > 0 && taken++ >= options.max_chains) {
+            return;
+        }
+        if (options.max_edits >= 0 && !verify_chain(chain, reference, query, options, context.verifier)) {
+            return;
+        }
+        // First longest anchor in chain order; path runs last to first
+        const Anchor* best = &context.anchors[path[count - 1]];
+        for (int k = count - 2; k >= 0; k--) {
+            const Anchor& anchor = context.anchors[path[k]];
+            if (anchor.length > best->length) {
+                best = &anchor;
+            }
+        }
+        extend_anchor(*best, reference, query, options.extension, context.arena, context.new_hit());
+
+        // Keep hits by descending score, equal scores in extension order
+        std::vector<AlignmentHit>& hits = context.hits;
+        for (size_t h = hits.size() - 1; h > 0 && hits[h - 1].score < hits[h].score; h--) {
+            std::swap(hits[h - 1], hits[h]);
+        }
+    });
+}
+
+/**
+ * Perform seed-and-extend alignment of query against an indexed reference.
+ *
+ * Seeds are chained first and only the best max_chains chains are extended,
+ * each from its longest anchor, ungapped or with the gapped X-drop DP. With
+ * max_edits set, a chain is extended only if the query matches the reference
+ * window its diagonal projects onto (widened by max_edits on either side)
+ * within max_edits edits; this also drops reads that would only align with
+ * clipped ends. The index is only read, so one index can serve many threads
+ * at once; its max_occurrences was fixed when it was built.
+ *
+ * Returns context.hits, valid until the context's next call.
+ */
+inline const std::vector<AlignmentHit>& seed_and_extend(const KmerIndex& index,
+                                                        const std::string& reference,
+                                                        const std::string& query,
+                                                        const SeedExtendOptions& options,
+                                                        SeedExtendContext& context) {
+    StageTimer timer(Stage::Seed);
+    find_seeds(query, index, options.max_hits, context.seeds);
+    merge_seeds(context.seeds, index.shape.span(), context.anchors);
+    timer.stop();
+    extend_anchors(reference, query, options, context);
+    return context.hits;
+}
+
+/**
+ * Perform seed-and-extend alignment of query against an indexed reference
+ * (see above), with this thread's buffers.
+ */
+inline std::vector<AlignmentHit> seed_and_extend(const KmerIndex& index,
+                                                 const std::string& reference,
+                                                 const std::string& query,
+                                                 const SeedExtendOptions& options = SeedExtendOptions()) {
+    thread_local SeedExtendContext context;
+    return seed_and_extend(index, reference, query, options, context);
+}
+
+/**
+ * Perform seed-and-extend alignment seeding with SMEMs from a bidirectional
+ * FM-index of reference.
+ *
+ * Each SMEM of at least min_smem_length bases with at most max_hits
+ * occurrences becomes one anchor per occurrence; chaining and extension
+ * are as for the k-mer index. Long unique matches give a handful of long
+ * anchors where a k-mer index gives one seed per k-mer, and a read
+ * position that no SMEM reaches has no exact match long enough to seed
+ * from. The index must be built over reference with the same coordinates
+ * (separators and ambiguous bases replaced by some base).
+ *
+ * Returns context.hits, valid until the context's next call.
+ */
+inline const std::vector<AlignmentHit>& seed_and_extend(const BidirectionalFMIndex& index,
+                                                        const std::string& reference,
+                                                        const std::string& query,
+                                                        const SeedExtendOptions& options,
+                                                        SeedExtendContext& context) {
+    StageTimer timer(Stage::Seed);
+    find_smem_anchors(query, index, options.min_smem_length, options.max_hits, context);
+    timer.stop();
+    extend_anchors(reference, query, options, context);
+    return context.hits;
+}
+
+/**
+ * Perform seed-and-extend alignment seeding with SMEMs (see above), with
+ * this thread's buffers.
+ */
+inline std::vector<AlignmentHit> seed_and_extend(const BidirectionalFMIndex& index,
+                                                 const std::string& reference,
+                                                 const std::string& query,
+                                                 const SeedExtendOptions& options = SeedExtendOptions()) {
+    thread_local SeedExtendContext context;
+    return seed_and_extend(index, reference, query, options, context);
+}
+
+/**
+ * Perform seed-and-extend alignment between query and reference.
+ *
+ * Builds a k-mer index of the reference with the given seed shape, then
+ * aligns as above.
+ */
+inline std::vector<AlignmentHit> seed_and_extend(const std::string& reference,
+                                                 const std::string& query,
+                                                 const SeedShape& shape,
+                                                 const SeedExtendOptions& options = SeedExtendOptions()) {
+    KmerIndex index = build_kmer_index(reference, shape, options.max_occurrences);
+    return seed_and_extend(index, reference, query, options);
+}
+
+/**
+ * Perform seed-and-extend alignment seeding with every contiguous k-mer.
+ */
+inline std::vector<AlignmentHit> seed_and_extend(const std::string& reference, 
+                                                 const std::string& query,
+                                                 int k = 11) {
+    return seed_and_extend(reference, query, SeedShape::contiguous(k));
+}
+
+#endif // SEED_AND_EXTEND_H
@@ -0,0 +1,398 @@
+/**
+ * Zero-Copy FASTA/FASTQ Input
+ *
+ * SequenceReader parses FASTA and FASTQ straight out of its input buffer:
+ * - Regular files are memory-mapped whole; records are string_views into the
+ *   mapping and nothing is copied or allocated per record
+ * - Pipes and stdin are read in large blocks; a record cut off by the end of
+ *   a block is carried over into the next block, which grows so that even a
+ *   multi-gigabyte record is copied only a constant number of times
+ *
+ * Record views stay valid for the lifetime of the reader on mapped files, but
+ * only until the next read on streams. next_batch() returns FASTQ records
+ * together with shared ownership of the buffers they point into, so a batch
+ * can be handed to another thread and outlive any later reads.
+ *
+ * read_reference() concatenates the contigs of a multi-FASTA file into one
+ * packed, upper-case sequence with an offset table, the form FMIndex and
+ * build_kmer_index() take directly.
+ *
+ * Compressed input is not decoded here; stream it through a pipe instead,
+ * e.g. `zcat reads.fq.gz | mapper ref.fa -`.
+ */
+
+#ifndef SEQ_IO_H
+#define SEQ_IO_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * FASTQ record; views into the reader's buffer.
+ */
+struct FastqRecord {
+    std::string_view name;     // Header up to the first whitespace, without '@'
+    std::string_view comment;  // Rest of the header line, possibly empty
+    std::string_view sequence;
+    std::string_view quality;
+};
+
+/**
+ * FASTA record; views into the reader's buffer.
+ *
+ * The sequence may be wrapped over several lines, so the record keeps the raw
+ * text between its header and the next one (line breaks included).
+ */
+struct FastaRecord {
+    std::string_view name;
+    std::string_view comment;
+    std::string_view data;
+
+    /**
+     * Append the sequence, line breaks removed, to out.
+     */
+    void append_sequence(std::string& out) const {
+        size_t pos = 0;
+        while (pos < data.size()) {
+            size_t eol = std::min(data.find('\n', pos), data.size());
+            size_t end = eol > pos && data[eol - 1] == '\r' ? eol - 1 : eol;
+            out.append(data.data() + pos, end - pos);
+            pos = eol + 1;
+        }
+    }
+
+    std::string sequence() const {
+        std::string out;
+        append_sequence(out);
+        return out;
+    }
+};
+
+/**
+ * FASTQ records that own (share) the buffers their views point into.
+ */
+struct FastqBatch {
+    std::vector<FastqRecord> records;
+    std::vector<std::shared_ptr<const void>> buffers;
+
+    void clear() {
+        records.clear();
+        buffers.clear();
+    }
+};
+
+/**
+ * Streaming FASTA/FASTQ parser over a memory mapping or a block-read stream.
+ */
+class SequenceReader {
+private:
+    int fd = -1;
+    bool mapped = false;
+    bool at_eof = false;
+    size_t block_size;
+    std::shared_ptr<const void> buffer;  // Mapping or current stream block
+    const char* cur = nullptr;
+    const char* end = nullptr;
+    std::string path;
+
+    /**
+     * Read more input after the unconsumed tail [cur, end); false at end of input.
+     */
+    bool refill() {
+        if (mapped || at_eof) {
+            return false;
+        }
+        size_t tail = end - cur;
+        auto block = std::make_shared<std::string>();
+        block->resize(tail + std::max(block_size, tail));
+        if (tail > 0) {
+            std::memcpy(&(*block)[0], cur, tail);
+        }
+        size_t filled = tail;
+        while (filled < block->size()) {
+            ssize_t got = ::read(fd, &(*block)[filled], block->size() - filled);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got < 0) {
+                throw std::runtime_error("SequenceReader: read error on " + path);
+            }
+            if (got == 0) {
+                at_eof = true;
+                break;
+            }
+            filled += got;
+        }
+        block->resize(filled);
+        cur = block->data();
+        end = cur + filled;
+        buffer = std::move(block);
+        return true;
+    }
+
+    /**
+     * Take the line starting at p, without its line break, and move p past it.
+     * Fails if p is at the end or the line is cut off by a block boundary.
+     */
+    bool take_line(const char*& p, std::string_view& line) const {
+        if (p >= end) {
+            return false;
+        }
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) {
+            if (!mapped && !at_eof) {
+                return false;
+            }
+            eol = end;
+        }
+        const char* stop = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+        line = std::string_view(p, stop - p);
+        p = eol < end ? eol + 1 : end;
+        return true;
+    }
+
+    /**
+     * Split a header line (marker included) into name and comment.
+     */
+    static void split_header(std::string_view header, std::string_view& name, std::string_view& comment) {
+        header.remove_prefix(1);
+        size_t space = header.find_first_of(" \t");
+        name = header.substr(0, space);
+        comment = space == std::string_view::npos ? std::string_view() : header.substr(space + 1);
+    }
+
+    void skip_blank_lines() {
+        while (true) {
+            while (cur < end && (*cur == '\n' || *cur == '\r')) {
+                cur++;
+            }
+            if (cur < end || !refill()) {
+                return;
+            }
+        }
+    }
+
+    bool try_parse(FastqRecord& record) {
+        const char* p = cur;
+        std::string_view header, plus;
+        if (!take_line(p, header) || !take_line(p, record.sequence) ||
+            !take_line(p, plus) || !take_line(p, record.quality)) {
+            return false;
+        }
+        if (header[0] != '@' || plus.empty() || plus[0] != '+' ||
+            record.sequence.size() != record.quality.size()) {
+            throw std::runtime_error("SequenceReader: malformed FASTQ record in " + path + ": " +
+                                     std::string(header));
+        }
+        split_header(header, record.name, record.comment);
+        cur = p;
+        return true;
+    }
+
+    bool try_parse(FastaRecord& record) {
+        const char* p = cur;
+        std::string_view header;
+        if (!take_line(p, header)) {
+            return false;
+        }
+        if (header[0] != '>') {
+            throw std::runtime_error("SequenceReader: " + path + " is not FASTA");
+        }
+        // The record runs to the next line that starts with '>'
+        const char* stop = p;
+        while (true) {
+            const char* next = static_cast<const char*>(std::memchr(stop, '>', end - stop));
+            if (!next) {
+                if (!mapped && !at_eof) {
+                    return false;
+                }
+                stop = end;
+                break;
+            }
+            if (next[-1] == '\n') {
+                stop = next;
+                break;
+            }
+            stop = next + 1;
+        }
+        split_header(header, record.name, record.comment);
+        record.data = std::string_view(p, stop - p);
+        cur = stop;
+        return true;
+    }
+
+    template <typename Record>
+    bool next_record(Record& record) {
+        skip_blank_lines();
+        if (cur >= end) {
+            return false;
+        }
+        while (!try_parse(record)) {
+            if (!refill()) {
+                throw std::runtime_error("SequenceReader: truncated record at end of " + path);
+            }
+        }
+        return true;
+    }
+
+public:
+    /**
+     * Open path for reading; "-" reads stdin.
+     *
+     * @throws runtime_error if the file cannot be opened
+     */
+    explicit SequenceReader(const std::string& path, size_t block_size = 16 << 20)
+        : block_size(std::max<size_t>(block_size, 4096)), path(path) {
+        fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("SequenceReader: cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            size_t size = st.st_size;
+            void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED) {
+                madvise(base, size, MADV_SEQUENTIAL);
+                buffer = std::shared_ptr<const void>(base, [size](const void* p) {
+                    munmap(const_cast<void*>(p), size);
+                });
+                cur = static_cast<const char*>(base);
+                end = cur + size;
+                mapped = true;
+            }
+        }
+        if (!mapped) {
+            refill();
+        }
+        if (end - cur >= 2 && static_cast<unsigned char>(cur[0]) == 0x1f &&
+            static_cast<unsigned char>(cur[1]) == 0x8b) {
+            if (fd > STDIN_FILENO) {
+                ::close(fd);
+            }
+            throw std::runtime_error("SequenceReader: " + path + " is gzip-compressed; "
+                                     "decompress it through a pipe");
+        }
+    }
+
+    ~SequenceReader() {
+        if (fd > STDIN_FILENO) {
+            ::close(fd);
+        }
+    }
+
+    SequenceReader(const SequenceReader&) = delete;
+    SequenceReader& operator=(const SequenceReader&) = delete;
+
+    /**
+     * True if the input is memory-mapped, so record views live as long as the reader.
+     */
+    bool is_mapped() const { return mapped; }
+
+    /**
+     * Parse the next FASTQ record; false at end of input.
+     *
+     * @throws runtime_error on a malformed or truncated record
+     */
+    bool next(FastqRecord& record) { return next_record(record); }
+
+    /**
+     * Parse the next FASTA record; false at end of input.
+     *
+     * @throws runtime_error if the input is not FASTA or the record is truncated
+     */
+    bool next(FastaRecord& record) { return next_record(record); }
+
+    /**
+     * Parse up to max_records FASTQ records into batch, keeping their buffers
+     * alive in it; false if there were none left.
+     */
+    bool next_batch(size_t max_records, FastqBatch& batch) {
+        batch.clear();
+        FastqRecord record;
+        while (batch.records.size() < max_records) {
+            if (!next(record)) {
+                break;
+            }
+            // A refill inside next() moves the record into a new block
+            if (batch.buffers.empty() || batch.buffers.back() != buffer) {
+                batch.buffers.push_back(buffer);
+            }
+            batch.records.push_back(record);
+        }
+        return !batch.records.empty();
+    }
+};
+
+/**
+ * One contig of a packed reference.
+ */
+struct Contig {
+    std::string name;
+    size_t offset = 0;  // Start in Reference::sequence
+    size_t length = 0;
+};
+
+/**
+ * Contigs of a multi-FASTA file concatenated into one sequence.
+ */
+struct Reference {
+    std::string sequence;
+    std::vector<Contig> contigs;
+
+    /**
+     * Contig holding position pos of the packed sequence (pos must not be a separator).
+     */
+    const Contig& contig_at(size_t pos) const {
+        auto it = std::upper_bound(contigs.begin(), contigs.end(), pos,
+                                   [](size_t p, const Contig& c) { return p < c.offset; });
+        return *(it - 1);
+    }
+};
+
+/**
+ * Load every contig of a FASTA file into one packed sequence.
+ *
+ * Bases are upper-cased and anything but ACGT becomes 'N'; contigs are
+ * joined by a single separator so that no seed or match spans two of them.
+ *
+ * @throws runtime_error if the file cannot be read or is not FASTA
+ */
+inline Reference read_reference(const std::string& path, char separator = 'N') {
+    static const auto normalize = [] {
+        std::vector<char> table(256, 'N');
+        for (const char* b = "ACGT"; *b; b++) {
+            table[static_cast<unsigned char>(*b)] = *b;
+            table[static_cast<unsigned char>(*b + ('a' - 'A'))] = *b;
+        }
+        return table;
+    }();
+
+    SequenceReader reader(path);
+    Reference reference;
+    FastaRecord record;
+    while (reader.next(record)) {
+        if (!reference.contigs.empty()) {
+            reference.sequence += separator;
+        }
+        size_t offset = reference.sequence.size();
+        record.append_sequence(reference.sequence);
+        for (size_t i = offset; i < reference.sequence.size(); i++) {
+            reference.sequence[i] = normalize[static_cast<unsigned char>(reference.sequence[i])];
+        }
+        reference.contigs.push_back({std::string(record.name), offset, reference.sequence.size() - offset});
+    }
+    return reference;
+}
+
+#endif // SEQ_IO_H
@@ -1,108 +1,256 @@
 /**
- * Smith-Waterman Algorithm for Local Sequence Alignment
- * 
- * This is a dynamic programming algorithm for performing local sequence alignment.
- * It finds the optimal local alignment between two sequences by maximizing the alignment score.
- * 
- * Time Complexity: O(m * n) where m and n are the lengths of the sequences
- * Space Complexity: O(m * n)
+ * Smith-Waterman: the match/mismatch entry points and the inter-sequence
+ * batch kernels, compiled once per instruction set and picked at run time
+ * (see smith_waterman.h).
  */
 
-#include <iostream>
-#include <vector>
-#include <string>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cpu_dispatch.h"
+#include "smith_waterman.h"
 
 using namespace std;
 
-struct Alignment {
-    string aligned_seq1;
-    string aligned_seq2;
-    int score;
-};
+AlignmentResult smith_waterman_cigar(const string& seq1, const string& seq2,
+                                     int match_score,
+                                     int mismatch_penalty,
+                                     int gap_penalty) {
+    return smith_waterman_cigar(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                         LinearGap{gap_penalty}));
+}
+
+const AlignmentResult& smith_waterman_cigar(const string& seq1, const string& seq2,
+                                            AlignerContext& context,
+                                            int match_score,
+                                            int mismatch_penalty,
+                                            int gap_penalty) {
+    return smith_waterman_cigar(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                         LinearGap{gap_penalty}),
+                                context);
+}
+
+Alignment smith_waterman(const string& seq1, const string& seq2,
+                        int match_score,
+                        int mismatch_penalty,
+                        int gap_penalty) {
+    AlignmentResult result = smith_waterman_cigar(seq1, seq2, match_score, mismatch_penalty, gap_penalty);
+    auto rows = result.render();
+    return {rows.first, rows.second, result.score};
+}
+
+// The kernel's vector helpers are always inlined into ISA-specific wrappers, so
+// the by-value vector ABI warnings (reported at end of file) do not apply
+#pragma GCC diagnostic ignored "-Wpsabi"
 
 /**
- * Perform local sequence alignment using Smith-Waterman algorithm.
- * 
- * @param seq1 First sequence
- * @param seq2 Second sequence
- * @param match_score Score for matching characters (default: 2)
- * @param mismatch_penalty Penalty for mismatching characters (default: -1)
- * @param gap_penalty Penalty for gaps (default: -1)
- * @return Alignment structure containing aligned sequences and score
+ * Inter-sequence (SWIPE-style) Smith-Waterman: one query against many targets.
+ *
+ * Each 16-bit vector lane holds a different target, so a vector step advances
+ * the same cell (i, j) of LANES independent alignments; no cross-lane
+ * dependencies exist and no lazy-F correction is needed. Targets are grouped by
+ * length to keep padding low; the padding symbol (256) never matches and
+ * scores as a mismatch, which is never positive here (positive mismatch
+ * scores take the scalar fallback), so padded columns cannot raise a lane's
+ * maximum.
+ *
+ * Scores are kept in unsigned lanes of type T, floored at 0, with the substitution score biased
+ * by -mismatch. Lanes whose maximum could have overflowed are flagged with
+ * score -1 for the caller to recompute. The end cell is tracked in lanes of
+ * type E, which must hold the query and target lengths.
  */
-Alignment smith_waterman(const string& seq1, const string& seq2,
-                        int match_score = 2,
-                        int mismatch_penalty = -1,
-                        int gap_penalty = -1) {
-    int m = seq1.length();
-    int n = seq2.length();
+template <typename T, typename E, size_t BYTES>
+static inline __attribute__((always_inline))
+void sw_batch_kernel(const string& query, const vector<string>& targets,
+                     int match_score, int mismatch_penalty, int gap_penalty,
+                     vector<BatchScore>& out) {
+    typedef T V __attribute__((vector_size(BYTES)));
+    struct alignas(BYTES) Slot {
+        V v;
+    };
+    const size_t LANES = BYTES / sizeof(T);
+    typedef E VE __attribute__((vector_size(LANES * sizeof(E))));
+    typedef make_signed_t<E> ME __attribute__((vector_size(LANES * sizeof(E))));
+    const int64_t MAX = numeric_limits<T>::max();
     
-    // Initialize DP matrix with zeros (key difference from Needleman-Wunsch)
-    vector<vector<int>> dp(m + 1, vector<int>(n + 1, 0));
-    int max_score = 0;
-    int max_i = 0, max_j = 0;
+    int64_t bias = max(0, -mismatch_penalty);
+    int64_t top = max(match_score, mismatch_penalty) + bias;
     
-    // Fill DP matrix
-    for (int i = 1; i <= m; i++) {
-        for (int j = 1; j <= n; j++) {
-            int match = dp[i-1][j-1] + (seq1[i-1] == seq2[j-1] ? match_score : mismatch_penalty);
-            int del = dp[i-1][j] + gap_penalty;
-            int insert = dp[i][j-1] + gap_penalty;
-            
-            // Key difference: allow zero (no negative scores)
-            dp[i][j] = max({0, match, del, insert});
+    const V zero = {};
+    const VE zero_e = {};
+    const V v_match = zero + T(match_score + bias);
+    const V v_mismatch = zero + T(mismatch_penalty + bias);
+    const V v_bias = zero + T(bias);
+    const V v_gap = zero + T(-gap_penalty);
+    const V v_limit = zero + T(MAX - top);
+    
+    auto vmax = [](const V& a, const V& b) __attribute__((always_inline)) { return a > b ? a : b; };
+    auto sub_floor = [](const V& a, const V& b) __attribute__((always_inline)) { return a - (a < b ? a : b); };
+    
+    size_t m = query.length();
+    vector<size_t> order(targets.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&targets](size_t a, size_t b) {
+        return targets[a].length() < targets[b].length();
+    });
+    
+    vector<Slot> h(m);
+    vector<Slot> columns;
+    
+    for (size_t group = 0; group < order.size(); group += LANES) {
+        size_t lanes = min(LANES, order.size() - group);
+        size_t n = targets[order[group + lanes - 1]].length();
+        
+        // Column j holds target character j of every lane (256 = padding)
+        columns.assign(n, Slot{zero + T(256)});
+        for (size_t lane = 0; lane < lanes; lane++) {
+            const string& t = targets[order[group + lane]];
+            for (size_t j = 0; j < t.length(); j++) {
+                columns[j].v[lane] = static_cast<unsigned char>(t[j]);
+            }
+        }
+        
+        fill(h.begin(), h.end(), Slot{zero});
+        V v_max = zero;
+        VE end1 = zero_e;
+        VE end2 = zero_e;
+        
+        for (size_t j = 0; j < n; j++) {
+            const V t = columns[j].v;
+            const VE v_j = zero_e + E(j + 1);
+            V diag = zero;  // H[i-1][j-1]
+            V up = zero;    // H[i-1][j]
             
-            // Track maximum score position
-            if (dp[i][j] > max_score) {
-                max_score = dp[i][j];
-                max_i = i;
-                max_j = j;
+            for (size_t i = 0; i < m; i++) {
+                V q = zero + T(static_cast<unsigned char>(query[i]));
+                V left = h[i].v;  // H[i][j-1]
+                V score = q == t ? v_match : v_mismatch;
+                V cell = sub_floor(diag + score, v_bias);
+                cell = vmax(cell, sub_floor(up, v_gap));
+                cell = vmax(cell, sub_floor(left, v_gap));
+                h[i].v = cell;
+                diag = left;
+                up = cell;
+                
+                auto better = cell > v_max;
+                v_max = better ? cell : v_max;
+                ME better_e = __builtin_convertvector(better, ME);
+                end1 = better_e ? zero_e + E(i + 1) : end1;
+                end2 = better_e ? v_j : end2;
             }
         }
-    }
-    
-    // Traceback from maximum score position
-    string aligned_seq1 = "";
-    string aligned_seq2 = "";
-    int i = max_i, j = max_j;
-    
-    while (i > 0 && j > 0 && dp[i][j] > 0) {
-        int current_score = dp[i][j];
-        int diagonal_score = dp[i-1][j-1] + (seq1[i-1] == seq2[j-1] ? match_score : mismatch_penalty);
         
-        if (current_score == diagonal_score) {
-            aligned_seq1 = seq1[i-1] + aligned_seq1;
-            aligned_seq2 = seq2[j-1] + aligned_seq2;
-            i--;
-            j--;
-        } else if (current_score == dp[i-1][j] + gap_penalty) {
-            aligned_seq1 = seq1[i-1] + aligned_seq1;
-            aligned_seq2 = "-" + aligned_seq2;
-            i--;
-        } else {
-            aligned_seq1 = "-" + aligned_seq1;
-            aligned_seq2 = seq2[j-1] + aligned_seq2;
-            j--;
+        auto overflow = v_max > v_limit;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            BatchScore& r = out[order[group + lane]];
+            if (overflow[lane]) {
+                r = {-1, 0, 0};
+            } else {
+                r = {int(v_max[lane]), int(end1[lane]), int(end2[lane])};
+            }
         }
     }
-    
-    return {aligned_seq1, aligned_seq2, max_score};
 }
 
-int main() {
-    // Example usage
-    string seq1 = "GGTTGACTA";
-    string seq2 = "TGTTACGG";
+typedef void (*SwBatchFn)(const string&, const vector<string>&, int, int, int, bool, vector<BatchScore>&);
+
+// Define the batch wrapper of one ISA; ATTR selects the instruction set. End
+// cells past 65535 need 32-bit lanes, which only sequences that long pay for
+#define SW_BATCH_VARIANT(NAME, ATTR, BYTES)                                                     \
+    ATTR static void sw_batch_##NAME(const string& q, const vector<string>& t, int ms,          \
+                                     int mm, int g, bool wide_ends, vector<BatchScore>& out) {  \
+        if (wide_ends) {                                                                        \
+            sw_batch_kernel<uint16_t, uint32_t, BYTES>(q, t, ms, mm, g, out);                   \
+        } else {                                                                                \
+            sw_batch_kernel<uint16_t, uint16_t, BYTES>(q, t, ms, mm, g, out);                   \
+        }                                                                                       \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+SW_BATCH_VARIANT(avx512, __attribute__((target("avx512bw"))), 64)
+SW_BATCH_VARIANT(avx2, __attribute__((target("avx2"))), 32)
+#endif
+// Baseline build: NEON on AArch64, SSE2 on x86-64, plain vector code elsewhere
+SW_BATCH_VARIANT(generic, , 16)
+
+#undef SW_BATCH_VARIANT
+
+/**
+ * Select the widest batch kernel the running CPU supports (detected once).
+ */
+static SwBatchFn sw_batch_kernel_for_cpu() {
+    static const SwBatchFn kernel = []() -> SwBatchFn {
+#if defined(__x86_64__) || defined(__i386__)
+        if (ALIGN_CPU_SUPPORTS("avx512bw")) {
+            return sw_batch_avx512;
+        }
+        if (ALIGN_CPU_SUPPORTS("avx2")) {
+            return sw_batch_avx2;
+        }
+#endif
+        return sw_batch_generic;
+    }();
+    return kernel;
+}
+
+vector<BatchScore> smith_waterman_batch(const string& query, const vector<string>& targets,
+                                        int match_score,
+                                        int mismatch_penalty,
+                                        int gap_penalty) {
+    vector<BatchScore> scores(targets.size(), BatchScore{0, 0, 0});
     
-    Alignment result = smith_waterman(seq1, seq2);
+    bool simd = match_score + max(0, -mismatch_penalty) <= numeric_limits<uint16_t>::max() / 2 &&
+                gap_penalty <= 0 && -gap_penalty <= numeric_limits<uint16_t>::max() &&
+                mismatch_penalty <= match_score && mismatch_penalty <= 0;
+    if (simd) {
+        uint64_t cells = 0;
+        size_t longest = query.length();
+        for (const string& target : targets) {
+            cells += uint64_t(query.length()) * target.length();
+            longest = max(longest, target.length());
+        }
+        bool wide_ends = longest > numeric_limits<uint16_t>::max();
+        sw_batch_kernel_for_cpu()(query, targets, match_score, mismatch_penalty, gap_penalty, wide_ends, scores);
+        metrics_count(Metric::DPCells, cells);
+    }
     
-    cout << "Smith-Waterman Local Alignment" << endl;
-    cout << "Sequence 1: " << seq1 << endl;
-    cout << "Sequence 2: " << seq2 << endl;
-    cout << "\nAligned Sequence 1: " << result.aligned_seq1 << endl;
-    cout << "Aligned Sequence 2: " << result.aligned_seq2 << endl;
-    cout << "Alignment Score: " << result.score << endl;
+    // Overflowed lanes and unsupported parameters fall back to the scalar aligner
+    for (size_t t = 0; t < targets.size(); t++) {
+        if (!simd || scores[t].score < 0) {
+            scores[t] = {smith_waterman(query, targets[t], match_score, mismatch_penalty, gap_penalty).score,
+                         -1, -1};
+        }
+    }
+    return scores;
+}
+
+vector<pair<size_t, Alignment>> smith_waterman_batch_align(const string& query,
+                                                           const vector<string>& targets,
+                                                           int min_score,
+                                                           int match_score,
+                                                           int mismatch_penalty,
+                                                           int gap_penalty) {
+    vector<BatchScore> scores = smith_waterman_batch(query, targets, match_score, mismatch_penalty, gap_penalty);
     
-    return 0;
+    vector<pair<size_t, Alignment>> hits;
+    for (size_t t = 0; t < targets.size(); t++) {
+        if (scores[t].score < min_score) {
+            continue;
+        }
+        if (scores[t].end1 >= 0) {
+            hits.push_back({t, smith_waterman(query.substr(0, scores[t].end1),
+                                              targets[t].substr(0, scores[t].end2),
+                                              match_score, mismatch_penalty, gap_penalty)});
+        } else {
+            hits.push_back({t, smith_waterman(query, targets[t], match_score, mismatch_penalty, gap_penalty)});
+        }
+    }
+    return hits;
 }
@@ -0,0 +1,216 @@
+/**
+ * Smith-Waterman Algorithm for Local Sequence Alignment
+ * 
+ * This is a dynamic programming algorithm for performing local sequence alignment.
+ * It finds the optimal local alignment between two sequences by maximizing the alignment score.
+ * 
+ * Time Complexity: O(m * n) where m and n are the lengths of the sequences
+ * Space Complexity: O(m * n) bits: 2 bits of traceback per cell plus two score rows
+ */
+
+#ifndef SMITH_WATERMAN_H
+#define SMITH_WATERMAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+#include "aligner_context.h"
+#include "dp_matrix.h"
+#include "cigar.h"
+#include "metrics.h"
+#include "scoring.h"
+
+/**
+ * Smith-Waterman alignment of seq1 against seq2 into result, with all
+ * scratch memory taken from arena.
+ */
+template <typename ScoringPolicy>
+void smith_waterman_into(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                         ScratchArena& arena, AlignmentResult& result) {
+    static_assert(ScoringPolicy::gap_type::linear, "smith_waterman takes a linear gap model");
+    int m = seq1.length();
+    int n = seq2.length();
+    const int gap_penalty = scoring.gap.extend();
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    metrics_count(Metric::DPCells, uint64_t(m) * n);
+    
+    // Two rows of scores, initialized with zeros (key difference from Needleman-Wunsch);
+    // the move that produced each cell is kept as a 2-bit code
+    enum { STOP = 0, DIAG = 1, UP = 2, LEFT = 3 };
+    int* prev_row = arena.allocate<int>(n + 1);
+    int* curr_row = arena.allocate<int>(n + 1);
+    std::fill(prev_row, prev_row + n + 1, 0);
+    std::fill(curr_row, curr_row + n + 1, 0);
+    TracebackMatrix<2> trace(m + 1, n + 1, arena);
+    int max_score = 0;
+    int max_i = 0, max_j = 0;
+    
+    // Fill DP matrix
+    for (int i = 1; i <= m; i++) {
+        auto substitution = profile.row(seq1[i-1]);
+        for (int j = 1; j <= n; j++) {
+            int match = prev_row[j-1] + substitution[j-1];
+            int del = prev_row[j] + gap_penalty;
+            int insert = curr_row[j-1] + gap_penalty;
+            
+            // Key difference: allow zero (no negative scores)
+            int best = std::max({0, match, del, insert});
+            curr_row[j] = best;
+            if (best > 0) {
+                trace.set(i, j, best == match ? DIAG : best == del ? UP : LEFT);
+            }
+            
+            // Track maximum score position
+            if (best > max_score) {
+                max_score = best;
+                max_i = i;
+                max_j = j;
+            }
+        }
+        
+        std::swap(prev_row, curr_row);
+    }
+    
+    // Traceback from maximum score position until a zero cell
+    result.cigar.clear();
+    int i = max_i, j = max_j;
+    
+    for (uint8_t move = trace.get(i, j); move != STOP; move = trace.get(i, j)) {
+        if (move == DIAG) {
+            result.cigar.push('M');
+            i--;
+            j--;
+        } else if (move == UP) {
+            result.cigar.push('I');
+            i--;
+        } else {
+            result.cigar.push('D');
+            j--;
+        }
+    }
+    result.cigar.reverse();
+    
+    result.score = max_score;
+    result.start1 = i;
+    result.end1 = max_i;
+    result.start2 = j;
+    result.end2 = max_j;
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+}
+
+/**
+ * Perform local sequence alignment using Smith-Waterman algorithm.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param scoring Substitution policy and linear gap model (see scoring.h)
+ * @return Score, aligned regions and CIGAR of the best local alignment, viewing seq1 and seq2
+ */
+template <typename ScoringPolicy>
+AlignmentResult smith_waterman_cigar(const std::string& seq1, const std::string& seq2,
+                                     const ScoringPolicy& scoring) {
+    AlignmentResult result;
+    smith_waterman_into(seq1, seq2, scoring, AlignerContext::local().arena, result);
+    return result;
+}
+
+/**
+ * Smith-Waterman alignment reusing context: no heap allocation once the
+ * context has aligned a pair this large.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+template <typename ScoringPolicy>
+const AlignmentResult& smith_waterman_cigar(const std::string& seq1, const std::string& seq2,
+                                            const ScoringPolicy& scoring, AlignerContext& context) {
+    smith_waterman_into(seq1, seq2, scoring, context.arena, context.result);
+    return context.result;
+}
+
+/**
+ * Perform local sequence alignment using Smith-Waterman algorithm.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param match_score Score for matching characters (default: 2)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_penalty Penalty for gaps (default: -1)
+ * @return Score, aligned regions and CIGAR of the best local alignment, viewing seq1 and seq2
+ */
+AlignmentResult smith_waterman_cigar(const std::string& seq1, const std::string& seq2,
+                                     int match_score = 2,
+                                     int mismatch_penalty = -1,
+                                     int gap_penalty = -1);
+
+/**
+ * Smith-Waterman alignment with match/mismatch scoring, reusing context.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+const AlignmentResult& smith_waterman_cigar(const std::string& seq1, const std::string& seq2,
+                                            AlignerContext& context,
+                                            int match_score = 2,
+                                            int mismatch_penalty = -1,
+                                            int gap_penalty = -1);
+
+/**
+ * Perform local sequence alignment using Smith-Waterman algorithm.
+ * 
+ * @return Alignment structure containing aligned sequences and score
+ */
+Alignment smith_waterman(const std::string& seq1, const std::string& seq2,
+                        int match_score = 2,
+                        int mismatch_penalty = -1,
+                        int gap_penalty = -1);
+
+/**
+ * Best local score of one target in a batch, with the cell where it ends.
+ *
+ * end1/end2 are one past the last aligned position in the query and target;
+ * both are 0 when the score is 0, and -1 when the scalar fallback produced the score.
+ */
+struct BatchScore {
+    int score;
+    int end1;
+    int end2;
+};
+
+/**
+ * Score one query against many targets with inter-sequence SIMD.
+ *
+ * @param query Query sequence
+ * @param targets Target sequences
+ * @param match_score Score for matching characters (default: 2)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_penalty Penalty for gaps (default: -1)
+ * @return Best local score and end cell for each target, in input order
+ */
+std::vector<BatchScore> smith_waterman_batch(const std::string& query, const std::vector<std::string>& targets,
+                                             int match_score = 2,
+                                             int mismatch_penalty = -1,
+                                             int gap_penalty = -1);
+
+/**
+ * Align one query against many targets, tracing back only the good hits.
+ *
+ * Scores every target with smith_waterman_batch() and runs the full
+ * smith_waterman() traceback only for targets scoring at least min_score. The
+ * traceback is limited to the prefixes ending at the reported end cell.
+ *
+ * @param min_score Minimum score for a target to be aligned
+ * @return (target index, alignment) for every target with score >= min_score, in input order
+ */
+std::vector<std::pair<size_t, Alignment>> smith_waterman_batch_align(const std::string& query,
+                                                                     const std::vector<std::string>& targets,
+                                                                     int min_score,
+                                                                     int match_score = 2,
+                                                                     int mismatch_penalty = -1,
+                                                                     int gap_penalty = -1);
+
+#endif // SMITH_WATERMAN_H
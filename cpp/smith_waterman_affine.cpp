@@ -1,207 +1,292 @@
 /**
- * Smith-Waterman Algorithm with Affine Gap Penalties for Local Sequence Alignment
- * 
- * This is an advanced version of the Smith-Waterman algorithm that uses affine gap penalties.
- * Affine gap penalty = gap_open + k * gap_extend (where k is the gap length)
- * This is more biologically realistic as it penalizes gap opening more than gap extension.
- * 
- * Uses three matrices:
- * - M[i][j]: optimal score ending with match/mismatch
- * - I[i][j]: optimal score ending with insertion (gap in seq1)
- * - D[i][j]: optimal score ending with deletion (gap in seq2)
- * 
- * Time Complexity: O(m * n) where m and n are the lengths of the sequences
- * Space Complexity: O(m * n)
+ * Smith-Waterman with affine gaps: the match/mismatch entry points and the
+ * striped score-only kernels, compiled once per instruction set and picked at
+ * run time (see smith_waterman_affine.h).
  */
 
-#include <iostream>
-#include <vector>
-#include <string>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cpu_dispatch.h"
+#include "smith_waterman_affine.h"
 
 using namespace std;
 
-struct Alignment {
-    string aligned_seq1;
-    string aligned_seq2;
-    int score;
-};
+AlignmentResult smith_waterman_affine_cigar(const string& seq1, const string& seq2,
+                                            int match_score,
+                                            int mismatch_penalty,
+                                            int gap_open,
+                                            int gap_extend) {
+    return smith_waterman_affine_cigar(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                                AffineGap{gap_open, gap_extend}));
+}
+
+const AlignmentResult& smith_waterman_affine_cigar(const string& seq1, const string& seq2,
+                                                   AlignerContext& context,
+                                                   int match_score,
+                                                   int mismatch_penalty,
+                                                   int gap_open,
+                                                   int gap_extend) {
+    return smith_waterman_affine_cigar(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                                AffineGap{gap_open, gap_extend}), context);
+}
+
+Alignment smith_waterman_affine(const string& seq1, const string& seq2,
+                                int match_score,
+                                int mismatch_penalty,
+                                int gap_open,
+                                int gap_extend) {
+    AlignmentResult result = smith_waterman_affine_cigar(seq1, seq2, match_score, mismatch_penalty,
+                                                         gap_open, gap_extend);
+    auto rows = result.render();
+    return {rows.first, rows.second, result.score};
+}
+
+LocalScore smith_waterman_affine_score_only(const string& seq1, const string& seq2,
+                                            int match_score,
+                                            int mismatch_penalty,
+                                            int gap_open,
+                                            int gap_extend) {
+    return smith_waterman_affine_score_only(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                                     AffineGap{gap_open, gap_extend}));
+}
+
+LocalScore smith_waterman_affine_score_only(const string& seq1, const string& seq2,
+                                            AlignerContext& context,
+                                            int match_score,
+                                            int mismatch_penalty,
+                                            int gap_open,
+                                            int gap_extend) {
+    return smith_waterman_affine_score_only(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                                     AffineGap{gap_open, gap_extend}), context);
+}
+
+AlignmentResult smith_waterman_affine_linear_cigar(const string& seq1, const string& seq2,
+                                                   int match_score,
+                                                   int mismatch_penalty,
+                                                   int gap_open,
+                                                   int gap_extend) {
+    return smith_waterman_affine_linear_cigar(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                                       AffineGap{gap_open, gap_extend}));
+}
+
+const AlignmentResult& smith_waterman_affine_linear_cigar(const string& seq1, const string& seq2,
+                                                          AlignerContext& context,
+                                                          int match_score,
+                                                          int mismatch_penalty,
+                                                          int gap_open,
+                                                          int gap_extend) {
+    return smith_waterman_affine_linear_cigar(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                                       AffineGap{gap_open, gap_extend}), context);
+}
+
+Alignment smith_waterman_affine_linear(const string& seq1, const string& seq2,
+                                       int match_score,
+                                       int mismatch_penalty,
+                                       int gap_open,
+                                       int gap_extend) {
+    AlignmentResult result = smith_waterman_affine_linear_cigar(seq1, seq2, match_score, mismatch_penalty,
+                                                                gap_open, gap_extend);
+    auto rows = result.render();
+    return {rows.first, rows.second, result.score};
+}
 
 /**
- * Perform local sequence alignment using Smith-Waterman algorithm with affine gap penalties.
- * 
- * @param seq1 First sequence
- * @param seq2 Second sequence
- * @param match_score Score for matching characters (default: 2)
- * @param mismatch_penalty Penalty for mismatching characters (default: -1)
- * @param gap_open Penalty for opening a gap (default: -3)
- * @param gap_extend Penalty for extending a gap (default: -1)
- * @return Alignment structure containing aligned sequences and score
+ * Striped (Farrar) Smith-Waterman with affine gaps, score only.
+ *
+ * The query (seq1) is split into LANES interleaved segments so that query
+ * position i = lane * seg_len + seg sits in vector seg, lane lane. A query
+ * profile holds the substitution scores of each target character in that
+ * layout, so every cell update is a handful of vector adds and maxes. Vertical
+ * gaps that cross segment boundaries are resolved by the lazy-F loop, which
+ * usually exits after one pass.
+ *
+ * Lanes are unsigned: the profile is biased by its lowest score so it is never negative,
+ * and all scores are floored at 0 (flooring I and D as smith_waterman_affine()
+ * does leaves local scores unchanged). Returns -1 if a score could overflow T or
+ * the scoring parameters do not fit, so the caller can retry with wider lanes.
+ *
+ * Instantiated once per ISA from a target-specific wrapper below, which is why it
+ * must be always_inline: the vector code is then compiled for the wrapper's ISA.
  */
-Alignment smith_waterman_affine(const string& seq1, const string& seq2,
-                                int match_score = 2,
-                                int mismatch_penalty = -1,
-                                int gap_open = -3,
-                                int gap_extend = -1) {
-    int m = seq1.length();
-    int n = seq2.length();
+// The kernel's vector helpers are always inlined into ISA-specific wrappers, so
+// the by-value vector ABI warnings (reported at end of file) do not apply
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <typename T, size_t BYTES, size_t... I>
+static inline __attribute__((always_inline))
+int sw_striped_kernel(const SwStripedProfile& query, const string& target,
+                      int gap_open, int gap_extend, index_sequence<I...>) {
+    typedef T V __attribute__((vector_size(BYTES)));
+    struct alignas(BYTES) Slot {
+        V v;
+    };
+    const size_t LANES = BYTES / sizeof(T);
+    const int64_t MAX = numeric_limits<T>::max();
     
-    const int NEG_INF = -1000000;
+    int64_t bias = max(0, -query.min_score);
+    int64_t top = query.max_score + bias;
+    int64_t gap_o = -(int64_t(gap_open) + gap_extend);  // Cost of a gap's first character
+    int64_t gap_e = -int64_t(gap_extend);
+    if (top > MAX || gap_o < 0 || gap_o > MAX || gap_e < 0 || gap_e > MAX) {
+        return -1;
+    }
+    if (query.length == 0 || target.empty()) {
+        return 0;
+    }
     
-    // Initialize three matrices: M (match), I (insert), D (delete)
-    vector<vector<int>> M(m + 1, vector<int>(n + 1, 0));
-    vector<vector<int>> I(m + 1, vector<int>(n + 1, NEG_INF));
-    vector<vector<int>> D(m + 1, vector<int>(n + 1, NEG_INF));
+    const V zero = {};
+    const V v_bias = zero + T(bias);
+    const V v_gap_o = zero + T(gap_o);
+    const V v_gap_e = zero + T(gap_e);
+    const V v_limit = zero + T(MAX - top);  // Any H above this may overflow on the next add
+    const V shift_mask = {(I == 0 ? T(LANES) : T(I - 1))...};
     
-    int max_score = 0;
-    int max_i = 0, max_j = 0;
-    char max_matrix = 'M';
+    auto vmax = [](const V& a, const V& b) __attribute__((always_inline)) { return a > b ? a : b; };
+    auto sub_floor = [](const V& a, const V& b) __attribute__((always_inline)) { return a - (a < b ? a : b); };
+    auto shift = [&](const V& a) __attribute__((always_inline)) { return __builtin_shuffle(a, zero, shift_mask); };
+    auto any_greater = [](const V& a, const V& b) __attribute__((always_inline)) {
+        auto mask = a > b;
+        uint64_t words[BYTES / 8];
+        memcpy(words, &mask, BYTES);
+        uint64_t any = 0;
+        for (size_t w = 0; w < BYTES / 8; w++) {
+            any |= words[w];
+        }
+        return any != 0;
+    };
     
-    // Fill DP matrices
-    for (int i = 1; i <= m; i++) {
-        for (int j = 1; j <= n; j++) {
-            // Calculate I[i][j] - gap in seq2 (insertion)
-            I[i][j] = max({0,
-                          M[i][j-1] + gap_open + gap_extend,
-                          I[i][j-1] + gap_extend,
-                          D[i][j-1] + gap_open + gap_extend});
-            
-            // Calculate D[i][j] - gap in seq1 (deletion)
-            D[i][j] = max({0,
-                          M[i-1][j] + gap_open + gap_extend,
-                          I[i-1][j] + gap_open + gap_extend,
-                          D[i-1][j] + gap_extend});
-            
-            // Calculate M[i][j] - match/mismatch
-            int match_mismatch_score = (seq1[i-1] == seq2[j-1]) ? match_score : mismatch_penalty;
-            M[i][j] = max({0,
-                          M[i-1][j-1] + match_mismatch_score,
-                          I[i-1][j-1] + match_mismatch_score,
-                          D[i-1][j-1] + match_mismatch_score});
-            
-            // Track maximum score across all three matrices
-            if (M[i][j] >= max_score) {
-                max_score = M[i][j];
-                max_i = i;
-                max_j = j;
-                max_matrix = 'M';
-            }
-            if (I[i][j] >= max_score) {
-                max_score = I[i][j];
-                max_i = i;
-                max_j = j;
-                max_matrix = 'I';
-            }
-            if (D[i][j] >= max_score) {
-                max_score = D[i][j];
-                max_i = i;
-                max_j = j;
-                max_matrix = 'D';
+    size_t m = query.length;
+    size_t seg_len = (m + LANES - 1) / LANES;
+    const uint16_t* row_of = query.row_of;
+    
+    // Stripe the profile: one row per target residue. Padding positions past
+    // the end of the query score 0 - bias and are never shifted back into real positions
+    size_t rows = query.scores.size() / m;
+    vector<Slot> profile(rows * seg_len, Slot{zero});
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t seg = 0; seg < seg_len; seg++) {
+            V& v = profile[r * seg_len + seg].v;
+            for (size_t lane = 0; lane < LANES; lane++) {
+                size_t i = lane * seg_len + seg;
+                if (i < m) {
+                    v[lane] = T(query.scores[r * m + i] + bias);
+                }
             }
         }
     }
     
-    // Traceback from maximum score position
-    string aligned_seq1 = "";
-    string aligned_seq2 = "";
-    int i = max_i, j = max_j;
-    char current_matrix = max_matrix;
+    vector<Slot> h_store(seg_len, Slot{zero});
+    vector<Slot> h_load(seg_len, Slot{zero});
+    vector<Slot> e(seg_len, Slot{zero});
+    V v_max = zero;
     
-    while (i > 0 && j > 0) {
-        if (current_matrix == 'M') {
-            if (M[i][j] <= 0) break;
-            
-            int match_mismatch_score = (seq1[i-1] == seq2[j-1]) ? match_score : mismatch_penalty;
-            
-            if (M[i][j] == M[i-1][j-1] + match_mismatch_score) {
-                aligned_seq1 = seq1[i-1] + aligned_seq1;
-                aligned_seq2 = seq2[j-1] + aligned_seq2;
-                i--;
-                j--;
-                current_matrix = 'M';
-            } else if (M[i][j] == I[i-1][j-1] + match_mismatch_score) {
-                aligned_seq1 = seq1[i-1] + aligned_seq1;
-                aligned_seq2 = seq2[j-1] + aligned_seq2;
-                i--;
-                j--;
-                current_matrix = 'I';
-            } else if (M[i][j] == D[i-1][j-1] + match_mismatch_score) {
-                aligned_seq1 = seq1[i-1] + aligned_seq1;
-                aligned_seq2 = seq2[j-1] + aligned_seq2;
-                i--;
-                j--;
-                current_matrix = 'D';
-            } else {
-                break;
-            }
-        } else if (current_matrix == 'I') {
-            if (I[i][j] <= 0) break;
-            
-            aligned_seq1 = "-" + aligned_seq1;
-            aligned_seq2 = seq2[j-1] + aligned_seq2;
-            j--;
+    for (char c : target) {
+        const Slot* prof = &profile[row_of[static_cast<unsigned char>(c)] * seg_len];
+        V v_f = zero;
+        V v_h = shift(h_store[seg_len - 1].v);
+        swap(h_store, h_load);
+        
+        for (size_t seg = 0; seg < seg_len; seg++) {
+            v_h = sub_floor(v_h + prof[seg].v, v_bias);
+            v_max = vmax(v_max, v_h);
             
-            if (I[i][j] == M[i][j-1] + gap_open + gap_extend) {
-                current_matrix = 'M';
-            } else if (I[i][j] == I[i][j-1] + gap_extend) {
-                current_matrix = 'I';
-            } else if (I[i][j] == D[i][j-1] + gap_open + gap_extend) {
-                current_matrix = 'D';
-            } else {
-                break;
-            }
-        } else { // current_matrix == 'D'
-            if (D[i][j] <= 0) break;
-            
-            aligned_seq1 = seq1[i-1] + aligned_seq1;
-            aligned_seq2 = "-" + aligned_seq2;
-            i--;
+            V v_e = e[seg].v;
+            v_h = vmax(vmax(v_h, v_e), v_f);
+            h_store[seg].v = v_h;
             
-            if (D[i][j] == M[i-1][j] + gap_open + gap_extend) {
-                current_matrix = 'M';
-            } else if (D[i][j] == D[i-1][j] + gap_extend) {
-                current_matrix = 'D';
-            } else if (D[i][j] == I[i-1][j] + gap_open + gap_extend) {
-                current_matrix = 'I';
-            } else {
-                break;
+            V h_gap = sub_floor(v_h, v_gap_o);
+            e[seg].v = vmax(sub_floor(v_e, v_gap_e), h_gap);
+            v_f = vmax(sub_floor(v_f, v_gap_e), h_gap);
+            v_h = h_load[seg].v;
+        }
+        
+        // Lazy F: propagate vertical gaps across segment boundaries
+        v_f = shift(v_f);
+        size_t seg = 0;
+        while (any_greater(v_f, sub_floor(h_store[seg].v, v_gap_o))) {
+            V v_h2 = vmax(h_store[seg].v, v_f);
+            h_store[seg].v = v_h2;
+            e[seg].v = vmax(e[seg].v, sub_floor(v_h2, v_gap_o));
+            v_f = sub_floor(v_f, v_gap_e);
+            if (++seg == seg_len) {
+                seg = 0;
+                v_f = shift(v_f);
             }
         }
+        
+        if (any_greater(v_max, v_limit)) {
+            return -1;  // Lanes too narrow for this alignment
+        }
     }
     
-    return {aligned_seq1, aligned_seq2, max_score};
+    int best = 0;
+    for (size_t lane = 0; lane < LANES; lane++) {
+        best = max(best, int(v_max[lane]));
+    }
+    return best;
 }
 
-int main() {
-    // Example usage
-    string seq1 = "GGTTGACTA";
-    string seq2 = "TGTTACGG";
-    
-    cout << "Smith-Waterman with Affine Gap Penalties - Local Alignment" << endl;
-    cout << "Sequence 1: " << seq1 << endl;
-    cout << "Sequence 2: " << seq2 << endl;
-    cout << endl;
-    
-    // Compare linear vs affine gap penalties
-    cout << "With affine gaps (gap_open=-3, gap_extend=-1):" << endl;
-    Alignment result_affine = smith_waterman_affine(seq1, seq2, 2, -1, -3, -1);
-    cout << "Aligned Sequence 1: " << result_affine.aligned_seq1 << endl;
-    cout << "Aligned Sequence 2: " << result_affine.aligned_seq2 << endl;
-    cout << "Alignment Score: " << result_affine.score << endl;
-    cout << endl;
-    
-    // Example with longer sequences showing affine gap advantage
-    string seq3 = "ACGTACGTACGT";
-    string seq4 = "ACGTAAACGT";
-    
-    cout << "Example 2 - Longer sequences:" << endl;
-    cout << "Sequence 1: " << seq3 << endl;
-    cout << "Sequence 2: " << seq4 << endl;
-    
-    Alignment result2 = smith_waterman_affine(seq3, seq4, 2, -1, -5, -1);
-    cout << "\nAligned Sequence 1: " << result2.aligned_seq1 << endl;
-    cout << "Aligned Sequence 2: " << result2.aligned_seq2 << endl;
-    cout << "Alignment Score: " << result2.score << endl;
-    
-    return 0;
+// Define the 8/16/32-bit wrappers of one ISA; ATTR selects the instruction set
+#define SW_STRIPED_VARIANTS(NAME, ATTR, BYTES)                                              \
+    ATTR static int sw_striped_##NAME##_8(const SwStripedProfile& q, const string& t,       \
+                                          int go, int ge) {                                 \
+        return sw_striped_kernel<uint8_t, BYTES>(q, t, go, ge, make_index_sequence<BYTES>()); \
+    }                                                                                       \
+    ATTR static int sw_striped_##NAME##_16(const SwStripedProfile& q, const string& t,      \
+                                           int go, int ge) {                                \
+        return sw_striped_kernel<uint16_t, BYTES>(q, t, go, ge,                             \
+                                                  make_index_sequence<BYTES / 2>());        \
+    }                                                                                       \
+    ATTR static int sw_striped_##NAME##_32(const SwStripedProfile& q, const string& t,      \
+                                           int go, int ge) {                                \
+        return sw_striped_kernel<uint32_t, BYTES>(q, t, go, ge,                             \
+                                                  make_index_sequence<BYTES / 4>());        \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+SW_STRIPED_VARIANTS(avx512, __attribute__((target("avx512bw"))), 64)
+SW_STRIPED_VARIANTS(avx2, __attribute__((target("avx2"))), 32)
+SW_STRIPED_VARIANTS(sse41, __attribute__((target("sse4.1"))), 16)
+#endif
+// Baseline build: NEON on AArch64, SSE2 on x86-64, plain vector code elsewhere
+SW_STRIPED_VARIANTS(generic, , 16)
+
+#undef SW_STRIPED_VARIANTS
+
+const SwStripedEngine& sw_striped_engine() {
+    static const SwStripedEngine engine = []() -> SwStripedEngine {
+#if defined(__x86_64__) || defined(__i386__)
+        if (ALIGN_CPU_SUPPORTS("avx512bw")) {
+            return {"avx512bw", sw_striped_avx512_8, sw_striped_avx512_16, sw_striped_avx512_32};
+        }
+        if (ALIGN_CPU_SUPPORTS("avx2")) {
+            return {"avx2", sw_striped_avx2_8, sw_striped_avx2_16, sw_striped_avx2_32};
+        }
+        if (ALIGN_CPU_SUPPORTS("sse4.1")) {
+            return {"sse4.1", sw_striped_sse41_8, sw_striped_sse41_16, sw_striped_sse41_32};
+        }
+        return {"sse2", sw_striped_generic_8, sw_striped_generic_16, sw_striped_generic_32};
+#elif defined(__ARM_NEON)
+        return {"neon", sw_striped_generic_8, sw_striped_generic_16, sw_striped_generic_32};
+#else
+        return {"generic", sw_striped_generic_8, sw_striped_generic_16, sw_striped_generic_32};
+#endif
+    }();
+    return engine;
+}
+
+int smith_waterman_affine_score(const string& seq1, const string& seq2,
+                                int match_score,
+                                int mismatch_penalty,
+                                int gap_open,
+                                int gap_extend) {
+    return smith_waterman_affine_score(seq1, seq2, make_scoring(MatchMismatch{match_score, mismatch_penalty},
+                                                                AffineGap{gap_open, gap_extend}));
 }
@@ -0,0 +1,757 @@
+/**
+ * Smith-Waterman Algorithm with Affine Gap Penalties for Local Sequence Alignment
+ * 
+ * This is an advanced version of the Smith-Waterman algorithm that uses affine gap penalties.
+ * Affine gap penalty = gap_open + k * gap_extend (where k is the gap length)
+ * This is more biologically realistic as it penalizes gap opening more than gap extension.
+ * 
+ * Uses three matrices:
+ * - M[i][j]: optimal score ending with match/mismatch
+ * - I[i][j]: optimal score ending with insertion (gap in seq1)
+ * - D[i][j]: optimal score ending with deletion (gap in seq2)
+ * 
+ * Time Complexity: O(m * n) where m and n are the lengths of the sequences
+ * Space Complexity: O(m * n) bits: 4 bits of traceback per cell plus one row per matrix
+ */
+
+#ifndef SMITH_WATERMAN_AFFINE_H
+#define SMITH_WATERMAN_AFFINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+#include "aligner_context.h"
+#include "dp_matrix.h"
+#include "cigar.h"
+#include "metrics.h"
+#include "scoring.h"
+
+/**
+ * Smith-Waterman alignment with affine gaps of seq1 against seq2 into
+ * result, with all scratch memory taken from arena.
+ */
+template <typename ScoringPolicy>
+void smith_waterman_affine_into(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring,
+                                ScratchArena& arena, AlignmentResult& result) {
+    int m = seq1.length();
+    int n = seq2.length();
+    metrics_count(Metric::DPCells, uint64_t(m) * n);
+    const int gap_open = scoring.gap.open();
+    const int gap_extend = scoring.gap.extend();
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    
+    const int NEG_INF = -1000000;
+    
+    // One row of each of M (match), I (insert) and D (delete), plus a 4-bit
+    // traceback code per cell: bits 0-1 hold the best state at the cell
+    // (STOP when all are <= 0), bit 2 is set when I extends I, bit 3 when D extends D
+    enum { STOP = 0, IN_M = 1, IN_I = 2, IN_D = 3, I_EXTENDS = 4, D_EXTENDS = 8 };
+    int* M_prev = arena.allocate<int>(n + 1);
+    int* M_curr = arena.allocate<int>(n + 1);
+    int* I_prev = arena.allocate<int>(n + 1);
+    int* I_curr = arena.allocate<int>(n + 1);
+    int* D_prev = arena.allocate<int>(n + 1);
+    int* D_curr = arena.allocate<int>(n + 1);
+    std::fill(M_prev, M_prev + n + 1, 0);
+    std::fill(M_curr, M_curr + n + 1, 0);
+    std::fill(I_prev, I_prev + n + 1, NEG_INF);
+    std::fill(I_curr, I_curr + n + 1, NEG_INF);
+    std::fill(D_prev, D_prev + n + 1, NEG_INF);
+    std::fill(D_curr, D_curr + n + 1, NEG_INF);
+    TracebackMatrix<4> trace(m + 1, n + 1, arena);
+    
+    int max_score = 0;
+    int max_i = 0, max_j = 0;
+    
+    // Fill DP matrices
+    for (int i = 1; i <= m; i++) {
+        auto substitution = profile.row(seq1[i-1]);
+        for (int j = 1; j <= n; j++) {
+            uint8_t code = 0;
+            
+            // Calculate I[i][j] - gap in seq2 (insertion)
+            int i_open = std::max(M_curr[j-1], D_curr[j-1]) + gap_open + gap_extend;
+            int i_extend = I_curr[j-1] + gap_extend;
+            I_curr[j] = std::max({0, i_open, i_extend});
+            if (i_extend >= i_open) {
+                code |= I_EXTENDS;
+            }
+            
+            // Calculate D[i][j] - gap in seq1 (deletion)
+            int d_open = std::max(M_prev[j], I_prev[j]) + gap_open + gap_extend;
+            int d_extend = D_prev[j] + gap_extend;
+            D_curr[j] = std::max({0, d_open, d_extend});
+            if (d_extend >= d_open) {
+                code |= D_EXTENDS;
+            }
+            
+            // Calculate M[i][j] - match/mismatch
+            int match_mismatch_score = substitution[j-1];
+            M_curr[j] = std::max({0,
+                                 M_prev[j-1] + match_mismatch_score,
+                                 I_prev[j-1] + match_mismatch_score,
+                                 D_prev[j-1] + match_mismatch_score});
+            
+            int best = std::max({M_curr[j], I_curr[j], D_curr[j]});
+            if (best > 0) {
+                code |= best == M_curr[j] ? IN_M : best == I_curr[j] ? IN_I : IN_D;
+            }
+            trace.set(i, j, code);
+            
+            // Track maximum score across all three matrices
+            if (best >= max_score) {
+                max_score = best;
+                max_i = i;
+                max_j = j;
+            }
+        }
+        std::swap(M_prev, M_curr);
+        std::swap(I_prev, I_curr);
+        std::swap(D_prev, D_curr);
+    }
+    
+    // Traceback from maximum score position. A gap that opened came from the
+    // best state of the neighbouring cell; an extended one stays in its state.
+    // I (gap in seq1) consumes seq2 only, which is a CIGAR 'D'; D is an 'I'.
+    result.cigar.clear();
+    int i = max_i, j = max_j;
+    uint8_t state = trace.get(i, j) & 3;
+    
+    while (state != STOP) {
+        uint8_t code = trace.get(i, j);
+        if (state == IN_M) {
+            result.cigar.push('M');
+            i--;
+            j--;
+            state = trace.get(i, j) & 3;
+        } else if (state == IN_I) {
+            result.cigar.push('D');
+            j--;
+            state = (code & I_EXTENDS) ? IN_I : trace.get(i, j) & 3;
+        } else {
+            result.cigar.push('I');
+            i--;
+            state = (code & D_EXTENDS) ? IN_D : trace.get(i, j) & 3;
+        }
+    }
+    result.cigar.reverse();
+    
+    result.score = max_score;
+    result.start1 = i;
+    result.end1 = max_i;
+    result.start2 = j;
+    result.end2 = max_j;
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+}
+
+/**
+ * Perform local sequence alignment using Smith-Waterman algorithm with affine gap penalties.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param scoring Substitution policy and gap model (see scoring.h); a linear
+ *                gap is the affine one with open() == 0
+ * @return Score, aligned regions and CIGAR of the best local alignment, viewing seq1 and seq2
+ */
+template <typename ScoringPolicy>
+AlignmentResult smith_waterman_affine_cigar(const std::string& seq1, const std::string& seq2,
+                                            const ScoringPolicy& scoring) {
+    AlignmentResult result;
+    smith_waterman_affine_into(seq1, seq2, scoring, AlignerContext::local().arena, result);
+    return result;
+}
+
+/**
+ * Smith-Waterman alignment with affine gaps reusing context: no heap
+ * allocation once the context has aligned a pair this large.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+template <typename ScoringPolicy>
+const AlignmentResult& smith_waterman_affine_cigar(const std::string& seq1, const std::string& seq2,
+                                                   const ScoringPolicy& scoring, AlignerContext& context) {
+    smith_waterman_affine_into(seq1, seq2, scoring, context.arena, context.result);
+    return context.result;
+}
+
+/**
+ * Perform local sequence alignment using Smith-Waterman algorithm with affine gap penalties.
+ * 
+ * @param seq1 First sequence
+ * @param seq2 Second sequence
+ * @param match_score Score for matching characters (default: 2)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_open Penalty for opening a gap (default: -3)
+ * @param gap_extend Penalty for extending a gap (default: -1)
+ * @return Score, aligned regions and CIGAR of the best local alignment, viewing seq1 and seq2
+ */
+AlignmentResult smith_waterman_affine_cigar(const std::string& seq1, const std::string& seq2,
+                                            int match_score = 2,
+                                            int mismatch_penalty = -1,
+                                            int gap_open = -3,
+                                            int gap_extend = -1);
+
+/**
+ * Smith-Waterman alignment with match/mismatch scoring and affine gaps,
+ * reusing context.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+const AlignmentResult& smith_waterman_affine_cigar(const std::string& seq1, const std::string& seq2,
+                                                   AlignerContext& context,
+                                                   int match_score = 2,
+                                                   int mismatch_penalty = -1,
+                                                   int gap_open = -3,
+                                                   int gap_extend = -1);
+
+/**
+ * Perform local sequence alignment using Smith-Waterman algorithm with affine gap penalties.
+ * 
+ * @return Alignment structure containing aligned sequences and score
+ */
+Alignment smith_waterman_affine(const std::string& seq1, const std::string& seq2,
+                                int match_score = 2,
+                                int mismatch_penalty = -1,
+                                int gap_open = -3,
+                                int gap_extend = -1);
+
+/**
+ * Best local score and the cell where it ends.
+ *
+ * end1/end2 are one past the last aligned position in seq1 and seq2.
+ */
+struct LocalScore {
+    int score;
+    int end1;
+    int end2;
+};
+
+/**
+ * Score-only Smith-Waterman with affine gaps in O(n) memory.
+ *
+ * Same recurrences and the same choice of end cell as smith_waterman_affine(),
+ * but keeps only one row of each of M, I and D, taken from arena.
+ *
+ * @return Best score and its end cell
+ */
+template <typename ScoringPolicy>
+LocalScore smith_waterman_affine_score_only(const std::string& seq1, const std::string& seq2,
+                                            const ScoringPolicy& scoring, ScratchArena& arena) {
+    int m = seq1.length();
+    int n = seq2.length();
+    metrics_count(Metric::DPCells, uint64_t(m) * n);
+    const int gap_open = scoring.gap.open();
+    const int gap_extend = scoring.gap.extend();
+    ScratchArena::Scope scope(arena);
+    auto profile = scoring.profile(seq2, seq1, arena);
+    
+    const int NEG_INF = -1000000;
+    
+    // Row i-1 (prev) and row i (curr) of each matrix
+    int* M_prev = arena.allocate<int>(n + 1);
+    int* M_curr = arena.allocate<int>(n + 1);
+    int* I_prev = arena.allocate<int>(n + 1);
+    int* I_curr = arena.allocate<int>(n + 1);
+    int* D_prev = arena.allocate<int>(n + 1);
+    int* D_curr = arena.allocate<int>(n + 1);
+    std::fill(M_prev, M_prev + n + 1, 0);
+    std::fill(M_curr, M_curr + n + 1, 0);
+    std::fill(I_prev, I_prev + n + 1, NEG_INF);
+    std::fill(I_curr, I_curr + n + 1, NEG_INF);
+    std::fill(D_prev, D_prev + n + 1, NEG_INF);
+    std::fill(D_curr, D_curr + n + 1, NEG_INF);
+    
+    LocalScore best = {0, 0, 0};
+    
+    for (int i = 1; i <= m; i++) {
+        auto substitution = profile.row(seq1[i-1]);
+        for (int j = 1; j <= n; j++) {
+            I_curr[j] = std::max({0,
+                                 M_curr[j-1] + gap_open + gap_extend,
+                                 I_curr[j-1] + gap_extend,
+                                 D_curr[j-1] + gap_open + gap_extend});
+            
+            D_curr[j] = std::max({0,
+                                 M_prev[j] + gap_open + gap_extend,
+                                 I_prev[j] + gap_open + gap_extend,
+                                 D_prev[j] + gap_extend});
+            
+            int match_mismatch_score = substitution[j-1];
+            M_curr[j] = std::max({0,
+                                 M_prev[j-1] + match_mismatch_score,
+                                 I_prev[j-1] + match_mismatch_score,
+                                 D_prev[j-1] + match_mismatch_score});
+            
+            // Same >= tie-breaking as the full-matrix version
+            int cell = std::max({M_curr[j], I_curr[j], D_curr[j]});
+            if (cell >= best.score) {
+                best = {cell, i, j};
+            }
+        }
+        std::swap(M_prev, M_curr);
+        std::swap(I_prev, I_curr);
+        std::swap(D_prev, D_curr);
+    }
+    
+    return best;
+}
+
+/**
+ * Score-only Smith-Waterman with affine gaps in O(n) memory.
+ */
+template <typename ScoringPolicy>
+LocalScore smith_waterman_affine_score_only(const std::string& seq1, const std::string& seq2,
+                                            const ScoringPolicy& scoring) {
+    return smith_waterman_affine_score_only(seq1, seq2, scoring, AlignerContext::local().arena);
+}
+
+/**
+ * Score-only Smith-Waterman with affine gaps reusing context: no heap
+ * allocation once the context has scored a pair this large.
+ */
+template <typename ScoringPolicy>
+LocalScore smith_waterman_affine_score_only(const std::string& seq1, const std::string& seq2,
+                                            const ScoringPolicy& scoring, AlignerContext& context) {
+    return smith_waterman_affine_score_only(seq1, seq2, scoring, context.arena);
+}
+
+/**
+ * Score-only Smith-Waterman with match/mismatch scoring and affine gaps in O(n) memory.
+ */
+LocalScore smith_waterman_affine_score_only(const std::string& seq1, const std::string& seq2,
+                                            int match_score = 2,
+                                            int mismatch_penalty = -1,
+                                            int gap_open = -3,
+                                            int gap_extend = -1);
+
+/**
+ * Score-only Smith-Waterman with match/mismatch scoring and affine gaps, reusing context.
+ */
+LocalScore smith_waterman_affine_score_only(const std::string& seq1, const std::string& seq2,
+                                            AlignerContext& context,
+                                            int match_score = 2,
+                                            int mismatch_penalty = -1,
+                                            int gap_open = -3,
+                                            int gap_extend = -1);
+
+/**
+ * Find where an optimal local alignment ending at (end1, end2) starts.
+ *
+ * Runs the affine DP backwards from the end cell, anchored there (no restarts
+ * at 0), and returns the first cell whose score reaches target_score. Uses
+ * O(end2) memory, taken from arena.
+ *
+ * @return (start1, start2) such that seq1[start1, end1) and seq2[start2, end2)
+ *         align globally with score target_score
+ */
+template <typename ScoringPolicy>
+std::pair<int, int> smith_waterman_affine_start(const std::string& seq1, const std::string& seq2,
+                                                int end1, int end2, int target_score,
+                                                const ScoringPolicy& scoring, ScratchArena& arena) {
+    const int NEG_INF = -1000000;
+    const int gap_open = scoring.gap.open();
+    const int gap_extend = scoring.gap.extend();
+    metrics_count(Metric::DPCells, uint64_t(end1) * end2);
+    ScratchArena::Scope scope(arena);
+    
+    // Row a / column b of the reverse DP is seq1[end1 - a] / seq2[end2 - b]
+    int* M_prev = arena.allocate<int>(end2 + 1);
+    int* M_curr = arena.allocate<int>(end2 + 1);
+    int* I_prev = arena.allocate<int>(end2 + 1);
+    int* I_curr = arena.allocate<int>(end2 + 1);
+    int* D_prev = arena.allocate<int>(end2 + 1);
+    int* D_curr = arena.allocate<int>(end2 + 1);
+    std::fill(M_prev, M_prev + end2 + 1, NEG_INF);
+    std::fill(M_curr, M_curr + end2 + 1, NEG_INF);
+    std::fill(I_prev, I_prev + end2 + 1, NEG_INF);
+    std::fill(I_curr, I_curr + end2 + 1, NEG_INF);
+    std::fill(D_prev, D_prev + end2 + 1, NEG_INF);
+    std::fill(D_curr, D_curr + end2 + 1, NEG_INF);
+    
+    M_prev[0] = 0;
+    for (int b = 1; b <= end2; b++) {
+        I_prev[b] = gap_open + b * gap_extend;
+    }
+    
+    for (int a = 1; a <= end1; a++) {
+        M_curr[0] = NEG_INF;
+        I_curr[0] = NEG_INF;
+        D_curr[0] = gap_open + a * gap_extend;
+        
+        for (int b = 1; b <= end2; b++) {
+            I_curr[b] = std::max({M_curr[b-1] + gap_open + gap_extend,
+                                 I_curr[b-1] + gap_extend,
+                                 D_curr[b-1] + gap_open + gap_extend});
+            
+            D_curr[b] = std::max({M_prev[b] + gap_open + gap_extend,
+                                 I_prev[b] + gap_open + gap_extend,
+                                 D_prev[b] + gap_extend});
+            
+            int match_mismatch_score = scoring(seq1[end1 - a], seq2[end2 - b]);
+            M_curr[b] = std::max({M_prev[b-1], I_prev[b-1], D_prev[b-1]}) + match_mismatch_score;
+            
+            if (M_curr[b] == target_score) {
+                return {end1 - a, end2 - b};
+            }
+        }
+        std::swap(M_prev, M_curr);
+        std::swap(I_prev, I_curr);
+        std::swap(D_prev, D_curr);
+    }
+    
+    return {end1, end2};  // Only reached for an empty alignment
+}
+
+/**
+ * Banded global alignment with affine gaps, traced back from 1 byte per cell.
+ *
+ * Cells are restricted to diagonals j - i in [lo, hi]. Each cell's 8-bit traceback
+ * code records the predecessor state of M (bits 0-1), I (bits 2-3) and D
+ * (bits 4-5), so only two rows of scores are kept. Scratch memory is taken
+ * from arena.
+ *
+ * Writes into result the score and CIGAR of an alignment of seq1 against seq2
+ * that is optimal within the band.
+ */
+template <typename ScoringPolicy>
+void banded_global_affine_into(std::string_view seq1, std::string_view seq2, int lo, int hi,
+                               const ScoringPolicy& scoring, ScratchArena& arena, AlignmentResult& result) {
+    int m = seq1.length();
+    int n = seq2.length();
+    const int gap_open = scoring.gap.open();
+    const int gap_extend = scoring.gap.extend();
+    int width = hi - lo + 1;
+    ScratchArena::Scope scope(arena);
+    
+    const int NEG_INF = -1000000000;
+    enum { FROM_M = 0, FROM_I = 1, FROM_D = 2 };
+    
+    // Band index k holds column j = i + lo + k; one guard cell on each side
+    int* M_prev = arena.allocate<int>(width + 2);
+    int* M_curr = arena.allocate<int>(width + 2);
+    int* I_prev = arena.allocate<int>(width + 2);
+    int* I_curr = arena.allocate<int>(width + 2);
+    int* D_prev = arena.allocate<int>(width + 2);
+    int* D_curr = arena.allocate<int>(width + 2);
+    std::fill(M_prev, M_prev + width + 2, NEG_INF);
+    std::fill(I_prev, I_prev + width + 2, NEG_INF);
+    std::fill(D_prev, D_prev + width + 2, NEG_INF);
+    TracebackMatrix<8> trace(m + 1, width, arena);
+    
+    auto best_of = [](int M, int I, int D, uint8_t& from) {
+        from = FROM_M;
+        int best = M;
+        if (I > best) { best = I; from = FROM_I; }
+        if (D > best) { best = D; from = FROM_D; }
+        return best;
+    };
+    
+    uint64_t cells = 0;
+    for (int i = 0; i <= m; i++) {
+        std::fill(M_curr, M_curr + width + 2, NEG_INF);
+        std::fill(I_curr, I_curr + width + 2, NEG_INF);
+        std::fill(D_curr, D_curr + width + 2, NEG_INF);
+        
+        for (int k = 0; k < width; k++) {
+            int j = i + lo + k;
+            if (j < 0 || j > n) {
+                continue;
+            }
+            cells++;
+            int c = k + 1;  // Position in the guarded row
+            uint8_t from_m = FROM_M, from_i = FROM_M, from_d = FROM_M;
+            
+            if (i == 0 && j == 0) {
+                M_curr[c] = 0;
+            } else {
+                if (j > 0) {
+                    // I: gap in seq1, from (i, j-1) at band index k-1
+                    I_curr[c] = best_of(M_curr[c-1] + gap_open + gap_extend,
+                                        I_curr[c-1] + gap_extend,
+                                        D_curr[c-1] + gap_open + gap_extend, from_i);
+                }
+                if (i > 0) {
+                    // D: gap in seq2, from (i-1, j) at band index k+1
+                    D_curr[c] = best_of(M_prev[c+1] + gap_open + gap_extend,
+                                        I_prev[c+1] + gap_open + gap_extend,
+                                        D_prev[c+1] + gap_extend, from_d);
+                }
+                if (i > 0 && j > 0) {
+                    // M: from (i-1, j-1) at band index k
+                    int match_mismatch_score = scoring(seq1[i-1], seq2[j-1]);
+                    M_curr[c] = best_of(M_prev[c], I_prev[c], D_prev[c], from_m) + match_mismatch_score;
+                }
+            }
+            trace.set(i, k, from_m | (from_i << 2) | (from_d << 4));
+        }
+        std::swap(M_prev, M_curr);
+        std::swap(I_prev, I_curr);
+        std::swap(D_prev, D_curr);
+    }
+    metrics_count(Metric::DPCells, cells);
+    
+    // Trace back from the end cell
+    int c_end = n - m - lo + 1;
+    uint8_t state;
+    int score = best_of(M_prev[c_end], I_prev[c_end], D_prev[c_end], state);
+    
+    result.cigar.clear();
+    int i = m, j = n;
+    while (i > 0 || j > 0) {
+        uint8_t t = trace.get(i, j - i - lo);
+        if (state == FROM_M) {
+            result.cigar.push('M');
+            state = t & 3;
+            i--;
+            j--;
+        } else if (state == FROM_I) {
+            result.cigar.push('D');
+            state = (t >> 2) & 3;
+            j--;
+        } else {
+            result.cigar.push('I');
+            state = (t >> 4) & 3;
+            i--;
+        }
+    }
+    result.cigar.reverse();
+    
+    result.score = score;
+    result.start1 = 0;
+    result.end1 = m;
+    result.start2 = 0;
+    result.end2 = n;
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+}
+
+/**
+ * Banded global alignment with affine gaps (see banded_global_affine_into()).
+ *
+ * @return Score and CIGAR of an alignment of seq1 against seq2 that is optimal within the band
+ */
+template <typename ScoringPolicy>
+AlignmentResult banded_global_affine(std::string_view seq1, std::string_view seq2, int lo, int hi,
+                                     const ScoringPolicy& scoring) {
+    AlignmentResult result;
+    banded_global_affine_into(seq1, seq2, lo, hi, scoring, AlignerContext::local().arena, result);
+    return result;
+}
+
+/**
+ * Smith-Waterman with affine gaps in linear memory.
+ *
+ * Two passes find the alignment's rectangle without any matrix: a score-only
+ * forward pass gives the score and end cell, and an anchored reverse pass from
+ * the end cell gives the start. The alignment itself is then recovered by a
+ * banded traceback over that sub-rectangle only; the band starts narrow and is
+ * doubled until it contains an alignment with the optimal score. Memory is
+ * O(n) for the passes plus one byte per banded cell.
+ *
+ * Writes into result an alignment with the same score as
+ * smith_waterman_affine(); among equally scoring alignments it may pick a
+ * different one. All scratch memory is taken from arena.
+ */
+template <typename ScoringPolicy>
+void smith_waterman_affine_linear_into(const std::string& seq1, const std::string& seq2,
+                                       const ScoringPolicy& scoring, ScratchArena& arena,
+                                       AlignmentResult& result) {
+    LocalScore end = smith_waterman_affine_score_only(seq1, seq2, scoring, arena);
+    if (end.score <= 0) {
+        result.cigar.clear();
+        result.score = 0;
+        result.start1 = result.end1 = 0;
+        result.start2 = result.end2 = 0;
+        result.seq1 = seq1;
+        result.seq2 = seq2;
+        return;
+    }
+    
+    auto [start1, start2] = smith_waterman_affine_start(seq1, seq2, end.end1, end.end2, end.score,
+                                                        scoring, arena);
+    std::string_view sub1 = std::string_view(seq1).substr(start1, end.end1 - start1);
+    std::string_view sub2 = std::string_view(seq2).substr(start2, end.end2 - start2);
+    int len1 = sub1.length();
+    int len2 = sub2.length();
+    
+    // The band must contain both corners of the rectangle
+    int diag_lo = std::min(0, len2 - len1);
+    int diag_hi = std::max(0, len2 - len1);
+    for (int w = 16;; w *= 2) {
+        int lo = std::max(diag_lo - w, -len1);
+        int hi = std::min(diag_hi + w, len2);
+        banded_global_affine_into(sub1, sub2, lo, hi, scoring, arena, result);
+        if (result.score >= end.score || (lo == -len1 && hi == len2)) {
+            result.start1 = start1;
+            result.end1 = end.end1;
+            result.start2 = start2;
+            result.end2 = end.end2;
+            result.seq1 = seq1;
+            result.seq2 = seq2;
+            return;
+        }
+    }
+}
+
+/**
+ * Smith-Waterman with affine gaps in linear memory
+ * (see smith_waterman_affine_linear_into()).
+ */
+template <typename ScoringPolicy>
+AlignmentResult smith_waterman_affine_linear_cigar(const std::string& seq1, const std::string& seq2,
+                                                   const ScoringPolicy& scoring) {
+    AlignmentResult result;
+    smith_waterman_affine_linear_into(seq1, seq2, scoring, AlignerContext::local().arena, result);
+    return result;
+}
+
+/**
+ * Smith-Waterman with affine gaps in linear memory reusing context: no heap
+ * allocation once the context has aligned a pair this large.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+template <typename ScoringPolicy>
+const AlignmentResult& smith_waterman_affine_linear_cigar(const std::string& seq1, const std::string& seq2,
+                                                          const ScoringPolicy& scoring, AlignerContext& context) {
+    smith_waterman_affine_linear_into(seq1, seq2, scoring, context.arena, context.result);
+    return context.result;
+}
+
+/**
+ * Smith-Waterman with match/mismatch scoring and affine gaps in linear memory.
+ */
+AlignmentResult smith_waterman_affine_linear_cigar(const std::string& seq1, const std::string& seq2,
+                                                   int match_score = 2,
+                                                   int mismatch_penalty = -1,
+                                                   int gap_open = -3,
+                                                   int gap_extend = -1);
+
+/**
+ * Smith-Waterman with match/mismatch scoring and affine gaps in linear
+ * memory, reusing context.
+ * 
+ * @return context.result, valid until the next alignment with context
+ */
+const AlignmentResult& smith_waterman_affine_linear_cigar(const std::string& seq1, const std::string& seq2,
+                                                          AlignerContext& context,
+                                                          int match_score = 2,
+                                                          int mismatch_penalty = -1,
+                                                          int gap_open = -3,
+                                                          int gap_extend = -1);
+
+/**
+ * Smith-Waterman with affine gaps in linear memory, rendered as aligned strings.
+ */
+Alignment smith_waterman_affine_linear(const std::string& seq1, const std::string& seq2,
+                                       int match_score = 2,
+                                       int mismatch_penalty = -1,
+                                       int gap_open = -3,
+                                       int gap_extend = -1);
+
+/**
+ * Substitution scores of a query against every residue of a target, in query
+ * order, for the striped kernels to lay out in their own vector width:
+ * scores[row_of[c] * length + i] is the score of query[i] against residue c.
+ */
+struct SwStripedProfile {
+    size_t length = 0;
+    uint16_t row_of[256] = {};
+    std::vector<int> scores;
+    int min_score = 0;
+    int max_score = 0;
+};
+
+template <typename ScoringPolicy>
+SwStripedProfile sw_striped_profile(const std::string& query, const std::string& target,
+                                    const ScoringPolicy& scoring) {
+    SwStripedProfile profile;
+    profile.length = query.length();
+    bool seen[256] = {};
+    uint16_t rows = 0;
+    for (char c : target) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (!seen[u]) {
+            seen[u] = true;
+            profile.row_of[u] = rows++;
+            for (char q : query) {
+                profile.scores.push_back(scoring(q, c));
+            }
+        }
+    }
+    if (!profile.scores.empty()) {
+        auto [lo, hi] = std::minmax_element(profile.scores.begin(), profile.scores.end());
+        profile.min_score = *lo;
+        profile.max_score = *hi;
+    }
+    return profile;
+}
+
+typedef int (*SwStripedFn)(const SwStripedProfile&, const std::string&, int, int);
+
+/**
+ * One ISA's set of striped kernels, from narrowest to widest lanes.
+ */
+struct SwStripedEngine {
+    const char* isa;
+    SwStripedFn score8;
+    SwStripedFn score16;
+    SwStripedFn score32;
+};
+
+/**
+ * Select the widest striped engine the running CPU supports (detected once).
+ */
+const SwStripedEngine& sw_striped_engine();
+
+/**
+ * Local alignment score with affine gaps using the vectorized striped engine.
+ *
+ * Returns the same score as smith_waterman_affine() without building any
+ * matrix. Starts with 8-bit lanes (most lanes per vector) and re-runs with
+ * 16-bit and then 32-bit lanes if the score outgrows them.
+ *
+ * @param seq1 Query sequence (the profile is built over it)
+ * @param seq2 Target sequence
+ * @param scoring Substitution policy and gap model (see scoring.h)
+ * @return Optimal local alignment score
+ */
+template <typename ScoringPolicy>
+int smith_waterman_affine_score(const std::string& seq1, const std::string& seq2, const ScoringPolicy& scoring) {
+    const SwStripedEngine& engine = sw_striped_engine();
+    SwStripedProfile profile = sw_striped_profile(seq1, seq2, scoring);
+    metrics_count(Metric::DPCells, uint64_t(seq1.length()) * seq2.length());
+    
+    for (SwStripedFn kernel : {engine.score8, engine.score16, engine.score32}) {
+        int score = kernel(profile, seq2, scoring.gap.open(), scoring.gap.extend());
+        if (score >= 0) {
+            return score;
+        }
+    }
+    
+    // Parameters outside the striped model (e.g. positive gap scores)
+    return smith_waterman_affine_cigar(seq1, seq2, scoring).score;
+}
+
+/**
+ * Local alignment score with match/mismatch scoring and affine gaps, vectorized.
+ *
+ * @param match_score Score for matching characters (default: 2)
+ * @param mismatch_penalty Penalty for mismatching characters (default: -1)
+ * @param gap_open Penalty for opening a gap (default: -3)
+ * @param gap_extend Penalty for extending a gap (default: -1)
+ */
+int smith_waterman_affine_score(const std::string& seq1, const std::string& seq2,
+                                int match_score = 2,
+                                int mismatch_penalty = -1,
+                                int gap_open = -3,
+                                int gap_extend = -1);
+
+#endif // SMITH_WATERMAN_AFFINE_H
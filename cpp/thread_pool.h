@@ -0,0 +1,284 @@
+/**
+ * Work-Stealing Thread Pool
+ *
+ * Each worker owns a deque of tasks. A worker pops its own tasks from the back
+ * (newest first, so recursively spawned work stays cache-warm) and, when its
+ * deque is empty, steals the oldest task from the front of another worker's
+ * deque. Tasks submitted from outside the pool are dealt round-robin over the
+ * deques; tasks submitted by a worker go onto its own deque and spread to idle
+ * workers by stealing.
+ *
+ * The deques are short and touched once per task, so a mutex per deque is
+ * enough for tasks of microseconds and up; each deque lives on its own cache
+ * line so that workers do not contend through false sharing. A deque is a
+ * ring buffer that only ever grows, and a fork's task fits in std::function's
+ * inline storage, so a warm pool runs fork_join() without heap allocation.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+private:
+    struct alignas(64) Queue {
+        std::mutex lock;
+        std::vector<std::function<void()>> ring;
+        size_t head = 0;   // Oldest task
+        size_t count = 0;
+
+        std::function<void()>& at(size_t k) { return ring[(head + k) % ring.size()]; }
+
+        void push_back(std::function<void()> task) {
+            if (count == ring.size()) {
+                std::vector<std::function<void()>> larger(std::max<size_t>(2 * ring.size(), 16));
+                for (size_t k = 0; k < count; k++) {
+                    larger[k] = std::move(at(k));
+                }
+                ring.swap(larger);
+                head = 0;
+            }
+            at(count++) = std::move(task);
+        }
+
+        void pop_back(std::function<void()>& task) {
+            task = std::move(at(--count));
+        }
+
+        void pop_front(std::function<void()>& task) {
+            task = std::move(at(0));
+            head = (head + 1) % ring.size();
+            count--;
+        }
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_queue{0};
+    std::atomic<size_t> queued{0};      // Tasks sitting in some deque
+    std::atomic<size_t> unfinished{0};  // Tasks submitted but not yet completed
+    bool stopping = false;
+
+    std::mutex sleep_lock;
+    std::condition_variable wake;       // Signalled when a task is queued or on shutdown
+    std::condition_variable idle;       // Signalled when unfinished drops to 0
+    std::exception_ptr failure;         // First exception thrown by a task
+
+    static int& worker_id() {
+        thread_local int id = -1;
+        return id;
+    }
+
+    static WorkStealingPool*& worker_pool() {
+        thread_local WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    bool try_pop(size_t id, std::function<void()>& task) {
+        Queue& q = *queues[id];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.count == 0) {
+            return false;
+        }
+        q.pop_back(task);
+        queued--;
+        return true;
+    }
+
+    bool try_steal(size_t id, std::function<void()>& task) {
+        for (size_t k = 1; k < queues.size(); k++) {
+            Queue& q = *queues[(id + k) % queues.size()];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (q.count > 0) {
+                q.pop_front(task);
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(std::function<void()>& task) {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+        task = nullptr;
+        if (--unfinished == 0) {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            idle.notify_all();
+        }
+    }
+
+    void worker_loop(size_t id) {
+        worker_id() = id;
+        worker_pool() = this;
+        std::function<void()> task;
+        while (true) {
+            if (try_pop(id, task) || try_steal(id, task)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            wake.wait(guard, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) {
+                return;
+            }
+        }
+    }
+
+    template <typename Body>
+    void parallel_range(size_t begin, size_t end, Body& body) {
+        if (end - begin <= 1) {
+            if (begin < end) {
+                body(begin);
+            }
+            return;
+        }
+        size_t mid = begin + (end - begin) / 2;
+        fork_join([&] { parallel_range(begin, mid, body); },
+                  [&] { parallel_range(mid, end, body); });
+    }
+
+public:
+    /**
+     * Start threads workers (at least one).
+     */
+    explicit WorkStealingPool(size_t threads = std::thread::hardware_concurrency()) {
+        threads = threads > 0 ? threads : 1;
+        for (size_t t = 0; t < threads; t++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back(&WorkStealingPool::worker_loop, this, t);
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Finish all queued tasks, then join the workers.
+     */
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * Queue a task: on the calling worker's own deque, or round-robin from outside.
+     */
+    void submit(std::function<void()> task) {
+        size_t id = worker_pool() == this ? worker_id()
+                                          : next_queue.fetch_add(1) % queues.size();
+        unfinished++;
+        {
+            Queue& q = *queues[id];
+            std::lock_guard<std::mutex> guard(q.lock);
+            q.push_back(std::move(task));
+            queued++;
+        }
+        {
+            // Taking the lock orders this wakeup after any worker's check of queued
+            std::lock_guard<std::mutex> guard(sleep_lock);
+        }
+        wake.notify_one();
+    }
+
+    /**
+     * Block until every submitted task has completed, rethrowing the first
+     * exception a task threw. Must not be called from a worker of this pool.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        idle.wait(guard, [this] { return unfinished == 0; });
+        if (failure) {
+            std::exception_ptr e = failure;
+            failure = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    /**
+     * Run body(i) for every i in [0, count) in parallel and return when all
+     * are done. The range is split in halves with fork_join(), so calls nest
+     * inside tasks of this pool.
+     */
+    template <typename Body>
+    void parallel_for(size_t count, Body body) {
+        parallel_range(0, count, body);
+    }
+
+    /**
+     * Run a() on the calling thread and b() as a task; return when both are done.
+     *
+     * While b() is unfinished the caller runs other queued tasks (starting
+     * with b() itself unless another worker stole it), so fork_join() can be
+     * nested inside tasks of this pool, unlike wait(). An exception thrown by
+     * either callable is rethrown once both have finished.
+     */
+    template <typename A, typename B>
+    void fork_join(A&& a, B&& b) {
+        // The task captures one pointer, which std::function stores inline
+        struct Fork {
+            B& b;
+            std::atomic<bool> done;
+            std::exception_ptr failure;
+        } fork{b, {false}, nullptr};
+        submit([f = &fork] {
+            try {
+                f->b();
+            } catch (...) {
+                f->failure = std::current_exception();
+            }
+            f->done.store(true, std::memory_order_release);
+        });
+
+        std::exception_ptr a_failure;
+        try {
+            a();
+        } catch (...) {
+            a_failure = std::current_exception();
+        }
+
+        size_t id = worker_pool() == this ? worker_id() : 0;
+        std::function<void()> task;
+        while (!fork.done.load(std::memory_order_acquire)) {
+            if (try_pop(id, task) || try_steal(id, task)) {
+                run(task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (a_failure) {
+            std::rethrow_exception(a_failure);
+        }
+        if (fork.failure) {
+            std::rethrow_exception(fork.failure);
+        }
+    }
+
+    size_t size() const { return workers.size(); }
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,406 @@
+/**
+ * Tiled Wavefront Needleman-Wunsch
+ *
+ * The DP matrix is cut into tiles of tile x tile cells. Tile (r, s) depends
+ * only on tiles (r - 1, s) and (r, s - 1), so all tiles of one anti-diagonal
+ * of tiles run in parallel on a work-stealing pool:
+ * - The last row computed in each column strip is carried down one shared
+ *   row; each strip owns its own columns of it
+ * - A tile hands its rightmost column, plus the corner cell above it, to
+ *   the tile on its right through one of two buffers per strip boundary
+ *   (alternating with the tile row), so a handoff is never overwritten
+ *   before it is read
+ * Inside a tile the cells are swept one anti-diagonal at a time; cells of an
+ * anti-diagonal are independent, so each step is a handful of vector
+ * instructions over 32-bit lanes (AVX-512, AVX2, SSE4.1 or the baseline ISA,
+ * picked at run time).
+ *
+ * The traceback keeps 2 bits per cell, stored per tile in anti-diagonal
+ * order; a score-only fill needs O(n + tile) memory. All of it comes from
+ * scratch arenas: the caller's for the rows, handoffs and traceback, and
+ * that of the thread running a tile (AlignerContext::local()) for the
+ * tile's diagonals. Scores, tie preference
+ * (diagonal, then up, then left) and therefore alignments are identical to
+ * the row-by-row needleman_wunsch() fill.
+ */
+
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "aligner_context.h"
+#include "cigar.h"
+#include "cpu_dispatch.h"
+#include "dp_matrix.h"
+#include "metrics.h"
+#include "thread_pool.h"
+
+/**
+ * One tile of the wavefront: inputs along its top and left edges, outputs
+ * along its bottom and right edges. Cell (a, b) is row a, column b of the
+ * tile, 1-based; row 0 and column 0 are the edges of the neighbouring tiles.
+ */
+struct WavefrontTile {
+    int h = 0;
+    int w = 0;
+    const int* q = nullptr;       // q[a - 1]: seq1 base of row a (padded by a vector)
+    const int* rr = nullptr;      // rr[w - b]: seq2 base of column b, reversed (padded)
+    int corner = 0;               // Cell (0, 0)
+    const int* top = nullptr;     // top[b - 1]: cell (0, b)
+    const int* left = nullptr;    // left[a - 1]: cell (a, 0)
+    int* bottom = nullptr;        // bottom[b - 1] = cell (h, b); may alias top
+    int* right = nullptr;         // right[0] = cell (0, w), right[a] = cell (a, w)
+    uint8_t* codes = nullptr;     // Traceback codes, or nullptr for scores only
+    const uint32_t* starts = nullptr;  // First code of each anti-diagonal a + b
+    int* scratch = nullptr;       // 3 anti-diagonals of h + 1 + lanes ints
+};
+
+/**
+ * Index of the first traceback code of every anti-diagonal d = a + b of an
+ * h x w tile into starts (entries 2 .. h + w + 1 of h + w + 2). Each diagonal
+ * starts on a whole byte.
+ */
+inline void wavefront_diagonal_starts(int h, int w, uint32_t* starts) {
+    std::fill(starts, starts + h + w + 2, 0);
+    for (int d = 2; d <= h + w; d++) {
+        int cells = std::min(h, d - 1) - std::max(1, d - w) + 1;
+        starts[d + 1] = starts[d] + (cells + 3) / 4 * 4;
+    }
+}
+
+template <typename T, size_t BYTES>
+static inline __attribute__((always_inline))
+void wavefront_tile_kernel(const WavefrontTile& t, int match_score, int mismatch_penalty,
+                           int gap_penalty) {
+    typedef T V __attribute__((vector_size(BYTES)));
+    const int LANES = BYTES / sizeof(T);
+    const V zero = {};
+    const V v_match = zero + match_score;
+    const V v_mismatch = zero + mismatch_penalty;
+    const V v_gap = zero + gap_penalty;
+    const V v_up = zero + 1;
+    const V v_left = zero + 2;
+
+    const int h = t.h, w = t.w;
+    const int stride = h + 1 + LANES;
+    T* D2 = t.scratch;
+    T* D1 = D2 + stride;
+    T* D0 = D1 + stride;
+
+    t.right[0] = t.top[w - 1];
+    D2[0] = t.corner;
+    D1[0] = t.top[0];
+    D1[1] = t.left[0];
+
+    for (int d = 2; d <= h + w; d++) {
+        const int lo = std::max(1, d - w);
+        const int hi = std::min(h, d - 1);
+        uint8_t* codes = t.codes ? t.codes + t.starts[d] / 4 : nullptr;
+
+        // Lanes past hi compute garbage that no later diagonal reads
+        for (int a = lo; a <= hi; a += LANES) {
+            V diag, up, left, q, r;
+            std::memcpy(&diag, D2 + a - 1, sizeof(V));
+            std::memcpy(&up, D1 + a - 1, sizeof(V));
+            std::memcpy(&left, D1 + a, sizeof(V));
+            std::memcpy(&q, t.q + a - 1, sizeof(V));
+            std::memcpy(&r, t.rr + (w - d + a), sizeof(V));
+            up += v_gap;
+            left += v_gap;
+            V match = diag + (q == r ? v_match : v_mismatch);
+            V best = up > left ? up : left;
+            best = match > best ? match : best;
+            std::memcpy(D0 + a, &best, sizeof(V));
+
+            if (codes) {
+                V code = best == match ? zero : best == up ? v_up : v_left;
+                uint8_t* out = codes + (a - lo) / 4;
+                for (int l = 0; l < LANES; l += 4) {
+                    out[l / 4] = code[l] | code[l + 1] << 2 | code[l + 2] << 4 | code[l + 3] << 6;
+                }
+            }
+        }
+
+        // Edge cells of this diagonal, then the tile's outputs on it
+        if (d <= w) {
+            D0[0] = t.top[d - 1];
+        }
+        if (d <= h) {
+            D0[d] = t.left[d - 1];
+        }
+        if (d > h && d - h <= w) {
+            t.bottom[d - h - 1] = D0[h];
+        }
+        if (d > w && d - w <= h) {
+            t.right[d - w] = D0[d - w];
+        }
+
+        T* spare = D2;
+        D2 = D1;
+        D1 = D0;
+        D0 = spare;
+    }
+}
+
+typedef void (*WavefrontTileFn)(const WavefrontTile&, int, int, int);
+
+// Define the tile wrapper of one ISA; ATTR selects the instruction set
+#define WAVEFRONT_VARIANT(NAME, ATTR, BYTES)                                                 \
+    ATTR static void wavefront_tile_##NAME(const WavefrontTile& t, int ms, int mm, int g) {  \
+        wavefront_tile_kernel<int32_t, BYTES>(t, ms, mm, g);                                 \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+WAVEFRONT_VARIANT(avx512, __attribute__((target("avx512bw"))), 64)
+WAVEFRONT_VARIANT(avx2, __attribute__((target("avx2"))), 32)
+WAVEFRONT_VARIANT(sse41, __attribute__((target("sse4.1"))), 16)
+#endif
+// Baseline build: NEON on AArch64, SSE2 on x86-64, plain vector code elsewhere
+WAVEFRONT_VARIANT(generic, , 16)
+
+#undef WAVEFRONT_VARIANT
+
+/**
+ * Select the widest tile kernel the running CPU supports (detected once),
+ * and its vector width in lanes.
+ */
+inline WavefrontTileFn wavefront_kernel_for_cpu(int* lanes = nullptr) {
+    static const std::pair<WavefrontTileFn, int> kernel = []() -> std::pair<WavefrontTileFn, int> {
+#if defined(__x86_64__) || defined(__i386__)
+        if (ALIGN_CPU_SUPPORTS("avx512bw")) {
+            return {wavefront_tile_avx512, 16};
+        }
+        if (ALIGN_CPU_SUPPORTS("avx2")) {
+            return {wavefront_tile_avx2, 8};
+        }
+        if (ALIGN_CPU_SUPPORTS("sse4.1")) {
+            return {wavefront_tile_sse41, 4};
+        }
+#endif
+        return {wavefront_tile_generic, 4};
+    }();
+    if (lanes) {
+        *lanes = kernel.second;
+    }
+    return kernel.first;
+}
+
+/**
+ * Fill the global alignment matrix of seq1 against seq2 tile by tile.
+ *
+ * Writes the last row of scores to row (n + 1 of them). If codes is given it
+ * receives 2-bit traceback codes (0 diagonal, 1 up, 2 left) of every tile,
+ * tile (r, s) at byte offset (r * strips + s) * tile_bytes; see
+ * nw_wavefront_align_into(). The codes and the handoff buffers are taken
+ * from arena and left there for the caller to rewind. Without a pool the
+ * tiles run in order on the calling thread.
+ */
+inline void nw_wavefront_fill(std::string_view seq1, std::string_view seq2,
+                              int match_score, int mismatch_penalty, int gap_penalty,
+                              WorkStealingPool* pool, int tile, ScratchArena& arena, int* row,
+                              uint8_t** codes = nullptr, size_t* tile_bytes = nullptr) {
+    const int m = seq1.length();
+    const int n = seq2.length();
+    metrics_count(Metric::DPCells, uint64_t(m) * n);
+    tile = std::max(tile, 16);
+    int lanes = 0;
+    WavefrontTileFn kernel = wavefront_kernel_for_cpu(&lanes);
+
+    for (int j = 0; j <= n; j++) {
+        row[j] = j * gap_penalty;
+    }
+    if (m == 0 || n == 0) {
+        for (int j = 0; j <= n; j++) {
+            row[j] += m * gap_penalty;
+        }
+        return;
+    }
+
+    const int blocks = (m + tile - 1) / tile;
+    const int strips = (n + tile - 1) / tile;
+    const int last_h = m - (blocks - 1) * tile;
+    const int last_w = n - (strips - 1) * tile;
+
+    // Diagonal layouts of the (at most four) tile shapes
+    uint32_t* starts[2][2];
+    for (int er = 0; er < 2; er++) {
+        for (int es = 0; es < 2; es++) {
+            int h = er ? last_h : tile, w = es ? last_w : tile;
+            starts[er][es] = arena.allocate<uint32_t>(h + w + 2);
+            wavefront_diagonal_starts(h, w, starts[er][es]);
+        }
+    }
+    size_t stride = starts[0][0][2 * tile + 1] / 4 + lanes;
+    if (codes) {
+        *codes = arena.allocate<uint8_t>(size_t(blocks) * strips * stride);
+        std::memset(*codes, 0, size_t(blocks) * strips * stride);
+        *tile_bytes = stride;
+    }
+
+    // handoff + (2 * s + r % 2) * (tile + 1): corner and right column of tile (r, s)
+    int* handoff = arena.allocate<int>(size_t(2) * strips * (tile + 1));
+
+    auto run_tile = [&](int r, int s) {
+        const int i0 = r * tile;  // Rows i0 + 1 .. i0 + h
+        const int j0 = s * tile;  // Columns j0 + 1 .. j0 + w
+        const int h = r == blocks - 1 ? last_h : tile;
+        const int w = s == strips - 1 ? last_w : tile;
+
+        ScratchArena& tile_arena = pool ? AlignerContext::local().arena : arena;
+        ScratchArena::Scope scope(tile_arena);
+        size_t ints = 3 * (h + 1 + lanes) + (h + lanes) + (w + lanes) + h;
+        int* scratch = tile_arena.allocate<int>(ints);
+        std::fill(scratch, scratch + ints, 0);
+        int* q = scratch + 3 * (h + 1 + lanes);
+        int* rr = q + h + lanes;
+        int* column0 = rr + w + lanes;
+        for (int a = 0; a < h; a++) {
+            q[a] = static_cast<unsigned char>(seq1[i0 + a]);
+        }
+        for (int x = 0; x < w; x++) {
+            rr[x] = static_cast<unsigned char>(seq2[j0 + w - 1 - x]);
+        }
+        // Pad with values that never match, so garbage lanes stay harmless
+        std::fill(q + h, q + h + lanes, -1);
+        std::fill(rr + w, rr + w + lanes, -2);
+
+        WavefrontTile t;
+        t.h = h;
+        t.w = w;
+        t.q = q;
+        t.rr = rr;
+        t.top = &row[j0 + 1];
+        t.bottom = &row[j0 + 1];
+        t.right = handoff + (2 * s + r % 2) * (tile + 1);
+        if (s > 0) {
+            const int* from = handoff + (2 * (s - 1) + r % 2) * (tile + 1);
+            t.corner = from[0];
+            t.left = from + 1;
+        } else {
+            for (int a = 0; a < h; a++) {
+                column0[a] = (i0 + a + 1) * gap_penalty;
+            }
+            t.corner = i0 * gap_penalty;
+            t.left = column0;
+        }
+        t.scratch = scratch;
+        if (codes) {
+            t.codes = *codes + (size_t(r) * strips + s) * stride;
+            t.starts = starts[r == blocks - 1][s == strips - 1];
+        }
+        kernel(t, match_score, mismatch_penalty, gap_penalty);
+    };
+
+    for (int d = 0; d < blocks + strips - 1; d++) {
+        int r_lo = std::max(0, d - strips + 1);
+        int r_hi = std::min(blocks - 1, d);
+        if (pool && r_hi > r_lo) {
+            pool->parallel_for(r_hi - r_lo + 1, [&](size_t k) { run_tile(r_lo + k, d - r_lo - k); });
+        } else {
+            for (int r = r_lo; r <= r_hi; r++) {
+                run_tile(r, d - r);
+            }
+        }
+    }
+
+    row[0] = m * gap_penalty;
+}
+
+/**
+ * Last row of global alignment scores of seq1 against seq2 into row (n + 1
+ * scores), in O(n + tile) memory of arena.
+ */
+inline void nw_wavefront_last_row(std::string_view seq1, std::string_view seq2,
+                                  int match_score, int mismatch_penalty, int gap_penalty,
+                                  WorkStealingPool* pool, ScratchArena& arena, int* row, int tile = 256) {
+    ScratchArena::Scope scope(arena);
+    nw_wavefront_fill(seq1, seq2, match_score, mismatch_penalty, gap_penalty, pool, tile, arena, row);
+}
+
+/**
+ * Global alignment of seq1 against seq2 by a tiled wavefront fill into
+ * result, with the score row and traceback taken from arena.
+ */
+inline void nw_wavefront_align_into(std::string_view seq1, std::string_view seq2,
+                                    int match_score, int mismatch_penalty, int gap_penalty,
+                                    WorkStealingPool* pool, int tile, ScratchArena& arena,
+                                    AlignmentResult& result) {
+    tile = std::max(tile, 16);
+    const int m = seq1.length();
+    const int n = seq2.length();
+    ScratchArena::Scope scope(arena);
+    int* row = arena.allocate<int>(n + 1);
+    uint8_t* codes = nullptr;
+    size_t tile_bytes = 0;
+    nw_wavefront_fill(seq1, seq2, match_score, mismatch_penalty, gap_penalty, pool, tile, arena, row,
+                      &codes, &tile_bytes);
+
+    result.cigar.clear();
+    result.score = row[n];
+    result.start1 = 0;
+    result.end1 = m;
+    result.start2 = 0;
+    result.end2 = n;
+    result.seq1 = seq1;
+    result.seq2 = seq2;
+    if (m == 0 || n == 0) {
+        result.cigar.push(m ? 'I' : 'D', m ? m : n);
+        return;
+    }
+
+    const int blocks = (m + tile - 1) / tile;
+    const int strips = (n + tile - 1) / tile;
+    uint32_t* starts[2][2];
+    for (int er = 0; er < 2; er++) {
+        for (int es = 0; es < 2; es++) {
+            int h = er ? m - (blocks - 1) * tile : tile, w = es ? n - (strips - 1) * tile : tile;
+            starts[er][es] = arena.allocate<uint32_t>(h + w + 2);
+            wavefront_diagonal_starts(h, w, starts[er][es]);
+        }
+    }
+
+    int i = m, j = n;
+    while (i > 0 && j > 0) {
+        int r = (i - 1) / tile, s = (j - 1) / tile;
+        int a = i - r * tile, b = j - s * tile;
+        int w = s == strips - 1 ? n - s * tile : tile;
+        int cell = starts[r == blocks - 1][s == strips - 1][a + b] + (a - std::max(1, a + b - w));
+        const uint8_t* base = codes + (size_t(r) * strips + s) * tile_bytes;
+        uint8_t move = (base[cell / 4] >> (2 * (cell % 4))) & 3;
+        if (move == 0) {
+            result.cigar.push('M');
+            i--;
+            j--;
+        } else if (move == 1) {
+            result.cigar.push('I');
+            i--;
+        } else {
+            result.cigar.push('D');
+            j--;
+        }
+    }
+    result.cigar.push('I', i);
+    result.cigar.push('D', j);
+    result.cigar.reverse();
+}
+
+/**
+ * Global alignment of seq1 against seq2 by a tiled wavefront fill.
+ *
+ * @return Score and CIGAR, viewing seq1 and seq2 (which must outlive it)
+ */
+inline AlignmentResult nw_wavefront_align(std::string_view seq1, std::string_view seq2,
+                                          int match_score, int mismatch_penalty, int gap_penalty,
+                                          WorkStealingPool* pool, int tile = 256) {
+    AlignmentResult result;
+    nw_wavefront_align_into(seq1, seq2, match_score, mismatch_penalty, gap_penalty, pool, tile,
+                            AlignerContext::local().arena, result);
+    return result;
+}
+
+#endif // WAVEFRONT_H
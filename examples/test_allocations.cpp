@@ -0,0 +1,116 @@
+/**
+ * Steady-state allocation checks: once an AlignerContext has aligned a pair,
+ * aligning it again through any of the context entry points, serial or
+ * parallel, must not touch the heap. Global operator new is replaced to
+ * count allocations on every thread.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+
+#include "hirschberg.h"
+#include "needleman_wunsch.h"
+#include "smith_waterman.h"
+#include "smith_waterman_affine.h"
+#include "test_support.h"
+
+using namespace std;
+
+static atomic<size_t> allocations{0};
+
+// Out of line, so that GCC does not pair the malloc() and free() inside them
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocations++;
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+/**
+ * Heap allocations made by a run of align after warm_ups identical ones.
+ */
+template <typename Align>
+size_t steady_state_allocations(Align align, int warm_ups = 1) {
+    for (int warm = 0; warm < warm_ups; warm++) {
+        align();
+    }
+    size_t before = allocations;
+    align();
+    return allocations - before;
+}
+
+void test_serial(mt19937& rng) {
+    cout << "Testing serial aligners..." << endl;
+
+    AlignerContext context;
+    string a = random_sequence(rng, 700, "ACDEFGHIKLMNPQRSTVWY");
+    string b = mutate(rng, a, 0.1, "ACDEFGHIKLMNPQRSTVWY");
+    auto linear = make_scoring(MatchMismatch{2, -1}, LinearGap{-2});
+    auto blosum = make_scoring(SubstitutionMatrix::blosum62(), LinearGap{-4});
+    auto affine = make_scoring(SubstitutionMatrix::blosum62(), AffineGap{-11, -1});
+
+    CHECK(steady_state_allocations([&] { needleman_wunsch_cigar(a, b, context, 2, -1, -2); }) == 0);
+    CHECK(steady_state_allocations([&] { needleman_wunsch_cigar(a, b, blosum, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_cigar(a, b, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_cigar(a, b, blosum, context); }) == 0);
+    CHECK(steady_state_allocations([&] { needleman_wunsch_banded_cigar(a, b, 20, context); }) == 0);
+    CHECK(steady_state_allocations([&] { needleman_wunsch_banded_cigar(a, b, 20, blosum, context); }) == 0);
+    CHECK(steady_state_allocations([&] { nw_score(a, b, linear, context); }) == 0);
+    CHECK(steady_state_allocations([&] { nw_score(a, b, blosum, context); }) == 0);
+    CHECK(steady_state_allocations([&] { hirschberg_cigar(a, b, context); }) == 0);
+    CHECK(steady_state_allocations([&] { hirschberg_cigar(a, b, blosum, context, 30); }) == 0);
+    CHECK(steady_state_allocations([&] { myers_miller_cigar(a, b, affine, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_affine_cigar(a, b, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_affine_cigar(a, b, affine, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_affine_score_only(a, b, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_affine_score_only(a, b, affine, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_affine_linear_cigar(a, b, context); }) == 0);
+    CHECK(steady_state_allocations([&] { smith_waterman_affine_linear_cigar(a, b, affine, context); }) == 0);
+
+    cout << "  ✓ Serial aligner tests passed" << endl;
+}
+
+void test_parallel(mt19937& rng) {
+    cout << "Testing parallel aligners..." << endl;
+
+    AlignerContext context;
+    string a = random_sequence(rng, 1500);
+    string b = mutate(rng, a, 0.1);
+    auto blosum = make_scoring(SubstitutionMatrix::blosum62(), LinearGap{-4});
+    auto affine = make_scoring(SubstitutionMatrix::blosum62(), AffineGap{-11, -1});
+    HirschbergOptions options = HirschbergOptions::parallel(2);
+    options.grain_cells = 1 << 12;
+
+    // Each worker's arena grows to the largest tasks it has run, which
+    // depends on scheduling, so these warm up over several runs
+    const int warm_ups = 10;
+
+    CHECK(steady_state_allocations([&] { needleman_wunsch_wavefront(a, b, context, 1, -1, -1, 2, 64); },
+                                   warm_ups) == 0);
+    CHECK(steady_state_allocations([&] { hirschberg_cigar(a, b, context, 1, -1, -1, -1, options); },
+                                   warm_ups) == 0);
+    CHECK(steady_state_allocations([&] { hirschberg_cigar(a, b, blosum, context, -1, options); },
+                                   warm_ups) == 0);
+    CHECK(steady_state_allocations([&] { myers_miller_cigar(a, b, affine, context, options); },
+                                   warm_ups) == 0);
+
+    cout << "  ✓ Parallel aligner tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_serial(rng);
+    test_parallel(rng);
+
+    cout << "\nAll allocation tests passed!" << endl;
+    return 0;
+}
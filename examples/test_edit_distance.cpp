@@ -0,0 +1,73 @@
+/**
+ * Cross-checks of the bit-parallel edit distance engine against full
+ * dynamic programming on random inputs: global distances, banded
+ * distances with a cutoff, and the best match of a pattern in a text.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "edit_distance.h"
+#include "scoring.h"
+#include "test_support.h"
+
+using namespace std;
+
+/**
+ * Best unit-cost distance of pattern against any substring of text.
+ */
+int naive_search_distance(const string& pattern, const string& text) {
+    vector<int> column(pattern.length() + 1);
+    for (size_t i = 0; i <= pattern.length(); i++) {
+        column[i] = i;
+    }
+    int best = column.back();
+    for (char c : text) {
+        int diag = column[0];
+        for (size_t i = 1; i <= pattern.length(); i++) {
+            int left = column[i];
+            column[i] = min({left + 1, column[i - 1] + 1, diag + (pattern[i - 1] != c)});
+            diag = left;
+        }
+        best = min(best, column.back());
+    }
+    return best;
+}
+
+void test_edit_distance(mt19937& rng) {
+    cout << "Testing bit-parallel edit distance..." << endl;
+
+    auto unit = make_scoring(MatchMismatch{0, -1}, LinearGap{-1});
+    for (int t = 0; t < 300; t++) {
+        auto [a, b] = related_pair(rng, t % 3 ? 70 : 300, t % 4 ? "ACGT" : "AC");
+        int expected = -gotoh(a, b, unit, 0, -1, Mode::Global);
+        CHECK(edit_distance(a, b) == expected);
+        int k = random_int(rng, 0, expected + 5);
+        CHECK(edit_distance(a, b, k) == (expected <= k ? expected : -1));
+
+        if (a.empty()) {
+            continue;
+        }
+        string text = random_sequence(rng, random_int(rng, 0, 100)) + b + random_sequence(rng, random_int(rng, 0, 100));
+        int best = naive_search_distance(a, text);
+        EditMatch match = edit_search(a, text);
+        CHECK(match.distance == best);
+        CHECK(match.start <= match.end && match.end <= text.length());
+        CHECK(edit_distance(a, string_view(text).substr(match.start, match.end - match.start)) == best);
+        CHECK(edit_search(a, text, k).distance == (best <= k ? best : -1));
+    }
+
+    cout << "  ✓ Bit-parallel edit distance tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_edit_distance(rng);
+
+    cout << "\nAll edit distance tests passed!" << endl;
+    return 0;
+}
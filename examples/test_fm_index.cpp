@@ -0,0 +1,497 @@
+/**
+ * Cross-checks of the index structures (fm_index.h) against brute force:
+ * SA-IS and the parallel suffix sorter against sorting the suffixes, the
+ * BWT against its inverse, count() and locate() on built, parallel-built,
+ * saved and loaded indexes, corrupt index files, and SMEMs, search schemes
+ * and approximate search in the bidirectional index.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <unistd.h>
+
+#include "fm_index.h"
+#include "test_support.h"
+
+using namespace std;
+
+/**
+ * Suffix array by sorting the suffixes of a '$'-terminated text.
+ */
+vector<uint32_t> naive_suffix_array(const string& text) {
+    vector<uint32_t> sa(text.length());
+    for (size_t i = 0; i < sa.size(); i++) {
+        sa[i] = i;
+    }
+    string_view view = text;
+    sort(sa.begin(), sa.end(), [&](uint32_t a, uint32_t b) { return view.substr(a) < view.substr(b); });
+    return sa;
+}
+
+/**
+ * Sorted start positions of pattern in text.
+ */
+vector<uint32_t> naive_locate(const string& text, const string& pattern) {
+    vector<uint32_t> positions;
+    for (size_t p = text.find(pattern); p != string::npos; p = text.find(pattern, p + 1)) {
+        positions.push_back(p);
+    }
+    return positions;
+}
+
+/**
+ * Texts that stress suffix sorting: random over small and large alphabets,
+ * long runs and exact repeats.
+ */
+vector<string> test_texts(mt19937& rng) {
+    vector<string> texts = {"", "A", "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA", "ACACACACACACACACACACACAC",
+                            "mississippi", "abracadabra"};
+    for (int t = 0; t < 40; t++) {
+        texts.push_back(random_sequence(rng, random_int(rng, 1, 300), t % 2 ? "ACGT" : "ab"));
+    }
+    string unit = random_sequence(rng, 50);
+    string repeats;
+    for (int r = 0; r < 20; r++) {
+        repeats += unit;
+    }
+    texts.push_back(repeats);
+    texts.push_back(random_sequence(rng, 600, "abcdefghijklmnopqrstuvwxyz"));
+    return texts;
+}
+
+void test_suffix_arrays(mt19937& rng) {
+    cout << "Testing suffix arrays and BWT..." << endl;
+
+    for (const string& body : test_texts(rng)) {
+        string text = body + '$';
+        vector<uint32_t> expected = naive_suffix_array(text);
+        CHECK(build_suffix_array(text) == expected);
+
+        string bwt = burrows_wheeler_transform(body);
+        CHECK(bwt == bwt_from_suffix_array(text, expected));
+        CHECK(inverse_bwt(bwt) == text);
+    }
+
+    CHECK(build_suffix_array("$") == vector<uint32_t>{0});
+    CHECK(burrows_wheeler_transform("") == "$");
+
+    cout << "  ✓ Suffix array and BWT tests passed" << endl;
+}
+
+/**
+ * Patterns of up to 12 bases, two in three of them taken from text.
+ */
+vector<string> random_patterns(mt19937& rng, const string& text) {
+    vector<string> patterns;
+    for (int p = 0; p < 60; p++) {
+        int length = random_int(rng, 1, 12);
+        int start = random_int(rng, 0, text.length() - 1);
+        patterns.push_back(p % 3 ? text.substr(start, length) : random_sequence(rng, length));
+    }
+    return patterns;
+}
+
+void test_locate(mt19937& rng) {
+    cout << "Testing FMIndex count and locate..." << endl;
+
+    for (int t = 0; t < 12; t++) {
+        string text = random_sequence(rng, random_int(rng, 1, 3000));
+        FMIndex index(text, t % 3 == 0 ? 1 : 4 * t);
+        for (const string& pattern : random_patterns(rng, text)) {
+            vector<uint32_t> expected = naive_locate(text, pattern);
+            CHECK(index.locate(pattern) == expected);
+            CHECK(index.count(pattern) == expected.size());
+        }
+    }
+
+    cout << "  ✓ Count and locate tests passed" << endl;
+}
+
+/**
+ * A new, empty file under the system's temporary directory, for save() to
+ * overwrite and the caller to remove.
+ */
+string temp_index_path() {
+    string path = (filesystem::temp_directory_path() / "test_fm_index.XXXXXX").string();
+    int fd = mkstemp(&path[0]);
+    CHECK(fd >= 0);
+    close(fd);
+    return path;
+}
+
+/**
+ * Whether FMIndex::load() rejects path.
+ */
+bool load_fails(const string& path) {
+    try {
+        FMIndex::load(path);
+    } catch (const runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void test_save_load(mt19937& rng) {
+    cout << "Testing FMIndex save and load..." << endl;
+
+    const string path = temp_index_path();
+    for (int t = 0; t < 12; t++) {
+        string text = random_sequence(rng, random_int(rng, 1, 3000));
+        FMIndex(text, t % 3 == 0 ? 1 : 4 * t).save(path);
+        FMIndex loaded = FMIndex::load(path);
+        loaded.verify();
+        for (const string& pattern : random_patterns(rng, text)) {
+            vector<uint32_t> expected = naive_locate(text, pattern);
+            CHECK(loaded.locate(pattern) == expected);
+            CHECK(loaded.count(pattern) == expected.size());
+        }
+    }
+
+    // Truncated or corrupt files are rejected instead of read past the mapping
+    FMIndex(random_sequence(rng, 1000), 8).save(path);
+    string file;
+    {
+        ifstream in(path, ios::binary);
+        file.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    FMIndexFileHeader valid;
+    memcpy(&valid, file.data(), sizeof(valid));
+    auto write = [&](const string& bytes) { ofstream(path, ios::binary | ios::trunc) << bytes; };
+    auto corrupt = [&](auto change) {
+        FMIndexFileHeader header = valid;
+        change(header);
+        string bytes = file;
+        memcpy(&bytes[0], &header, sizeof(header));
+        write(bytes);
+        return load_fails(path);
+    };
+    CHECK(!corrupt([](FMIndexFileHeader&) {}));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.version++; }));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.dollar_row = header.n; }));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.sa_sample_rate = 0; }));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.samples_count--; }));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.samples_count++; }));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.C[4]++; }));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.C[2] = header.C[3] + 1; }));
+    CHECK(corrupt([](FMIndexFileHeader& header) { header.rank_offset += 64; }));
+    string ranks = file;
+    ranks[valid.rank_offset + 4 * (valid.rank_words - 1)]++;
+    write(ranks);
+    CHECK(load_fails(path));
+
+    // Checkpoints that do not add up to C[] at the end of the BWT
+    string counts = file;
+    for (uint64_t b = 0; b < valid.occ_blocks; b++) {
+        for (int c = 0; c < 4; c++) {
+            uint32_t count = 0x10000000;
+            memcpy(&counts[valid.occ_offset + b * sizeof(OccBlock) + c * sizeof(uint32_t)], &count, sizeof(count));
+        }
+    }
+    write(counts);
+    CHECK(load_fails(path));
+
+    // load() only checks the ends of the tables; verify() finds the rest
+    auto verify_fails = [&](const string& bytes) {
+        write(bytes);
+        FMIndex loaded = FMIndex::load(path);
+        try {
+            loaded.verify();
+        } catch (const runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    CHECK(!verify_fails(file));
+    counts = file;
+    counts[valid.occ_offset + sizeof(OccBlock)]++;
+    CHECK(verify_fails(counts));
+    ranks = file;
+    ranks[valid.rank_offset + 4]++;
+    CHECK(verify_fails(ranks));
+    string samples = file;
+    memcpy(&samples[valid.samples_offset], &valid.n, sizeof(valid.n));
+    CHECK(verify_fails(samples));
+    write(file.substr(0, file.length() / 2));
+    CHECK(load_fails(path));
+    write(file.substr(0, sizeof(FMIndexFileHeader) - 1));
+    CHECK(load_fails(path));
+    remove(path.c_str());
+
+    cout << "  ✓ Save and load tests passed" << endl;
+}
+
+void test_batches(mt19937& rng) {
+    cout << "Testing FMIndex count_batch and locate_batch..." << endl;
+
+    const string path = temp_index_path();
+    for (int t = 0; t < 12; t++) {
+        string text = random_sequence(rng, random_int(rng, 1, 3000));
+        FMIndex built(text, t % 3 == 0 ? 1 : 4 * t);
+        built.save(path);
+        FMIndex loaded = FMIndex::load(path);
+        vector<string> patterns = random_patterns(rng, text);
+        for (const FMIndex* index : {&built, &loaded}) {
+            vector<uint32_t> counts = index->count_batch(patterns);
+            vector<vector<uint32_t>> located = index->locate_batch(patterns);
+            CHECK(counts.size() == patterns.size() && located.size() == patterns.size());
+            for (size_t p = 0; p < patterns.size(); p++) {
+                vector<uint32_t> expected = naive_locate(text, patterns[p]);
+                CHECK(located[p] == expected);
+                CHECK(counts[p] == expected.size());
+            }
+        }
+    }
+    remove(path.c_str());
+
+    cout << "  ✓ Batch tests passed" << endl;
+}
+
+void test_parallel_builds(mt19937& rng) {
+    cout << "Testing parallel suffix sorting and FMIndex builds..." << endl;
+
+    const vector<IndexBuildOptions> parallel = {{2, 0}, {1, 64}, {3, 256}, {0, 0}};
+    for (const string& body : test_texts(rng)) {
+        string text = body + '$';
+        vector<uint32_t> expected = naive_suffix_array(text);
+        string bwt = burrows_wheeler_transform(body);
+        for (const IndexBuildOptions& options : parallel) {
+            CHECK(build_suffix_array(text, options) == expected);
+            CHECK(burrows_wheeler_transform(body, options) == bwt);
+        }
+    }
+
+    // Only the sentinel: nothing to partition by, sorted serially
+    for (const IndexBuildOptions& options : parallel) {
+        CHECK(build_suffix_array("$", options) == vector<uint32_t>{0});
+        CHECK(burrows_wheeler_transform("", options) == "$");
+        for (const char* text : {"", "$"}) {
+            FMIndex index(text, 32, options);
+            CHECK(index.count("A") == 0);
+            CHECK(index.locate("ACGT").empty());
+        }
+    }
+
+    for (int t = 0; t < 12; t++) {
+        string text = random_sequence(rng, random_int(rng, 1, 3000));
+        FMIndex index(text, t % 3 == 0 ? 1 : 4 * t, IndexBuildOptions{2, size_t(64 * t)});
+        for (const string& pattern : random_patterns(rng, text)) {
+            CHECK(index.locate(pattern) == naive_locate(text, pattern));
+        }
+    }
+
+    cout << "  ✓ Parallel build tests passed" << endl;
+}
+
+void test_smems(mt19937& rng) {
+    cout << "Testing SMEMs..." << endl;
+
+    for (int t = 0; t < 20; t++) {
+        string text = random_sequence(rng, random_int(rng, 50, 2000));
+        BidirectionalFMIndex index(text, 8);
+
+        // A query stitched from pieces of the text, mutated, with the odd N
+        string query;
+        while (query.length() < 150) {
+            int start = random_int(rng, 0, text.length() - 1);
+            query += mutate(rng, text.substr(start, random_int(rng, 5, 60)), 0.05);
+            if (random_int(rng, 0, 9) == 0) {
+                query += 'N';
+            }
+        }
+
+        // [x, e(x)) is the longest match starting at x; it is an SMEM if no
+        // earlier start reaches as far
+        int min_length = random_int(rng, 1, 20);
+        vector<tuple<int, int>> expected;
+        int reach = 0;
+        for (int x = 0; x < (int)query.length(); x++) {
+            int e = x;
+            while (e < (int)query.length() && query[e] != 'N' &&
+                   text.find(query.substr(x, e + 1 - x)) != string::npos) {
+                e++;
+            }
+            if (e > reach && e - x >= min_length) {
+                expected.emplace_back(x, e);
+            }
+            reach = max(reach, e);
+        }
+
+        vector<BidirectionalFMIndex::MaximalMatch> smems = index.smems(query, min_length);
+        CHECK(smems.size() == expected.size());
+        for (size_t s = 0; s < smems.size(); s++) {
+            CHECK(make_tuple(smems[s].query_start, smems[s].query_end) == expected[s]);
+            string match = query.substr(smems[s].query_start, smems[s].query_end - smems[s].query_start);
+            CHECK(index.positions(smems[s].interval) == naive_locate(text, match));
+        }
+    }
+
+    cout << "  ✓ SMEM tests passed" << endl;
+}
+
+/**
+ * A search in the notation of Kucherov et al., pieces numbered from 1:
+ * "213 011 012" is order, lower bounds and upper bounds.
+ */
+string notation(const SearchScheme::Search& search) {
+    string text;
+    for (int piece : search.order) {
+        text += to_string(piece + 1);
+    }
+    for (const vector<int>* bounds : {&search.lower, &search.upper}) {
+        text += ' ';
+        for (int bound : *bounds) {
+            text += to_string(bound);
+        }
+    }
+    return text;
+}
+
+void test_search_schemes() {
+    cout << "Testing search schemes..." << endl;
+
+    // Kucherov, Salikhov and Tsur (2016): the optimal schemes for one and two errors
+    const vector<vector<string>> paper = {{"1 0 0"}, {"12 00 01", "21 01 01"},
+                                          {"123 000 022", "321 000 012", "213 011 012"}};
+    for (int k = 0; k < (int)paper.size(); k++) {
+        SearchScheme scheme = SearchScheme::for_errors(k);
+        CHECK(scheme.pieces == k + 1);
+        vector<string> searches;
+        for (const SearchScheme::Search& search : scheme.searches) {
+            searches.push_back(notation(search));
+        }
+        CHECK(searches == paper[k]);
+    }
+
+    // Complete: every spread of at most k errors over the pieces passes a search
+    for (int k = 0; k <= 4; k++) {
+        SearchScheme scheme = SearchScheme::for_errors(k);
+        vector<int> errors(scheme.pieces, 0);
+        while (true) {
+            int total = 0;
+            for (int e : errors) {
+                total += e;
+            }
+            if (total <= k) {
+                bool passed = false;
+                for (const SearchScheme::Search& search : scheme.searches) {
+                    bool ok = true;
+                    int so_far = 0;
+                    for (size_t t = 0; t < search.order.size(); t++) {
+                        so_far += errors[search.order[t]];
+                        ok = ok && so_far >= search.lower[t] && so_far <= search.upper[t];
+                    }
+                    passed = passed || ok;
+                }
+                CHECK(passed);
+            }
+            size_t p = 0;
+            while (p < errors.size() && errors[p] == k) {
+                errors[p++] = 0;
+            }
+            if (p == errors.size()) {
+                break;
+            }
+            errors[p]++;
+        }
+    }
+
+    cout << "  ✓ Search scheme tests passed" << endl;
+}
+
+/**
+ * Unit-cost edit distance by the full DP.
+ */
+int naive_edit_distance(const string& a, const string& b) {
+    vector<int> row(b.length() + 1);
+    for (size_t j = 0; j <= b.length(); j++) {
+        row[j] = j;
+    }
+    for (size_t i = 1; i <= a.length(); i++) {
+        int diag = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= b.length(); j++) {
+            int up = row[j];
+            row[j] = min({up + 1, row[j - 1] + 1, diag + (a[i - 1] != b[j - 1])});
+            diag = up;
+        }
+    }
+    return row.back();
+}
+
+void test_approximate_search(mt19937& rng) {
+    cout << "Testing approximate search..." << endl;
+
+    for (int t = 0; t < 12; t++) {
+        string text = random_sequence(rng, random_int(rng, 100, 1500));
+        BidirectionalFMIndex index(text, 16);
+        for (int p = 0; p < 15; p++) {
+            int length = random_int(rng, 1, 24);
+            int start = random_int(rng, 0, text.length() - length);
+            string pattern = mutate(rng, text.substr(start, length), 0.1);
+            if (pattern.empty()) {
+                continue;
+            }
+            int k = random_int(rng, 0, 3);
+
+            // Mismatches: exactly the windows within k of the pattern
+            vector<tuple<uint32_t, uint32_t, int>> expected;
+            for (size_t q = 0; q + pattern.length() <= text.length(); q++) {
+                int errors = 0;
+                for (size_t i = 0; i < pattern.length(); i++) {
+                    errors += text[q + i] != pattern[i];
+                }
+                if (errors <= k) {
+                    expected.emplace_back(q, pattern.length(), errors);
+                }
+            }
+            vector<tuple<uint32_t, uint32_t, int>> found;
+            for (const ApproximateMatch& match : index.approximate_search(pattern, k)) {
+                found.emplace_back(match.position, match.length, match.errors);
+            }
+            CHECK(found == expected);
+
+            // Edits: every match is within k edits, and every mismatch window is found
+            vector<ApproximateMatch> edited = index.approximate_search(pattern, k, true);
+            for (const ApproximateMatch& match : edited) {
+                CHECK(match.errors <= k);
+                CHECK(match.errors >= naive_edit_distance(pattern, text.substr(match.position, match.length)));
+            }
+            for (const auto& [position, length, errors] : expected) {
+                auto hit = find_if(edited.begin(), edited.end(), [&](const ApproximateMatch& match) {
+                    return match.position == position && match.length == length;
+                });
+                CHECK(hit != edited.end() && hit->errors <= errors);
+            }
+        }
+    }
+
+    cout << "  ✓ Approximate search tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_suffix_arrays(rng);
+    test_locate(rng);
+    test_save_load(rng);
+    test_batches(rng);
+    test_parallel_builds(rng);
+    test_smems(rng);
+    test_search_schemes();
+    test_approximate_search(rng);
+
+    cout << "\nAll FM-index tests passed!" << endl;
+    return 0;
+}
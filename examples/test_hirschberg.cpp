@@ -0,0 +1,94 @@
+/**
+ * Cross-checks of the linear-space aligners against Gotoh's full-matrix DP
+ * on random inputs: serial and parallel Hirschberg, and Myers-Miller with
+ * symmetric and asymmetric substitution scores.
+ */
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hirschberg.h"
+#include "test_support.h"
+
+using namespace std;
+
+void test_parallel_hirschberg(mt19937& rng) {
+    cout << "Testing serial and parallel Hirschberg..." << endl;
+
+    HirschbergOptions parallel = HirschbergOptions::parallel(2);
+    parallel.grain_cells = 1;
+    parallel.base_cells = 64;
+    for (int t = 0; t < 60; t++) {
+        auto [a, b] = related_pair(rng, 400);
+        int match = random_int(rng, 1, 3);
+        int mismatch = -random_int(rng, 0, 3);
+        int gap = -random_int(rng, 1, 3);
+        auto scoring = make_scoring(MatchMismatch{match, mismatch}, LinearGap{gap});
+        int expected = gotoh(a, b, scoring, 0, gap, Mode::Global);
+
+        AlignmentResult serial = hirschberg_cigar(a, b, match, mismatch, gap);
+        AlignmentResult forked = hirschberg_cigar(a, b, match, mismatch, gap, -1, parallel);
+        CHECK(serial.score == expected);
+        CHECK(forked.score == expected);
+        CHECK(score_result(serial, scoring, 0, gap) == expected);
+        CHECK(score_result(forked, scoring, 0, gap) == expected);
+    }
+
+    cout << "  ✓ Hirschberg tests passed" << endl;
+}
+
+void test_myers_miller(mt19937& rng) {
+    cout << "Testing Myers-Miller..." << endl;
+
+    HirschbergOptions parallel = HirschbergOptions::parallel(2);
+    parallel.grain_cells = 1;
+    for (int t = 0; t < 150; t++) {
+        auto [a, b] = related_pair(rng, t % 5 ? 40 : 250);
+        int match = random_int(rng, 1, 3);
+        int mismatch = -random_int(rng, 0, 3);
+        int open = -random_int(rng, 0, 8);
+        int extend = -random_int(rng, 1, 3);
+        auto scoring = make_scoring(MatchMismatch{match, mismatch}, AffineGap{open, extend});
+        int expected = gotoh(a, b, scoring, open, extend, Mode::Global);
+        for (const HirschbergOptions& options : {HirschbergOptions(), parallel}) {
+            AlignmentResult result = myers_miller_cigar(a, b, scoring, options);
+            CHECK(result.score == expected);
+            CHECK(score_result(result, scoring, open, extend) == expected);
+        }
+    }
+
+    // An asymmetric matrix, with either sequence the longer: the shorter one
+    // spans the score rows, so the sequences may be aligned swapped
+    vector<int> table(25);
+    for (int& score : table) {
+        score = random_int(rng, -4, 4);
+    }
+    SubstitutionMatrix skewed("ACGTN", table);
+    for (int t = 0; t < 100; t++) {
+        auto [a, b] = related_pair(rng, 60);
+        if (t % 2) {
+            b += random_sequence(rng, random_int(rng, 1, 20));
+        }
+        auto scoring = make_scoring(skewed, AffineGap{-5, -1});
+        int expected = gotoh(a, b, skewed, -5, -1, Mode::Global);
+        for (const HirschbergOptions& options : {HirschbergOptions(), parallel}) {
+            AlignmentResult result = myers_miller_cigar(a, b, scoring, options);
+            CHECK(result.score == expected);
+            CHECK(score_result(result, skewed, -5, -1) == expected);
+        }
+    }
+
+    cout << "  ✓ Myers-Miller tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_parallel_hirschberg(rng);
+    test_myers_miller(rng);
+
+    cout << "\nAll Hirschberg tests passed!" << endl;
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * Cross-checks of Needleman-Wunsch against full dynamic programming on
+ * random inputs: the banded fill against the full matrix with the cells
+ * off the band scored -infinity, and the tiled wavefront fill against the
+ * row-by-row one.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "needleman_wunsch.h"
+#include "test_support.h"
+
+using namespace std;
+
+void test_banded(mt19937& rng) {
+    cout << "Testing banded Needleman-Wunsch..." << endl;
+
+    const int NEG_INF = numeric_limits<int>::min() / 4;
+    for (int t = 0; t < 200; t++) {
+        auto [a, b] = related_pair(rng, 120);
+        int m = a.length(), n = b.length();
+        int band_width = random_int(rng, 0, 12);
+        int match = random_int(rng, 1, 3);
+        int mismatch = -random_int(rng, 0, 3);
+        int gap = -random_int(rng, 1, 3);
+
+        // Full DP with the cells off the band scored -infinity
+        int lo = min(0, n - m) - band_width, hi = max(0, n - m) + band_width;
+        vector<vector<int>> H(m + 1, vector<int>(n + 1, NEG_INF));
+        for (int i = 0; i <= m; i++) {
+            for (int j = max(0, i + lo); j <= min(n, i + hi); j++) {
+                if (i == 0 || j == 0) {
+                    H[i][j] = (i + j) * gap;
+                } else {
+                    H[i][j] = max({H[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? match : mismatch),
+                                   H[i - 1][j] + gap, H[i][j - 1] + gap});
+                }
+            }
+        }
+
+        BandedAlignment banded = needleman_wunsch_banded(a, b, band_width, match, mismatch, gap);
+        CHECK(banded.score == H[m][n]);
+        CHECK(banded.aligned_seq1.length() == banded.aligned_seq2.length());
+        int rescored = 0;
+        string rows[2];
+        for (size_t c = 0; c < banded.aligned_seq1.length(); c++) {
+            char x = banded.aligned_seq1[c], y = banded.aligned_seq2[c];
+            rescored += x == '-' || y == '-' ? gap : x == y ? match : mismatch;
+            if (x != '-') {
+                rows[0] += x;
+            }
+            if (y != '-') {
+                rows[1] += y;
+            }
+        }
+        CHECK(rescored == banded.score);
+        CHECK(rows[0] == a && rows[1] == b);
+
+        // The CIGAR forms agree with the rendered one
+        auto scoring = make_scoring(MatchMismatch{match, mismatch}, LinearGap{gap});
+        BandedAlignmentResult result = needleman_wunsch_banded_cigar(a, b, band_width, match, mismatch, gap);
+        CHECK(result.score == banded.score && result.band_edge_hit == banded.band_edge_hit);
+        CHECK(result.render() == make_pair(banded.aligned_seq1, banded.aligned_seq2));
+        CHECK(score_result(result, scoring, 0, gap) == banded.score);
+        AlignerContext context;
+        bool edge_hit = !banded.band_edge_hit;
+        const AlignmentResult& reused = needleman_wunsch_banded_cigar(a, b, band_width, scoring, context, &edge_hit);
+        CHECK(reused.cigar.str() == result.cigar.str() && edge_hit == banded.band_edge_hit);
+
+        // A band covering the whole matrix is plain Needleman-Wunsch
+        BandedAlignment wide = needleman_wunsch_banded(a, b, max(m, n), match, mismatch, gap);
+        Alignment full = needleman_wunsch(a, b, match, mismatch, gap);
+        CHECK(!wide.band_edge_hit);
+        CHECK(wide.score == full.score);
+        CHECK(wide.aligned_seq1 == full.aligned_seq1 && wide.aligned_seq2 == full.aligned_seq2);
+
+        // So is a negative band, and one wider than the matrix
+        for (int unbanded : {-1, -random_int(rng, 2, 1000), numeric_limits<int>::max()}) {
+            BandedAlignmentResult open = needleman_wunsch_banded_cigar(a, b, unbanded, match, mismatch, gap);
+            CHECK(!open.band_edge_hit);
+            CHECK(open.score == full.score);
+            CHECK(open.render() == make_pair(full.aligned_seq1, full.aligned_seq2));
+        }
+    }
+
+    cout << "  ✓ Banded Needleman-Wunsch tests passed" << endl;
+}
+
+void test_wavefront(mt19937& rng) {
+    cout << "Testing the wavefront fill..." << endl;
+
+    for (int t = 0; t < 60; t++) {
+        auto [a, b] = related_pair(rng, 400);
+        int match = random_int(rng, 1, 3);
+        int mismatch = -random_int(rng, 0, 3);
+        int gap = -random_int(rng, 1, 3);
+        AlignmentResult expected = needleman_wunsch_cigar(a, b, match, mismatch, gap);
+        auto scoring = make_scoring(MatchMismatch{match, mismatch}, LinearGap{gap});
+        CHECK(expected.score == gotoh(a, b, scoring, 0, gap, Mode::Global));
+        CHECK(score_result(expected, scoring, 0, gap) == expected.score);
+
+        for (size_t threads : {1, 2}) {
+            AlignmentResult tiled = needleman_wunsch_wavefront(a, b, match, mismatch, gap, threads, 16);
+            CHECK(tiled.score == expected.score);
+            CHECK(tiled.cigar.str() == expected.cigar.str());
+        }
+    }
+
+    cout << "  ✓ Wavefront tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_banded(rng);
+    test_wavefront(rng);
+
+    cout << "\nAll Needleman-Wunsch tests passed!" << endl;
+    return 0;
+}
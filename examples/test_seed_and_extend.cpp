@@ -0,0 +1,155 @@
+/**
+ * Cross-checks of seeding and extension on random inputs: k-mer index
+ * builds of any thread count and memory target against the serial one,
+ * gapped X-drop extension against the best anchored alignment on either
+ * side of the seed, and ungapped and gapped anchor extension under the
+ * same scores.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "scoring.h"
+#include "seed_and_extend.h"
+#include "test_support.h"
+
+using namespace std;
+
+void test_kmer_index_builds(mt19937& rng) {
+    cout << "Testing serial and parallel k-mer index builds..." << endl;
+
+    const vector<KmerIndexBuildOptions> builds = {{1, 0}, {1, 4096}, {3, 0}, {2, 4096}, {0, 0}};
+    for (int t = 0; t < 8; t++) {
+        string reference = random_sequence(rng, random_int(rng, 1, t % 2 ? 2000 : 150000));
+        SeedShape shape = t % 4 == 3 ? SeedShape::contiguous(8) : SeedShape::contiguous(random_int(rng, 4, 15));
+        uint32_t max_occurrences = t % 3 ? 0 : 20;
+        KmerIndex expected = build_kmer_index(reference, shape, max_occurrences);
+        for (const KmerIndexBuildOptions& build : builds) {
+            KmerIndex index = build_kmer_index(reference, shape, max_occurrences, build);
+            CHECK(index.kmers == expected.kmers && index.offsets == expected.offsets);
+            CHECK(index.positions == expected.positions && index.buckets == expected.buckets);
+            CHECK(index.masked_positions == expected.masked_positions);
+        }
+    }
+
+    cout << "  ✓ K-mer index build tests passed" << endl;
+}
+
+void test_xdrop(mt19937& rng) {
+    cout << "Testing gapped X-drop extension..." << endl;
+
+    for (int t = 0; t < 150; t++) {
+        string reference = random_sequence(rng, random_int(rng, 20, 300));
+        int start = random_int(rng, 0, reference.length() - 10);
+        int span = random_int(rng, 10, reference.length() - start);
+        string query = mutate(rng, reference.substr(start, span), 0.15);
+        if (query.length() < 8) {
+            continue;
+        }
+
+        // Seed on a stretch of the query and wherever it lies near the reference
+        int length = random_int(rng, 1, 8);
+        int pos1 = random_int(rng, 0, query.length() - length);
+        int pos2 = min<int>(start + pos1, reference.length() - length);
+
+        ExtensionOptions options;
+        options.gapped = true;
+        options.match_score = random_int(rng, 1, 3);
+        options.mismatch_penalty = -random_int(rng, 1, 4);
+        options.gap_open = -random_int(rng, 0, 5);
+        options.gap_extend = -random_int(rng, 1, 2);
+        MatchMismatch score{options.match_score, options.mismatch_penalty};
+
+        // Unlimited X-drop and band: the best anchored extension on either side
+        int seed_score = 0;
+        for (int i = 0; i < length; i++) {
+            seed_score += score(query[pos1 + i], reference[pos2 + i]);
+        }
+        string left1(query.rend() - pos1, query.rend());
+        string left2(reference.rend() - pos2, reference.rend());
+        int best = seed_score +
+            gotoh(query.substr(pos1 + length), reference.substr(pos2 + length), score,
+                  options.gap_open, options.gap_extend, Mode::Anchored) +
+            gotoh(left1, left2, score, options.gap_open, options.gap_extend, Mode::Anchored);
+
+        for (int limits = 0; limits < 2; limits++) {
+            if (limits == 0) {
+                options.xdrop = 1 << 20;
+                options.band = 1000;
+            } else {
+                options.xdrop = random_int(rng, 1, 30);
+                options.band = random_int(rng, 1, 40);
+            }
+            AlignmentHit hit = extend_seed_gapped(query, reference, pos1, pos2, length, options);
+            CHECK(limits ? hit.score <= best : hit.score == best);
+            CHECK(hit.query_start <= pos1 && hit.query_end >= pos1 + length);
+            CHECK(score_cigar(hit.cigar, hit.query, hit.query_start, hit.query_end, hit.reference,
+                              hit.ref_start, hit.ref_end, score, options.gap_open, options.gap_extend) == hit.score);
+        }
+    }
+
+    cout << "  ✓ Gapped X-drop extension tests passed" << endl;
+}
+
+void test_extend_anchor(mt19937& rng) {
+    cout << "Testing anchor extension..." << endl;
+
+    AlignerContext context;
+    for (int t = 0; t < 100; t++) {
+        string reference = random_sequence(rng, random_int(rng, 20, 300));
+        int start = random_int(rng, 0, reference.length() - 10);
+        string query = mutate(rng, reference.substr(start, random_int(rng, 10, reference.length() - start)), 0.1);
+        if (query.empty()) {
+            continue;
+        }
+        Anchor anchor{random_int(rng, 0, query.length() - 1), 0, 1};
+        anchor.ref_pos = min<int>(start + anchor.query_pos, reference.length() - 1);
+
+        // Ungapped or gapped, the hit is scored with the options' scores
+        ExtensionOptions options;
+        options.match_score = random_int(rng, 1, 4);
+        options.mismatch_penalty = -random_int(rng, 1, 4);
+        options.xdrop = random_int(rng, 1, 30);
+        AlignmentHit ungapped, gapped;
+        extend_anchor(anchor, reference, query, options, context.arena, ungapped);
+        AlignmentHit expected = extend_seed(query, reference, anchor.query_pos, anchor.ref_pos,
+                                            options.match_score, options.mismatch_penalty, options.xdrop);
+        CHECK(ungapped.score == expected.score);
+        CHECK(ungapped.query_start == expected.query_start && ungapped.query_end == expected.query_end);
+        MatchMismatch score{options.match_score, options.mismatch_penalty};
+        CHECK(score_cigar(ungapped.cigar, ungapped.query, ungapped.query_start, ungapped.query_end,
+                          ungapped.reference, ungapped.ref_start, ungapped.ref_end, score, 0, 0) == ungapped.score);
+
+        options.gapped = true;
+        extend_anchor(anchor, reference, query, options, context.arena, gapped);
+        CHECK(score_cigar(gapped.cigar, gapped.query, gapped.query_start, gapped.query_end, gapped.reference,
+                          gapped.ref_start, gapped.ref_end, score, options.gap_open,
+                          options.gap_extend) == gapped.score);
+    }
+
+    // Six mismatches stop the default X-drop of 5 but not the options' one
+    string query = "AAAACCCCCCGGGGGGGGGG";
+    string reference = "AAAATTTTTTGGGGGGGGGG";
+    ExtensionOptions options;
+    options.match_score = 1;
+    AlignmentHit hit;
+    CHECK(extend_seed(query, reference, 0, 0).score == 4);
+    extend_anchor(Anchor{0, 0, 1}, reference, query, options, context.arena, hit);
+    CHECK(hit.score == 8 && hit.query_end == 20);
+
+    cout << "  ✓ Anchor extension tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_kmer_index_builds(rng);
+    test_xdrop(rng);
+    test_extend_anchor(rng);
+
+    cout << "\nAll seed-and-extend tests passed!" << endl;
+    return 0;
+}
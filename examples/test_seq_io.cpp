@@ -0,0 +1,153 @@
+/**
+ * Cross-checks of SequenceReader (seq_io.h): FASTQ and FASTA read from a
+ * memory-mapped file and from a pipe in small blocks, so that records are
+ * cut by block boundaries, must parse to the records that were written.
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "seq_io.h"
+#include "test_support.h"
+
+using namespace std;
+
+struct Read {
+    string name;
+    string comment;
+    string sequence;
+    string quality;
+};
+
+/**
+ * Read every FASTQ record of path.
+ */
+vector<Read> read_fastq(const string& path, size_t block_size) {
+    SequenceReader reader(path, block_size);
+    vector<Read> reads;
+    FastqRecord record;
+    while (reader.next(record)) {
+        reads.push_back({string(record.name), string(record.comment), string(record.sequence),
+                         string(record.quality)});
+    }
+    return reads;
+}
+
+/**
+ * A pipe that a thread fills with text, read through its /proc path.
+ */
+class PipeInput {
+private:
+    int read_fd = -1;
+    thread writer;
+
+public:
+    explicit PipeInput(const string& text) {
+        int fds[2];
+        CHECK(pipe(fds) == 0);
+        read_fd = fds[0];
+        writer = thread([text, fd = fds[1]] {
+            size_t written = 0;
+            while (written < text.length()) {
+                ssize_t put = write(fd, text.data() + written, text.length() - written);
+                CHECK(put > 0);
+                written += put;
+            }
+            close(fd);
+        });
+    }
+
+    ~PipeInput() {
+        writer.join();
+        close(read_fd);
+    }
+
+    string path() const { return "/proc/self/fd/" + to_string(read_fd); }
+};
+
+void test_fastq(mt19937& rng) {
+    cout << "Testing FASTQ input..." << endl;
+
+    vector<Read> reads;
+    string text;
+    for (int r = 0; r < 300; r++) {
+        Read read;
+        read.name = "read" + to_string(r);
+        read.comment = r % 3 ? "" : "sample=" + to_string(r);
+        read.sequence = random_sequence(rng, r % 50 ? random_int(rng, 1, 300) : 9000);
+        read.quality = random_sequence(rng, read.sequence.length(), "#+5?FI");
+        text += "@" + read.name + (read.comment.empty() ? "" : " " + read.comment) + "\n";
+        text += read.sequence + (r % 7 ? "\n+\n" : "\r\n+\r\n") + read.quality + "\n";
+        reads.push_back(read);
+    }
+
+    auto same = [&](const vector<Read>& parsed) {
+        CHECK(parsed.size() == reads.size());
+        for (size_t r = 0; r < reads.size(); r++) {
+            CHECK(parsed[r].name == reads[r].name && parsed[r].comment == reads[r].comment);
+            CHECK(parsed[r].sequence == reads[r].sequence && parsed[r].quality == reads[r].quality);
+        }
+    };
+
+    const string path = "test_seq_io.fq";
+    ofstream(path, ios::binary) << text;
+    same(read_fastq(path, 4096));
+    remove(path.c_str());
+
+    for (size_t block_size : {4096, 10000, 1 << 20}) {
+        PipeInput input(text);
+        same(read_fastq(input.path(), block_size));
+    }
+
+    // An empty stream has no records
+    PipeInput empty("");
+    CHECK(read_fastq(empty.path(), 4096).empty());
+
+    cout << "  ✓ FASTQ input tests passed" << endl;
+}
+
+void test_fasta(mt19937& rng) {
+    cout << "Testing FASTA input..." << endl;
+
+    string text, expected;
+    for (int c = 0; c < 20; c++) {
+        string contig = random_sequence(rng, random_int(rng, 1, 5000), "ACGTacgtN");
+        text += ">contig" + to_string(c) + " description\n";
+        for (size_t pos = 0; pos < contig.length(); pos += 60) {
+            text += contig.substr(pos, 60) + "\n";
+        }
+        for (char& b : contig) {
+            b = toupper(b);
+        }
+        expected += (c ? "N" : "") + contig;
+    }
+
+    PipeInput input(text);
+    Reference reference = read_reference(input.path());
+    CHECK(reference.sequence == expected);
+    CHECK(reference.contigs.size() == 20);
+    for (size_t c = 0; c < reference.contigs.size(); c++) {
+        CHECK(reference.contigs[c].name == "contig" + to_string(c));
+        CHECK(&reference.contig_at(reference.contigs[c].offset) == &reference.contigs[c]);
+    }
+
+    cout << "  ✓ FASTA input tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_fastq(rng);
+    test_fasta(rng);
+
+    cout << "\nAll sequence input tests passed!" << endl;
+    return 0;
+}
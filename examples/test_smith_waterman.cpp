@@ -0,0 +1,107 @@
+/**
+ * Cross-checks of the Smith-Waterman kernels against Gotoh's full-matrix
+ * DP on random inputs: the striped affine kernel with match/mismatch and
+ * BLOSUM62 scoring, and the inter-sequence batch kernel.
+ */
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "smith_waterman.h"
+#include "smith_waterman_affine.h"
+#include "test_support.h"
+
+using namespace std;
+
+void test_striped(mt19937& rng) {
+    cout << "Testing striped Smith-Waterman..." << endl;
+
+    for (int t = 0; t < 200; t++) {
+        auto [a, b] = related_pair(rng, 300);
+        int match = random_int(rng, 1, t % 10 ? 5 : 120);
+        int mismatch = -random_int(rng, 1, 5);
+        int open = -random_int(rng, 0, 6);
+        int extend = -random_int(rng, 1, 3);
+        auto scoring = make_scoring(MatchMismatch{match, mismatch}, AffineGap{open, extend});
+        int expected = gotoh(a, b, scoring, open, extend, Mode::Local);
+        CHECK(smith_waterman_affine_score(a, b, scoring) == expected);
+        CHECK(smith_waterman_affine_score_only(a, b, scoring).score == expected);
+        AlignmentResult full = smith_waterman_affine_cigar(a, b, scoring);
+        CHECK(full.score == expected);
+        CHECK(score_result(full, scoring, open, extend) == expected);
+    }
+
+    const string amino = "ARNDCQEGHILKMFPSTWYV";
+    auto blosum = make_scoring(SubstitutionMatrix::blosum62(), AffineGap{-11, -1});
+    for (int t = 0; t < 50; t++) {
+        auto [a, b] = related_pair(rng, 200, amino);
+        int expected = gotoh(a, b, blosum, -11, -1, Mode::Local);
+        CHECK(smith_waterman_affine_score(a, b, blosum) == expected);
+        CHECK(smith_waterman_affine_cigar(a, b, blosum).score == expected);
+    }
+
+    cout << "  ✓ Striped Smith-Waterman tests passed" << endl;
+}
+
+void test_batch(mt19937& rng) {
+    cout << "Testing batched Smith-Waterman..." << endl;
+
+    for (int t = 0; t < 10; t++) {
+        string query = random_sequence(rng, random_int(rng, 0, 150));
+        vector<string> targets;
+        for (int k = 0; k < 70; k++) {
+            int length = k % 17 ? random_int(rng, 0, 200) : 0;
+            targets.push_back(k % 2 ? mutate(rng, query, 0.15) : random_sequence(rng, length));
+        }
+        int match = random_int(rng, 1, t % 3 ? 3 : 60);
+        vector<BatchScore> scores = smith_waterman_batch(query, targets, match, -1, -2);
+        CHECK(scores.size() == targets.size());
+        for (size_t k = 0; k < targets.size(); k++) {
+            int expected = smith_waterman_cigar(query, targets[k], match, -1, -2).score;
+            CHECK(scores[k].score == expected);
+            if (scores[k].end1 > 0) {
+                string prefix1 = query.substr(0, scores[k].end1);
+                string prefix2 = targets[k].substr(0, scores[k].end2);
+                CHECK(smith_waterman_cigar(prefix1, prefix2, match, -1, -2).score == expected);
+            }
+        }
+    }
+
+    // A positive mismatch score must not let padding past a short target score
+    vector<BatchScore> padded = smith_waterman_batch("ACGTACGTAC", {"A", random_sequence(rng, 36)}, 2, 1, -1);
+    CHECK(padded[0].score == smith_waterman_cigar("ACGTACGTAC", "A", 2, 1, -1).score);
+    CHECK(padded[0].end2 <= 1);
+
+    // End cells past 65535, in the query and in a target
+    string genome = random_sequence(rng, 70000);
+    string read = genome.substr(66000, 100);
+    vector<string> targets = {read, mutate(rng, genome.substr(67000, 300), 0.1), random_sequence(rng, 50)};
+    vector<BatchScore> scores = smith_waterman_batch(genome, targets);
+    CHECK(scores[0].score == 200 && scores[0].end1 == 66100 && scores[0].end2 == 100);
+    for (size_t k = 1; k < targets.size(); k++) {
+        int expected = smith_waterman_cigar(genome, targets[k]).score;
+        CHECK(scores[k].score == expected);
+        string prefix1 = genome.substr(0, scores[k].end1);
+        string prefix2 = targets[k].substr(0, scores[k].end2);
+        CHECK(smith_waterman_cigar(prefix1, prefix2).score == expected);
+    }
+    scores = smith_waterman_batch(read, {genome});
+    CHECK(scores[0].score == 200 && scores[0].end1 == 100 && scores[0].end2 == 66100);
+    vector<pair<size_t, Alignment>> hits = smith_waterman_batch_align(genome, {read}, 100);
+    CHECK(hits.size() == 1 && hits[0].second.score == 200 && hits[0].second.aligned_seq2 == read);
+
+    cout << "  ✓ Batched Smith-Waterman tests passed" << endl;
+}
+
+int main() {
+    mt19937 rng(20240611);
+
+    test_striped(rng);
+    test_batch(rng);
+
+    cout << "\nAll Smith-Waterman tests passed!" << endl;
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * Helpers shared by the C++ cross-check tests.
+ *
+ * The tests compare the optimized algorithms against brute-force versions
+ * on random inputs; gotoh() is the reference DP the aligners are checked
+ * against. CHECK stays active in release builds (unlike assert) and
+ * fails the test program with the file and line of the first failed check.
+ */
+
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cigar.h"
+
+#define CHECK(condition)                                                          \
+    do {                                                                          \
+        if (!(condition)) {                                                       \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+                         #condition);                                             \
+            std::exit(1);                                                         \
+        }                                                                         \
+    } while (0)
+
+/**
+ * Random string of the given length over alphabet.
+ */
+inline std::string random_sequence(std::mt19937& rng, size_t length, const std::string& alphabet = "ACGT") {
+    std::uniform_int_distribution<size_t> pick(0, alphabet.length() - 1);
+    std::string sequence(length, ' ');
+    for (char& c : sequence) {
+        c = alphabet[pick(rng)];
+    }
+    return sequence;
+}
+
+/**
+ * Copy of sequence with about rate substitutions, insertions and deletions
+ * per base, drawn from alphabet.
+ */
+inline std::string mutate(std::mt19937& rng, const std::string& sequence, double rate,
+                          const std::string& alphabet = "ACGT") {
+    std::uniform_real_distribution<double> coin(0, 1);
+    std::uniform_int_distribution<size_t> pick(0, alphabet.length() - 1);
+    std::string out;
+    for (char c : sequence) {
+        double x = coin(rng);
+        if (x < rate / 3) {
+            out += alphabet[pick(rng)];
+        } else if (x < 2 * rate / 3) {
+            out += c;
+            out += alphabet[pick(rng)];
+        } else if (x >= rate) {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/**
+ * Random integer in [lo, hi].
+ */
+inline int random_int(std::mt19937& rng, int lo, int hi) {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+}
+
+/**
+ * What gotoh() aligns.
+ */
+enum class Mode { Global, Local, Anchored };
+
+/**
+ * Best score of a against b with gaps costing gap_open + k * gap_extend,
+ * by Gotoh's full-matrix recurrences. Global aligns both sequences end to
+ * end, Local any substrings, Anchored any prefixes.
+ */
+template <typename Substitution>
+int gotoh(const std::string& a, const std::string& b, const Substitution& score, int gap_open, int gap_extend,
+          Mode mode) {
+    const int NEG_INF = std::numeric_limits<int>::min() / 4;
+    const size_t m = a.length(), n = b.length();
+    std::vector<std::vector<int>> H(m + 1, std::vector<int>(n + 1, 0));
+    std::vector<std::vector<int>> X(m + 1, std::vector<int>(n + 1, NEG_INF));  // a residue against a gap
+    std::vector<std::vector<int>> Y(m + 1, std::vector<int>(n + 1, NEG_INF));  // b residue against a gap
+    if (mode != Mode::Local) {
+        for (size_t i = 1; i <= m; i++) {
+            H[i][0] = X[i][0] = gap_open + int(i) * gap_extend;
+        }
+        for (size_t j = 1; j <= n; j++) {
+            H[0][j] = Y[0][j] = gap_open + int(j) * gap_extend;
+        }
+    }
+    int best = mode == Mode::Global ? NEG_INF : 0;
+    for (size_t i = 1; i <= m; i++) {
+        for (size_t j = 1; j <= n; j++) {
+            X[i][j] = std::max(H[i - 1][j] + gap_open + gap_extend, X[i - 1][j] + gap_extend);
+            Y[i][j] = std::max(H[i][j - 1] + gap_open + gap_extend, Y[i][j - 1] + gap_extend);
+            H[i][j] = std::max({H[i - 1][j - 1] + score(a[i - 1], b[j - 1]), X[i][j], Y[i][j]});
+            if (mode == Mode::Local) {
+                H[i][j] = std::max(H[i][j], 0);
+            }
+            best = std::max(best, H[i][j]);
+        }
+    }
+    if (mode == Mode::Anchored) {
+        for (size_t i = 0; i <= m; i++) {
+            best = std::max(best, H[i][0]);
+        }
+        for (size_t j = 0; j <= n; j++) {
+            best = std::max(best, H[0][j]);
+        }
+    }
+    return mode == Mode::Global ? H[m][n] : best;
+}
+
+/**
+ * Score of a CIGAR over a[start1, ...) and b[start2, ...), each run of I or D
+ * one gap. Checks that the script covers exactly end1 - start1 and end2 - start2 bases.
+ */
+template <typename Substitution>
+int score_cigar(const Cigar& cigar, std::string_view a, int start1, int end1, std::string_view b, int start2,
+                int end2, const Substitution& score, int gap_open, int gap_extend) {
+    CHECK((int)cigar.seq1_length() == end1 - start1);
+    CHECK((int)cigar.seq2_length() == end2 - start2);
+    int total = 0;
+    int i = start1, j = start2;
+    for (size_t r = 0; r < cigar.size(); r++) {
+        int length = cigar.length(r);
+        if (cigar.op(r) == 'M') {
+            for (int k = 0; k < length; k++) {
+                total += score(a[i + k], b[j + k]);
+            }
+            i += length;
+            j += length;
+        } else {
+            total += gap_open + length * gap_extend;
+            (cigar.op(r) == 'I' ? i : j) += length;
+        }
+    }
+    return total;
+}
+
+template <typename Substitution>
+int score_result(const AlignmentResult& result, const Substitution& score, int gap_open, int gap_extend) {
+    return score_cigar(result.cigar, result.seq1, result.start1, result.end1, result.seq2, result.start2,
+                       result.end2, score, gap_open, gap_extend);
+}
+
+/**
+ * A pair of related sequences: a random one and a mutated copy.
+ */
+inline std::pair<std::string, std::string> related_pair(std::mt19937& rng, int max_length,
+                                                        const std::string& alphabet = "ACGT") {
+    std::string a = random_sequence(rng, random_int(rng, 0, max_length), alphabet);
+    std::string b =
+        random_int(rng, 0, 3) ? mutate(rng, a, 0.2, alphabet) : random_sequence(rng, a.length(), alphabet);
+    return {a, b};
+}
+
+#endif // TEST_SUPPORT_H